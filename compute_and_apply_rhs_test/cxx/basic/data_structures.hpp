@@ -3,6 +3,7 @@
 
 #include "kinds.hpp"
 #include "dimensions.hpp"
+#include "workspace_arena.hpp"
 
 namespace Homme
 {
@@ -83,11 +84,19 @@ struct TestData
   Derivative  deriv     = {};
   HVCoord     hvcoord   = {};
 
+  // The temporaries of compute_and_apply_rhs, one slab per OpenMP thread
+  WorkspaceArena workspace = {};
+
   void init_data ();
   void update_time_levels();
   void cleanup_data ();
 };
 
+// The number of the calling OpenMP thread, and the most threads a parallel
+// region can have (0 and 1 without OpenMP)
+int thread_id ();
+int max_threads ();
+
 } // Namespace Homme
 
 #endif // DATA_STRUCTURES_HPP
@@ -29,7 +29,7 @@ void gradient_sphere (const real* const s, const TestData& data,
       }
 
       v1[l][j] = dsdx * rrearth;
-      v2[j][l] - dsdy * rrearth;
+      v2[j][l] = dsdy * rrearth;
     }
   }
 
@@ -0,0 +1,176 @@
+#include "workspace_arena.hpp"
+#include "data_structures.hpp"
+#include "dimensions.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+namespace Homme
+{
+
+namespace
+{
+
+// The phases of the element loop of compute_and_apply_rhs, in order
+enum Phase
+{
+  PHASE_PRESSURE,      // p
+  PHASE_LEVEL_OPS,     // gradient, divergence and vorticity level by level
+  PHASE_VIRTUAL_T,     // T_v and kappa_star
+  PHASE_SCANS,         // preq_hydrostatic and preq_omega_ps
+  PHASE_ACCUMULATE,    // eta_dot_dpdn and omega_p
+  PHASE_TENDENCIES,    // vtens1, vtens2 and ttens level by level
+  PHASE_UPDATE         // the np1 time level
+};
+
+// A temporary is live from the phase which writes it first to the phase
+// which reads it last, both included. The zero ones are never written:
+// they are zeroed once and live throughout
+struct Liveness
+{
+  Temporary tmp;
+  size_t    size;
+  Phase     first;
+  Phase     last;
+  bool      zero;
+};
+
+const Liveness liveness[NUM_TEMPORARIES] =
+{
+  { TMP_P,            nlev*np*np,   PHASE_PRESSURE,   PHASE_TENDENCIES, false },
+  { TMP_GRAD_P,       nlev*np*np*2, PHASE_LEVEL_OPS,  PHASE_TENDENCIES, false },
+  { TMP_VDP,          nlev*np*np*2, PHASE_LEVEL_OPS,  PHASE_LEVEL_OPS,  false },
+  { TMP_VGRAD_P,      nlev*np*np,   PHASE_LEVEL_OPS,  PHASE_SCANS,      false },
+  { TMP_DIVDP,        nlev*np*np,   PHASE_LEVEL_OPS,  PHASE_UPDATE,     false },
+  { TMP_VORT,         nlev*np*np,   PHASE_LEVEL_OPS,  PHASE_TENDENCIES, false },
+  { TMP_T_V,          nlev*np*np,   PHASE_VIRTUAL_T,  PHASE_TENDENCIES, false },
+  { TMP_KAPPA_STAR,   nlev*np*np,   PHASE_VIRTUAL_T,  PHASE_TENDENCIES, false },
+  { TMP_OMEGA_P,      nlev*np*np,   PHASE_SCANS,      PHASE_TENDENCIES, false },
+  { TMP_EPHI,         np*np,        PHASE_TENDENCIES, PHASE_TENDENCIES, false },
+  { TMP_VTEMP,        np*np*2,      PHASE_TENDENCIES, PHASE_TENDENCIES, false },
+  { TMP_VGRAD_T,      np*np,        PHASE_TENDENCIES, PHASE_TENDENCIES, false },
+  { TMP_VTENS1,       nlev*np*np,   PHASE_TENDENCIES, PHASE_UPDATE,     false },
+  { TMP_VTENS2,       nlev*np*np,   PHASE_TENDENCIES, PHASE_UPDATE,     false },
+  { TMP_TTENS,        nlev*np*np,   PHASE_TENDENCIES, PHASE_UPDATE,     false },
+  { TMP_ETA_DOT_DPDN, nlevp*np*np,  PHASE_PRESSURE,   PHASE_UPDATE,     true  },
+  { TMP_T_VADV,       nlev*np*np,   PHASE_PRESSURE,   PHASE_UPDATE,     true  },
+  { TMP_V_VADV,       nlev*np*np*2, PHASE_PRESSURE,   PHASE_UPDATE,     true  }
+};
+
+// Temporaries start on cache lines
+constexpr size_t alignment = 64;
+constexpr size_t reals_per_line = alignment / sizeof(real);
+
+size_t round_up (size_t reals)
+{
+  return (reals + reals_per_line - 1) / reals_per_line * reals_per_line;
+}
+
+bool overlap (size_t begin1, size_t end1, size_t begin2, size_t end2)
+{
+  return begin1 < end2 && begin2 < end1;
+}
+
+} // anonymous namespace
+
+void WorkspaceArena::init_data (int threads)
+{
+  reals_per_slab = 0;
+
+  for (int i=0; i<NUM_TEMPORARIES; ++i)
+  {
+    if (liveness[i].tmp != i)
+    {
+      std::cerr << "Error! The liveness table is not in the order of Temporary.\n";
+      std::abort();
+    }
+  }
+
+  // Place the temporaries from the largest, each at the lowest offset where
+  // it does not overlap one placed before it with an overlapping lifetime
+  int order[NUM_TEMPORARIES];
+  for (int i=0; i<NUM_TEMPORARIES; ++i)
+  {
+    order[i] = i;
+  }
+  std::stable_sort (order, order+NUM_TEMPORARIES,
+                    [](int i, int j) { return liveness[i].size > liveness[j].size; });
+
+  for (int n=0; n<NUM_TEMPORARIES; ++n)
+  {
+    const Liveness& li = liveness[order[n]];
+    size_t offset = 0;
+    bool moved = true;
+    while (moved)
+    {
+      moved = false;
+      for (int m=0; m<n; ++m)
+      {
+        const Liveness& lj = liveness[order[m]];
+        if (overlap(li.first,li.last+1,lj.first,lj.last+1) &&
+            overlap(offset,offset+li.size,offsets[lj.tmp],offsets[lj.tmp]+lj.size))
+        {
+          offset = round_up(offsets[lj.tmp]+lj.size);
+          moved = true;
+        }
+      }
+    }
+    offsets[li.tmp] = offset;
+    reals_per_slab = std::max(reals_per_slab, round_up(offset+li.size));
+  }
+
+  // Each thread allocates its own slab, so that it is placed close to it
+  num_threads = threads;
+  slabs = new real*[num_threads] {};
+  #pragma omp parallel
+  {
+    real*& slab = slabs[thread_id()];
+    if (posix_memalign(reinterpret_cast<void**>(&slab), alignment, reals_per_slab*sizeof(real)) != 0)
+    {
+      std::cerr << "Error! Cannot allocate the workspace of thread " << thread_id() << ".\n";
+      std::abort();
+    }
+    for (int i=0; i<NUM_TEMPORARIES; ++i)
+    {
+      if (liveness[i].zero)
+      {
+        std::fill_n (slab+offsets[i], liveness[i].size, 0.0);
+      }
+    }
+  }
+}
+
+void WorkspaceArena::cleanup_data ()
+{
+  for (int i=0; i<num_threads; ++i)
+  {
+    free(slabs[i]);
+  }
+  delete[] slabs;
+  slabs = nullptr;
+  num_threads = 0;
+  reals_per_slab = 0;
+}
+
+size_t WorkspaceArena::size (Temporary tmp)
+{
+  return liveness[tmp].size;
+}
+
+size_t WorkspaceArena::bytes_per_slab () const
+{
+  return reals_per_slab*sizeof(real);
+}
+
+size_t WorkspaceArena::unshared_bytes ()
+{
+  size_t reals = 0;
+  for (int i=0; i<NUM_TEMPORARIES; ++i)
+  {
+    reals += round_up(liveness[i].size);
+  }
+  return reals*sizeof(real);
+}
+
+} // Namespace Homme
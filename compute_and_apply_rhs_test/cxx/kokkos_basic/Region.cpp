@@ -3,12 +3,13 @@
 namespace TinMan
 {
 
-Region::Region( int num_elems )
+template<typename States>
+Region<States>::Region( int num_elems )
     : m_nelems( num_elems )
     , m_2d_scalars( "2d scalars", num_elems )
     , m_2d_tensors( "2d tensors", num_elems )
     , m_3d_scalars( "3d scalars", num_elems )
-    , m_4d_scalars( "4d scalars", num_elems )
+    , m_states( num_elems )
     , m_Qdp( "qdp", num_elems )
     , m_eta_dot_dpdn( "eta_dot_dpdn", num_elems )
 {
@@ -68,10 +69,10 @@ Region::Region( int num_elems )
             double iit = it + 1;
 
             // Initializing m_element_states
-            m_4d_scalars(ie,it,IDX_DP3D,il,ip,jp) = 10.0*iil + iie + iip + jjp + iit;
-            m_4d_scalars(ie,it,IDX_U,   il,ip,jp) = 1.0 + 0.5*iil + iip + jjp + 0.2*iie + 2.0*iit;
-            m_4d_scalars(ie,it,IDX_V,   il,ip,jp) = 1.0 + 0.5*iil + iip + jjp + 0.2*iie + 3.0*iit;
-            m_4d_scalars(ie,it,IDX_T,   il,ip,jp) = 1000.0 - iil - iip - jjp +0.1*iie + iit;
+            m_states(ie,it,IDX_DP3D)(il,ip,jp) = 10.0*iil + iie + iip + jjp + iit;
+            m_states(ie,it,IDX_U   )(il,ip,jp) = 1.0 + 0.5*iil + iip + jjp + 0.2*iie + 2.0*iit;
+            m_states(ie,it,IDX_V   )(il,ip,jp) = 1.0 + 0.5*iil + iip + jjp + 0.2*iie + 3.0*iit;
+            m_states(ie,it,IDX_T   )(il,ip,jp) = 1000.0 - iil - iip - jjp +0.1*iie + iit;
           }
         }
 
@@ -85,4 +86,10 @@ Region::Region( int num_elems )
   }
 }
 
+template class Region<StatesSTVER1>;
+template class Region<StatesSTVER2>;
+template class Region<StatesSTVER3>;
+template class Region<StatesSTVER4>;
+template class Region<StatesSoA>;
+
 } // namespace TinMan
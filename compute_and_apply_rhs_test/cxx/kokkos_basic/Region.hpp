@@ -32,12 +32,107 @@ constexpr int IDX_PHIS     = 3;
 constexpr int IDX_D        = 0;
 constexpr int IDX_DINV     = 1;
 
+// The storage orders of the element states (U, V, T and dp3d). Every one
+// keeps a [NUM_LEV][NP][NP] block contiguous for each element, time level and
+// state, and differs in the order of these three outer indices. The first four
+// mirror the ST array of the Fortran driver (see fortran/config1-4.h), whose
+// Fortran index order is the reverse of the C++ one
+
+// The states in one view, with the element, time level and state at positions
+// IE_POS, TL_POS and VAR_POS among its three outer indices
+template<int IE_POS, int TL_POS, int VAR_POS>
+class PermutedStates
+{
+  static_assert (IE_POS<3 && TL_POS<3 && VAR_POS<3 &&
+                 IE_POS!=TL_POS && IE_POS!=VAR_POS && TL_POS!=VAR_POS,
+                 "Error! The positions must be a permutation of 0, 1 and 2.\n");
+
+  ViewManaged< Real***[NUM_LEV][NP][NP] > m_states;
+
+  static int extent (const int pos, const int num_elems)
+  {
+    return pos==IE_POS ? num_elems : pos==TL_POS ? NUM_TIME_LEVELS : NUM_4D_SCALARS;
+  }
+
+public:
+
+  explicit
+  PermutedStates (int num_elems)
+    : m_states ("4d scalars", extent(0,num_elems), extent(1,num_elems), extent(2,num_elems))
+  {}
+
+  KOKKOS_FORCEINLINE_FUNCTION
+  ViewUnmanaged< Real[NUM_LEV][NP][NP] > operator() (const int ie, const int tl, const int var) const
+  {
+    int idx[3];
+    idx[IE_POS]  = ie;
+    idx[TL_POS]  = tl;
+    idx[VAR_POS] = var;
+    return Kokkos::subview(m_states, idx[0], idx[1], idx[2], Kokkos::ALL(), Kokkos::ALL(), Kokkos::ALL());
+  }
+};
+
+// Fortran ST(np,np,nlev,nelemd,numst,timelevels): [tl][st][ie]
+struct StatesSTVER1 : PermutedStates<2,0,1>
+{
+  explicit StatesSTVER1 (int num_elems) : PermutedStates<2,0,1>(num_elems) {}
+  static const char* name () { return "STVER1"; }
+};
+
+// Fortran ST(np,np,nlev,numst,nelemd,timelevels): [tl][ie][st]
+struct StatesSTVER2 : PermutedStates<1,0,2>
+{
+  explicit StatesSTVER2 (int num_elems) : PermutedStates<1,0,2>(num_elems) {}
+  static const char* name () { return "STVER2"; }
+};
+
+// Fortran ST(np,np,nlev,numst,timelevels,nelemd): [ie][tl][st], the original order
+struct StatesSTVER3 : PermutedStates<0,1,2>
+{
+  explicit StatesSTVER3 (int num_elems) : PermutedStates<0,1,2>(num_elems) {}
+  static const char* name () { return "STVER3"; }
+};
+
+// Fortran ST(np,np,nlev,timelevels,numst,nelemd): [ie][st][tl]
+struct StatesSTVER4 : PermutedStates<0,2,1>
+{
+  explicit StatesSTVER4 (int num_elems) : PermutedStates<0,2,1>(num_elems) {}
+  static const char* name () { return "STVER4"; }
+};
+
+// One view per state, each [ie][tl]
+class StatesSoA
+{
+  ViewManaged< Real*[NUM_TIME_LEVELS][NUM_LEV][NP][NP] > m_states[NUM_4D_SCALARS];
+
+public:
+
+  explicit
+  StatesSoA (int num_elems)
+  {
+    const char* names[NUM_4D_SCALARS] = { "U", "V", "T", "dp3d" };
+    for (int var=0; var<NUM_4D_SCALARS; ++var)
+    {
+      m_states[var] = ViewManaged< Real*[NUM_TIME_LEVELS][NUM_LEV][NP][NP] >(names[var], num_elems);
+    }
+  }
+
+  KOKKOS_FORCEINLINE_FUNCTION
+  ViewUnmanaged< Real[NUM_LEV][NP][NP] > operator() (const int ie, const int tl, const int var) const
+  {
+    return Kokkos::subview(m_states[var], ie, tl, Kokkos::ALL(), Kokkos::ALL(), Kokkos::ALL());
+  }
+
+  static const char* name () { return "SoA"; }
+};
+
+template<typename States>
 class Region
 {
 private:
 
   int m_nelems;
-  ViewManaged< Real*[NUM_TIME_LEVELS][NUM_4D_SCALARS][NUM_LEV][NP][NP] > m_4d_scalars;
+  States                                                                 m_states;
   ViewManaged< Real*[NUM_3D_SCALARS][NUM_LEV][NP][NP] >                  m_3d_scalars;
   ViewManaged< Real*[NUM_2D_SCALARS][NP][NP] >                           m_2d_scalars;
   ViewManaged< Real*[NUM_2D_TENSORS][2][2][NP][NP] >                     m_2d_tensors;
@@ -68,9 +163,10 @@ public:
     return m_3d_scalars;
   }
 
-  ViewUnmanaged< Real*[NUM_TIME_LEVELS][NUM_4D_SCALARS][NUM_LEV][NP][NP] > get_4d_scalars () const
+  // The states, to be indexed as states(ie,tl,IDX_U)(ilev,igp,jgp)
+  const States& get_states () const
   {
-    return m_4d_scalars;
+    return m_states;
   }
 
   ViewUnmanaged< Real*[QSIZE_D][2][NUM_LEV][NP][NP] > get_Qdp () const
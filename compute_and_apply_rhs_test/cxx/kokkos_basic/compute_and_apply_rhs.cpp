@@ -37,7 +37,8 @@ void preq_omega_ps(const ViewUnmanaged<Real[NUM_LEV][NP][NP]> p,
                    const ViewUnmanaged<Real[NUM_LEV][NP][NP]> div_vdp,
                    ViewUnmanaged<Real[NUM_LEV][NP][NP]> omega_p);
 
-void compute_and_apply_rhs (const TestData& data, Region& region)
+template<typename States>
+void compute_and_apply_rhs (const TestData& data, Region<States>& region)
 {
   using Kokkos::subview;
   using Kokkos::ALL;
@@ -68,7 +69,7 @@ void compute_and_apply_rhs (const TestData& data, Region& region)
   auto scalars_2d   = region.get_2d_scalars();
   auto tensors_2d   = region.get_2d_tensors();
   auto scalars_3d   = region.get_3d_scalars();
-  auto scalars_4d   = region.get_4d_scalars();
+  auto states       = region.get_states();
   auto Qdp          = region.get_Qdp();
   auto eta_dot_dpdn = region.get_eta_dot_dpdn();
 
@@ -89,16 +90,15 @@ void compute_and_apply_rhs (const TestData& data, Region& region)
     ViewUnmanaged<Real[NUM_2D_SCALARS][NP][NP]> scalars_2d_ie = subview(scalars_2d, ie, ALL(), ALL(), ALL());
     ViewUnmanaged<Real[NUM_2D_TENSORS][2][2][NP][NP]> tensors_2d_ie = subview(tensors_2d, ie, ALL(), ALL(), ALL(), ALL(), ALL());
     ViewUnmanaged<Real[NUM_3D_SCALARS][NUM_LEV][NP][NP]> scalars_3d_ie = subview(scalars_3d, ie, ALL(), ALL(), ALL(), ALL());
-    ViewUnmanaged<Real[NUM_TIME_LEVELS][NUM_4D_SCALARS][NUM_LEV][NP][NP]> scalars_4d_ie = subview(scalars_4d, ie, ALL(), ALL(), ALL(), ALL(), ALL());
 
     // Some subviews used more than once
     ViewUnmanaged<Real[NP][NP]> metDet_ie    = subview (scalars_2d_ie, IDX_METDET, ALL(), ALL());
     ViewUnmanaged<Real[NP][NP]> spheremp_ie  = subview (scalars_2d_ie, IDX_SPHEREMP, ALL(), ALL());
     ViewUnmanaged<Real[2][2][NP][NP]> DInv_ie      = subview (tensors_2d_ie, IDX_DINV, ALL(), ALL(), ALL(), ALL());
-    ViewUnmanaged<Real[NUM_LEV][NP][NP]> dp3d_ie_n0   = subview (scalars_4d_ie, n0, IDX_DP3D, ALL(), ALL(), ALL());
-    ViewUnmanaged<Real[NUM_LEV][NP][NP]> U_ie_n0      = subview (scalars_4d_ie, n0, IDX_U, ALL(), ALL(), ALL());
-    ViewUnmanaged<Real[NUM_LEV][NP][NP]> V_ie_n0      = subview (scalars_4d_ie, n0, IDX_V, ALL(), ALL(), ALL());
-    ViewUnmanaged<Real[NUM_LEV][NP][NP]> T_ie_n0      = subview (scalars_4d_ie, n0, IDX_T, ALL(), ALL(), ALL());
+    ViewUnmanaged<Real[NUM_LEV][NP][NP]> dp3d_ie_n0   = states (ie, n0, IDX_DP3D);
+    ViewUnmanaged<Real[NUM_LEV][NP][NP]> U_ie_n0      = states (ie, n0, IDX_U);
+    ViewUnmanaged<Real[NUM_LEV][NP][NP]> V_ie_n0      = states (ie, n0, IDX_V);
+    ViewUnmanaged<Real[NUM_LEV][NP][NP]> T_ie_n0      = states (ie, n0, IDX_T);
 
     // Other accessory variables
     Real v1     = 0;
@@ -245,14 +245,23 @@ void compute_and_apply_rhs (const TestData& data, Region& region)
 
       team.team_barrier();
 
+      ViewUnmanaged<Real[NUM_LEV][NP][NP]> U_ie_nm1    = states (ie, nm1, IDX_U);
+      ViewUnmanaged<Real[NUM_LEV][NP][NP]> V_ie_nm1    = states (ie, nm1, IDX_V);
+      ViewUnmanaged<Real[NUM_LEV][NP][NP]> T_ie_nm1    = states (ie, nm1, IDX_T);
+      ViewUnmanaged<Real[NUM_LEV][NP][NP]> dp3d_ie_nm1 = states (ie, nm1, IDX_DP3D);
+      ViewUnmanaged<Real[NUM_LEV][NP][NP]> U_ie_np1    = states (ie, np1, IDX_U);
+      ViewUnmanaged<Real[NUM_LEV][NP][NP]> V_ie_np1    = states (ie, np1, IDX_V);
+      ViewUnmanaged<Real[NUM_LEV][NP][NP]> T_ie_np1    = states (ie, np1, IDX_T);
+      ViewUnmanaged<Real[NUM_LEV][NP][NP]> dp3d_ie_np1 = states (ie, np1, IDX_DP3D);
+
       Kokkos::parallel_for(Kokkos::TeamThreadRange(team, NUM_LEV), [&](const int ilev) {
         Kokkos::parallel_for(Kokkos::ThreadVectorRange(team, NP * NP), [&](const int idx) {
           const int igp = idx / NP;
           const int jgp = idx % NP;
-          scalars_4d_ie(np1, IDX_U, ilev, igp, jgp)    = spheremp_ie(igp, jgp) * (scalars_4d_ie(nm1, IDX_U,    ilev, igp, jgp) + dt2 * vtens(ilev,0,igp,jgp));
-          scalars_4d_ie(np1, IDX_V, ilev, igp, jgp)    = spheremp_ie(igp, jgp) * (scalars_4d_ie(nm1, IDX_V,    ilev, igp, jgp) + dt2 * vtens(ilev,1,igp,jgp));
-          scalars_4d_ie(np1, IDX_T, ilev, igp, jgp)    = spheremp_ie(igp, jgp) * (scalars_4d_ie(nm1, IDX_T,    ilev, igp, jgp) + dt2 * ttens(ilev,igp,jgp));
-          scalars_4d_ie(np1, IDX_DP3D, ilev, igp, jgp) = spheremp_ie(igp, jgp) * (scalars_4d_ie(nm1, IDX_DP3D, ilev, igp, jgp) - dt2 * div_vdp(ilev, igp, jgp));
+          U_ie_np1(ilev, igp, jgp)    = spheremp_ie(igp, jgp) * (U_ie_nm1(ilev, igp, jgp)    + dt2 * vtens(ilev,0,igp,jgp));
+          V_ie_np1(ilev, igp, jgp)    = spheremp_ie(igp, jgp) * (V_ie_nm1(ilev, igp, jgp)    + dt2 * vtens(ilev,1,igp,jgp));
+          T_ie_np1(ilev, igp, jgp)    = spheremp_ie(igp, jgp) * (T_ie_nm1(ilev, igp, jgp)    + dt2 * ttens(ilev,igp,jgp));
+          dp3d_ie_np1(ilev, igp, jgp) = spheremp_ie(igp, jgp) * (dp3d_ie_nm1(ilev, igp, jgp) - dt2 * div_vdp(ilev, igp, jgp));
         });
       });
     }
@@ -400,7 +409,8 @@ void preq_omega_ps(const ViewUnmanaged<Real[NUM_LEV][NP][NP]> p,
   }
 }
 
-void print_results_2norm (const TestData& data, const Region& region)
+template<typename States>
+void print_results_2norm (const TestData& data, const Region<States>& region)
 {
   using Kokkos::subview;
   using Kokkos::ALL;
@@ -410,15 +420,15 @@ void print_results_2norm (const TestData& data, const Region& region)
   const int nete = data.control().nete;
   const int np1  = data.control().np1;
 
-  auto scalars_4d = region.get_4d_scalars();
+  const States& states = region.get_states();
 
   Real vnorm(0.), tnorm(0.), dpnorm(0.);
   for (int ie=nets; ie<nete; ++ie)
   {
-    ViewUnmanaged<Real[NUM_LEV][NP][NP]> U = subview(scalars_4d,ie,np1,IDX_U,   ALL(),ALL(),ALL());
-    ViewUnmanaged<Real[NUM_LEV][NP][NP]> V = subview(scalars_4d,ie,np1,IDX_V,   ALL(),ALL(),ALL());
-    ViewUnmanaged<Real[NUM_LEV][NP][NP]> T = subview(scalars_4d,ie,np1,IDX_T,   ALL(),ALL(),ALL());
-    ViewUnmanaged<Real[NUM_LEV][NP][NP]> P = subview(scalars_4d,ie,np1,IDX_DP3D,ALL(),ALL(),ALL());
+    ViewUnmanaged<Real[NUM_LEV][NP][NP]> U = states(ie,np1,IDX_U);
+    ViewUnmanaged<Real[NUM_LEV][NP][NP]> V = states(ie,np1,IDX_V);
+    ViewUnmanaged<Real[NUM_LEV][NP][NP]> T = states(ie,np1,IDX_T);
+    ViewUnmanaged<Real[NUM_LEV][NP][NP]> P = states(ie,np1,IDX_DP3D);
     vnorm  += std::pow( compute_norm( U ), 2 );
     vnorm  += std::pow( compute_norm( V ), 2 );
     tnorm  += std::pow( compute_norm( T ), 2 );
@@ -431,42 +441,49 @@ void print_results_2norm (const TestData& data, const Region& region)
             << "          ||dp||_2 = " << std::setprecision(17) << std::sqrt (dpnorm) << "\n";
 }
 
-void dump_results_to_file (const TestData& data, const Region& region)
+template<typename States>
+void dump_results_to_file (const TestData& data, const Region<States>& region,
+                           const std::string& suffix)
 {
   // Input parameters
   const int nets = data.control().nets;
   const int nete = data.control().nete;
   const int np1  = data.control().np1;
 
+  const std::string vx_name   = "elem_state_vx" + suffix + ".txt";
+  const std::string vy_name   = "elem_state_vy" + suffix + ".txt";
+  const std::string t_name    = "elem_state_t" + suffix + ".txt";
+  const std::string dp3d_name = "elem_state_dp3d" + suffix + ".txt";
+
   std::ofstream vxfile, vyfile, tfile, dpfile;
-  vxfile.open("elem_state_vx.txt");
+  vxfile.open(vx_name);
   if (!vxfile.is_open())
   {
-    std::cout << "Error! Cannot open 'elem_state_vx.txt'.\n";
+    std::cout << "Error! Cannot open '" << vx_name << "'.\n";
     std::abort();
   }
 
-  vyfile.open("elem_state_vy.txt");
+  vyfile.open(vy_name);
   if (!vyfile.is_open())
   {
     vxfile.close();
-    std::cout << "Error! Cannot open 'elem_state_vy.txt'.\n";
+    std::cout << "Error! Cannot open '" << vy_name << "'.\n";
     std::abort();
   }
 
-  tfile.open("elem_state_t.txt");
+  tfile.open(t_name);
   if (!tfile.is_open())
   {
-    std::cout << "Error! Cannot open 'elem_state_t.txt'.\n";
+    std::cout << "Error! Cannot open '" << t_name << "'.\n";
     vxfile.close();
     vyfile.close();
     std::abort();
   }
 
-  dpfile.open("elem_state_dp3d.txt");
+  dpfile.open(dp3d_name);
   if (!dpfile.is_open())
   {
-    std::cout << "Error! Cannot open 'elem_state_dp3d.txt'.\n";
+    std::cout << "Error! Cannot open '" << dp3d_name << "'.\n";
     vxfile.close();
     vyfile.close();
     tfile.close();
@@ -478,7 +495,7 @@ void dump_results_to_file (const TestData& data, const Region& region)
   tfile.precision(6);
   dpfile.precision(6);
 
-  auto scalars_4d = region.get_4d_scalars();
+  const States& states = region.get_states();
 
   for (int ie=nets; ie<nete; ++ie)
   {
@@ -493,10 +510,10 @@ void dump_results_to_file (const TestData& data, const Region& region)
       {
         for (int jgp=0; jgp<NP; ++jgp)
         {
-          vxfile << " " << scalars_4d(ie,IDX_U,np1,ilev,igp,jgp)   ;
-          vyfile << " " << scalars_4d(ie,IDX_V,np1,ilev,igp,jgp)   ;
-          tfile  << " " << scalars_4d(ie,IDX_T,np1,ilev,igp,jgp)   ;
-          dpfile << " " << scalars_4d(ie,IDX_DP3D,np1,ilev,igp,jgp);
+          vxfile << " " << states(ie,np1,IDX_U)(ilev,igp,jgp)   ;
+          vyfile << " " << states(ie,np1,IDX_V)(ilev,igp,jgp)   ;
+          tfile  << " " << states(ie,np1,IDX_T)(ilev,igp,jgp)   ;
+          dpfile << " " << states(ie,np1,IDX_DP3D)(ilev,igp,jgp);
         }
         vxfile << "\n";
         vyfile << "\n";
@@ -513,4 +530,27 @@ void dump_results_to_file (const TestData& data, const Region& region)
   dpfile.close();
 };
 
+template void compute_and_apply_rhs (const TestData& data, Region<StatesSTVER1>& region);
+template void compute_and_apply_rhs (const TestData& data, Region<StatesSTVER2>& region);
+template void compute_and_apply_rhs (const TestData& data, Region<StatesSTVER3>& region);
+template void compute_and_apply_rhs (const TestData& data, Region<StatesSTVER4>& region);
+template void compute_and_apply_rhs (const TestData& data, Region<StatesSoA>& region);
+
+template void print_results_2norm (const TestData& data, const Region<StatesSTVER1>& region);
+template void print_results_2norm (const TestData& data, const Region<StatesSTVER2>& region);
+template void print_results_2norm (const TestData& data, const Region<StatesSTVER3>& region);
+template void print_results_2norm (const TestData& data, const Region<StatesSTVER4>& region);
+template void print_results_2norm (const TestData& data, const Region<StatesSoA>& region);
+
+template void dump_results_to_file (const TestData& data, const Region<StatesSTVER1>& region,
+                                    const std::string& suffix);
+template void dump_results_to_file (const TestData& data, const Region<StatesSTVER2>& region,
+                                    const std::string& suffix);
+template void dump_results_to_file (const TestData& data, const Region<StatesSTVER3>& region,
+                                    const std::string& suffix);
+template void dump_results_to_file (const TestData& data, const Region<StatesSTVER4>& region,
+                                    const std::string& suffix);
+template void dump_results_to_file (const TestData& data, const Region<StatesSoA>& region,
+                                    const std::string& suffix);
+
 } // Namespace TinMan
@@ -5,18 +5,27 @@
 
 #include "Types.hpp"
 
+#include <string>
+
 namespace TinMan
 {
 
 // Forward declarations
 class TestData;
+template<typename States>
 class Region;
 
-void compute_and_apply_rhs (const TestData& data, Region& region);
+// These are instantiated for the storage orders of the states in Region.hpp
+template<typename States>
+void compute_and_apply_rhs (const TestData& data, Region<States>& region);
 
-void print_results_2norm (const TestData& data, const Region& region);
+template<typename States>
+void print_results_2norm (const TestData& data, const Region<States>& region);
 
-void dump_results_to_file (const TestData& data, const Region& region);
+// Writes elem_state_<field><suffix>.txt for the fields v, T and dp3d
+template<typename States>
+void dump_results_to_file (const TestData& data, const Region<States>& region,
+                           const std::string& suffix);
 
 template<typename ViewType>
 Real compute_norm (const ViewType view)
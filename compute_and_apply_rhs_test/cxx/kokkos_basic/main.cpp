@@ -7,6 +7,7 @@
 #include <iostream>
 #include <cstring>
 #include <memory>
+#include <string>
 
 bool is_unsigned_int(const char* str)
 {
@@ -19,11 +20,66 @@ bool is_unsigned_int(const char* str)
   return true;
 }
 
+// Run the kernel on a Region storing its states in the order given by States.
+// With tag_dump, the name of the order is appended to the dump file names, so
+// that the orders compared in one run do not overwrite each other's results
+template<typename States>
+void run_simulation (const TinMan::TestData& data, int num_elems, int num_exec, bool dump_res,
+                     bool tag_dump)
+{
+  std::cout << " --- States stored in the " << States::name() << " order\n";
+
+  TinMan::Region<States>* region = new TinMan::Region<States>(num_elems); // A pointer, so the views are destryed before Kokkos::finalize
+
+  // Print norm of initial states, to check we are using same data in all tests
+  print_results_2norm (data, *region);
+
+  // Burn in before timing to reduce cache effect
+  //TinMan::compute_and_apply_rhs(data,*region);
+
+  std::cout << " --- Performing computations... (" << num_exec << " executions of the main loop on " << num_elems << " elements)\n";
+
+  //std::unique_ptr<Timer::Timer[]> timers(new Timer::Timer[num_exec]);
+  Timer::Timer global_timer;
+  global_timer.startTimer();
+  for (int i=0; i<num_exec; ++i)
+  {
+    //timers[i].startTimer();
+    TinMan::compute_and_apply_rhs(data,*region);
+    //data.update_time_levels();
+    //timers[i].stopTimer();
+  }
+#ifdef KOKKOS_HAVE_DEFAULT_DEVICE_TYPE_OPENMP
+  Kokkos::OpenMP::fence();
+#endif
+  global_timer.stopTimer();
+
+/*
+  std::cout << "   ---> individual executions times:\n";
+  for(int i = 0; i < num_exec; ++i) {
+    std::cout << timers[i] << std::endl;
+  }
+*/
+  std::cout << "   ---> compute_and_apply_rhs execution total time: " << global_timer << "\n";
+
+  print_results_2norm (data,*region);
+
+  if (dump_res)
+  {
+    std::cout << " --- Dumping results to file...\n";
+    dump_results_to_file (data,*region,tag_dump ? std::string("_") + States::name() : std::string());
+  }
+
+  std::cout << " --- Cleaning up data...\n";
+  delete region;
+}
+
 int main (int argc, char** argv)
 {
   int num_elems = 10;
   bool dump_res = false;
   int num_exec = 1;
+  std::string state_layout = "stver3";
 
   if (argc > 1) {
     int iarg = 1;
@@ -69,6 +125,19 @@ int main (int argc, char** argv)
         ++iarg;
         continue;
       }
+      else if (strncmp(argv[iarg],"--tinman-state-layout=",22) == 0)
+      {
+        state_layout = strchr(argv[iarg],'=')+1;
+        if (state_layout!="stver1" && state_layout!="stver2" && state_layout!="stver3" &&
+            state_layout!="stver4" && state_layout!="soa" && state_layout!="all")
+        {
+          std::cerr << "Expecting one of stver1, stver2, stver3, stver4, soa or all after '--tinman-state-layout='.\n";
+          std::exit(1);
+        }
+
+        ++iarg;
+        continue;
+      }
       else if (strncmp(argv[iarg],"--tinman-help",13) == 0)
       {
         std::cout << "+------------------------------------------------------------------------+\n"
@@ -77,6 +146,10 @@ int main (int argc, char** argv)
                   << "|  --tinman-num-elems=N  : the number of elements (default=10)           |\n"
                   << "|  --tinman-dump-res=val : whether to dump results to file (default=no)  |\n"
                   << "|  --tinman-num-exec=N   : number of times to execute (default=1)        |\n"
+                  << "|  --tinman-state-layout=val : the storage order of the states: stver1,  |\n"
+                  << "|                          stver2, stver3, stver4, soa or all (default=  |\n"
+                  << "|                          stver3, all compares them and suffixes the    |\n"
+                  << "|                          dump files with the name of the order)        |\n"
                   << "|  --tinman-help         : prints this message                           |\n"
                   << "|  --kokkos-help         : prints kokkos help                            |\n"
                   << "+------------------------------------------------------------------------+\n";
@@ -101,49 +174,33 @@ int main (int argc, char** argv)
 
   std::cout << " --- Initializing data...\n";
   TinMan::TestData data(num_elems);
-  TinMan::Region* region = new TinMan::Region(num_elems); // A pointer, so the views are destryed before Kokkos::finalize
-
-  // Print norm of initial states, to check we are using same data in all tests
-  print_results_2norm (data, *region);
 
-  // Burn in before timing to reduce cache effect
-  //TinMan::compute_and_apply_rhs(data,*region);
-
-  std::cout << " --- Performing computations... (" << num_exec << " executions of the main loop on " << num_elems << " elements)\n";
-
-  //std::unique_ptr<Timer::Timer[]> timers(new Timer::Timer[num_exec]);
-  Timer::Timer global_timer;
-  global_timer.startTimer();
-  for (int i=0; i<num_exec; ++i)
+  // The original order is STVER3. With 'all', the orders are compared in one run
+  const bool all_layouts = state_layout=="all";
+  if (all_layouts || state_layout=="stver1")
   {
-    //timers[i].startTimer();
-    TinMan::compute_and_apply_rhs(data,*region);
-    //data.update_time_levels();
-    //timers[i].stopTimer();
+    run_simulation<TinMan::StatesSTVER1>(data, num_elems, num_exec, dump_res, all_layouts);
   }
-#ifdef KOKKOS_HAVE_DEFAULT_DEVICE_TYPE_OPENMP
-  Kokkos::OpenMP::fence();
-#endif
-  global_timer.stopTimer();
 
-/*
-  std::cout << "   ---> individual executions times:\n";
-  for(int i = 0; i < num_exec; ++i) {
-    std::cout << timers[i] << std::endl;
+  if (all_layouts || state_layout=="stver2")
+  {
+    run_simulation<TinMan::StatesSTVER2>(data, num_elems, num_exec, dump_res, all_layouts);
   }
-*/
-  std::cout << "   ---> compute_and_apply_rhs execution total time: " << global_timer << "\n";
 
-  print_results_2norm (data,*region);
+  if (all_layouts || state_layout=="stver3")
+  {
+    run_simulation<TinMan::StatesSTVER3>(data, num_elems, num_exec, dump_res, all_layouts);
+  }
 
-  if (dump_res)
+  if (all_layouts || state_layout=="stver4")
   {
-    std::cout << " --- Dumping results to file...\n";
-    dump_results_to_file (data,*region);
+    run_simulation<TinMan::StatesSTVER4>(data, num_elems, num_exec, dump_res, all_layouts);
   }
 
-  std::cout << " --- Cleaning up data...\n";
-  delete region;
+  if (all_layouts || state_layout=="soa")
+  {
+    run_simulation<TinMan::StatesSoA>(data, num_elems, num_exec, dump_res, all_layouts);
+  }
 
   Kokkos::finalize ();
   return 0;
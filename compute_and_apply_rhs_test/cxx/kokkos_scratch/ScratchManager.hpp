@@ -3,6 +3,10 @@
 
 #include "Types.hpp"
 
+#include <cassert>
+#include <cstdint>
+#include <type_traits>
+
 namespace TinMan
 {
 
@@ -36,6 +40,40 @@ struct CountAndSizePack<Count,Size>
   static constexpr size_t total_size  = head::size*head::count;
 };
 
+// A pair <Count,Size> which also knows the type of its views. DataType has
+// compile-time extents, and its value type is Real or a pack of Reals such
+// as Scalar
+template<size_t Count, typename DataType>
+struct CountAndType : CountAndSize<Count,sizeof(DataType)/sizeof(Real)>
+{
+  static_assert (std::is_array<DataType>::value, "Error! The views of a block need compile-time extents.\n");
+  static_assert (sizeof(DataType)%sizeof(Real)==0, "Error! The views of a block must hold a whole number of Reals.\n");
+
+  typedef DataType data_type;
+};
+
+// A pack of CountAndType pairs, usable wherever a CountAndSizePack is
+template<typename Head, typename... Tail>
+struct CountAndTypePack
+{
+  typedef Head                      head;
+  typedef CountAndTypePack<Tail...> tail;
+
+  static constexpr size_t num_blocks  = 1 + tail::num_blocks;
+  static constexpr size_t total_count = head::count + tail::total_count;
+  static constexpr size_t total_size  = head::size*head::count  + tail::total_size;
+};
+
+template<typename Head>
+struct CountAndTypePack<Head>
+{
+  typedef Head head;
+
+  static constexpr size_t num_blocks  = 1;
+  static constexpr size_t total_count = head::count;
+  static constexpr size_t total_size  = head::size*head::count;
+};
+
 // Given a CountAndSizePack, we compute the offset of the COUNTER_ID-th view in the BLOCK_ID-th CountAndSize pair
 template<typename CountAndSizePack, size_t BLOCK_ID, size_t COUNTER_ID>
 struct ScratchOffset
@@ -83,6 +121,357 @@ struct ScratchOffset<CountAndSizePack,0,0>
   static constexpr size_t value = 0;
 };
 
+// The COUNTER_ID-th view in the BLOCK_ID-th CountAndSize pair, as used by a phase of a kernel
+template<size_t BLOCK_ID, size_t COUNTER_ID>
+struct ScratchBuffer
+{
+  static constexpr size_t block_id   = BLOCK_ID;
+  static constexpr size_t counter_id = COUNTER_ID;
+};
+
+// The buffers used by a phase of a kernel. Phases are separated by team barriers
+template<typename... Buffers>
+struct ScratchPhase {};
+
+// The buffers which a kernel zeroes before its first phase. They are live in
+// every phase, so they never share memory and keep their zeros until the
+// kernel writes them. Phases are numbered as if this were one of them
+template<typename... Buffers>
+struct ScratchZeroed {};
+
+// The views of a CountAndSizePack laid out by liveness: a view is live from the
+// first to the last of the phases which use it, and views which are never live
+// in the same phase may share memory. Offsets are assigned at compile time, in
+// the order of the views in the pack, at the lowest offset where a view does
+// not overlap any view placed before it whose lifetime overlaps its own
+template<typename CountAndSizePack, typename... Phases>
+struct ScratchLayout;
+
+namespace Impl
+{
+
+constexpr size_t no_phase = static_cast<size_t>(-1);
+
+// The index of the COUNTER_ID-th view in the BLOCK_ID-th pair, counting the views of all blocks
+template<typename CountAndSizePack, size_t BLOCK_ID, size_t COUNTER_ID>
+struct FlatIndex
+{
+  typedef CountAndSizePack pack;
+
+  static constexpr size_t value = pack::head::count + FlatIndex<typename pack::tail,BLOCK_ID-1,COUNTER_ID>::value;
+};
+
+template<typename CountAndSizePack, size_t COUNTER_ID>
+struct FlatIndex<CountAndSizePack,0,COUNTER_ID>
+{
+  static_assert (COUNTER_ID<CountAndSizePack::head::count, "Error! The COUNTER_ID parameter is out of bounds.\n");
+
+  static constexpr size_t value = COUNTER_ID;
+};
+
+// The size of the INDEX-th view, counting the views of all blocks
+template<typename CountAndSizePack, size_t INDEX, bool IN_HEAD = (INDEX<CountAndSizePack::head::count)>
+struct FlatSize
+{
+  static constexpr size_t value = CountAndSizePack::head::size;
+};
+
+template<typename CountAndSizePack, size_t INDEX>
+struct FlatSize<CountAndSizePack,INDEX,false>
+{
+  typedef CountAndSizePack pack;
+
+  static constexpr size_t value = FlatSize<typename pack::tail,INDEX-pack::head::count>::value;
+};
+
+// Whether a phase uses the INDEX-th view
+template<typename CountAndSizePack, size_t INDEX, typename Phase>
+struct PhaseUses;
+
+template<typename CountAndSizePack, size_t INDEX>
+struct PhaseUses<CountAndSizePack,INDEX,ScratchPhase<>>
+{
+  static constexpr bool value = false;
+};
+
+template<typename CountAndSizePack, size_t INDEX, typename Buffer, typename... Buffers>
+struct PhaseUses<CountAndSizePack,INDEX,ScratchPhase<Buffer,Buffers...>>
+{
+  static constexpr bool value = FlatIndex<CountAndSizePack,Buffer::block_id,Buffer::counter_id>::value==INDEX
+                             || PhaseUses<CountAndSizePack,INDEX,ScratchPhase<Buffers...>>::value;
+};
+
+template<typename CountAndSizePack, size_t INDEX, typename... Buffers>
+struct PhaseUses<CountAndSizePack,INDEX,ScratchZeroed<Buffers...>>
+{
+  static constexpr bool value = PhaseUses<CountAndSizePack,INDEX,ScratchPhase<Buffers...>>::value;
+};
+
+// Whether the INDEX-th view is one of the zeroed buffers
+template<typename CountAndSizePack, size_t INDEX, typename... Phases>
+struct ZeroedUse
+{
+  static constexpr bool value = false;
+};
+
+template<typename CountAndSizePack, size_t INDEX, typename Phase, typename... Phases>
+struct ZeroedUse<CountAndSizePack,INDEX,Phase,Phases...>
+{
+  static constexpr bool value = ZeroedUse<CountAndSizePack,INDEX,Phases...>::value;
+};
+
+template<typename CountAndSizePack, size_t INDEX, typename... Buffers, typename... Phases>
+struct ZeroedUse<CountAndSizePack,INDEX,ScratchZeroed<Buffers...>,Phases...>
+{
+  static constexpr bool value = PhaseUses<CountAndSizePack,INDEX,ScratchPhase<Buffers...>>::value
+                             || ZeroedUse<CountAndSizePack,INDEX,Phases...>::value;
+};
+
+// The first and last of the phases, numbered from PHASE, which use the INDEX-th view
+template<typename CountAndSizePack, size_t INDEX, size_t PHASE, typename... Phases>
+struct FirstUse
+{
+  static constexpr size_t value = no_phase;
+};
+
+template<typename CountAndSizePack, size_t INDEX, size_t PHASE, typename Phase, typename... Phases>
+struct FirstUse<CountAndSizePack,INDEX,PHASE,Phase,Phases...>
+{
+  static constexpr size_t value = PhaseUses<CountAndSizePack,INDEX,Phase>::value
+                                ? PHASE : FirstUse<CountAndSizePack,INDEX,PHASE+1,Phases...>::value;
+};
+
+template<typename CountAndSizePack, size_t INDEX, size_t PHASE, typename... Phases>
+struct LastUse
+{
+  static constexpr size_t value = no_phase;
+};
+
+template<typename CountAndSizePack, size_t INDEX, size_t PHASE, typename Phase, typename... Phases>
+struct LastUse<CountAndSizePack,INDEX,PHASE,Phase,Phases...>
+{
+  static constexpr size_t later = LastUse<CountAndSizePack,INDEX,PHASE+1,Phases...>::value;
+  static constexpr size_t value = later!=no_phase ? later
+                                : PhaseUses<CountAndSizePack,INDEX,Phase>::value ? PHASE : no_phase;
+};
+
+// The size, lifetime and offset of the INDEX-th view of a layout
+template<typename Layout, size_t INDEX>
+struct LayoutView;
+
+template<typename Layout, size_t INDEX>
+struct LayoutOffset;
+
+// Whether the INDEX-th view fits at OFFSET, given the views placed before the OTHER-th one
+template<typename Layout, size_t INDEX, size_t OFFSET, size_t OTHER>
+struct FitsAt
+{
+  typedef LayoutView<Layout,INDEX> view;
+  typedef LayoutView<Layout,OTHER> other;
+
+  static constexpr size_t other_offset = LayoutOffset<Layout,OTHER>::value;
+  static constexpr bool   conflict = view::first<=other::last && other::first<=view::last
+                                  && OFFSET<other_offset+other::size && other_offset<OFFSET+view::size;
+
+  static constexpr bool value = !conflict && FitsAt<Layout,INDEX,OFFSET,OTHER+1>::value;
+};
+
+template<typename Layout, size_t INDEX, size_t OFFSET>
+struct FitsAt<Layout,INDEX,OFFSET,INDEX>
+{
+  static constexpr bool value = true;
+};
+
+// The lowest offset where the INDEX-th view fits, among 0 and the ends of the
+// views before the CANDIDATE-th one
+template<typename Layout, size_t INDEX, size_t CANDIDATE>
+struct LowestFit
+{
+  static constexpr size_t offset = LayoutOffset<Layout,CANDIDATE-1>::value + LayoutView<Layout,CANDIDATE-1>::size;
+  static constexpr size_t lower  = LowestFit<Layout,INDEX,CANDIDATE-1>::value;
+
+  static constexpr size_t value = FitsAt<Layout,INDEX,offset,0>::value && offset<lower ? offset : lower;
+};
+
+template<typename Layout, size_t INDEX>
+struct LowestFit<Layout,INDEX,0>
+{
+  static constexpr size_t value = FitsAt<Layout,INDEX,0,0>::value ? 0 : static_cast<size_t>(-1);
+};
+
+template<typename CountAndSizePack, typename... Phases, size_t INDEX>
+struct LayoutView<ScratchLayout<CountAndSizePack,Phases...>,INDEX>
+{
+  static constexpr bool   zeroed = ZeroedUse<CountAndSizePack,INDEX,Phases...>::value;
+  static constexpr size_t size   = FlatSize<CountAndSizePack,INDEX>::value;
+  static constexpr size_t first  = zeroed ? 0 : FirstUse<CountAndSizePack,INDEX,0,Phases...>::value;
+  static constexpr size_t last   = zeroed ? sizeof...(Phases)-1 : LastUse<CountAndSizePack,INDEX,0,Phases...>::value;
+
+  static_assert (first!=no_phase, "Error! A view of the layout is not used by any phase.\n");
+};
+
+template<typename Layout, size_t INDEX>
+struct LayoutOffset
+{
+  static constexpr size_t value = LowestFit<Layout,INDEX,INDEX>::value;
+};
+
+// The end of the last of the first COUNT views of a layout
+template<typename Layout, size_t COUNT>
+struct LayoutEnd
+{
+  static constexpr size_t end   = LayoutOffset<Layout,COUNT-1>::value + LayoutView<Layout,COUNT-1>::size;
+  static constexpr size_t lower = LayoutEnd<Layout,COUNT-1>::value;
+
+  static constexpr size_t value = end>lower ? end : lower;
+};
+
+template<typename Layout>
+struct LayoutEnd<Layout,0>
+{
+  static constexpr size_t value = 0;
+};
+
+} // namespace Impl
+
+template<typename CountAndSizePack, typename... Phases>
+struct ScratchLayout
+{
+  typedef CountAndSizePack pack;
+
+  static constexpr size_t num_blocks  = pack::num_blocks;
+  static constexpr size_t total_count = pack::total_count;
+  static constexpr size_t total_size  = Impl::LayoutEnd<ScratchLayout,total_count>::value;
+
+  // The size without sharing any memory
+  static constexpr size_t unshared_size = pack::total_size;
+};
+
+// The offset of the COUNTER_ID-th view in the BLOCK_ID-th block of either a
+// CountAndSizePack or a ScratchLayout
+template<typename SizesPack, size_t BLOCK_ID, size_t COUNTER_ID>
+struct ViewOffset
+{
+  static constexpr size_t value = ScratchOffset<SizesPack,BLOCK_ID,COUNTER_ID>::value;
+};
+
+template<typename CountAndSizePack, typename... Phases, size_t BLOCK_ID, size_t COUNTER_ID>
+struct ViewOffset<ScratchLayout<CountAndSizePack,Phases...>,BLOCK_ID,COUNTER_ID>
+{
+  typedef ScratchLayout<CountAndSizePack,Phases...> layout;
+
+  static constexpr size_t value = Impl::LayoutOffset<layout,Impl::FlatIndex<CountAndSizePack,BLOCK_ID,COUNTER_ID>::value>::value;
+};
+
+namespace Impl
+{
+
+// The CountAndSizePack of either a CountAndSizePack or a ScratchLayout
+template<typename SizesPack>
+struct PackBlocks
+{
+  typedef SizesPack type;
+};
+
+template<typename CountAndSizePack, typename... Phases>
+struct PackBlocks<ScratchLayout<CountAndSizePack,Phases...>>
+{
+  typedef CountAndSizePack type;
+};
+
+// The BLOCK_ID-th CountAndSize pair of a CountAndSizePack
+template<typename CountAndSizePack, size_t BLOCK_ID>
+struct PackBlock
+{
+  typedef typename PackBlock<typename CountAndSizePack::tail,BLOCK_ID-1>::type type;
+};
+
+template<typename CountAndSizePack>
+struct PackBlock<CountAndSizePack,0>
+{
+  typedef typename CountAndSizePack::head type;
+};
+
+// The range [begin,end) spanned by the first COUNT views of the BLOCK_ID-th block
+template<typename SizesPack, size_t BLOCK_ID,
+         size_t COUNT = PackBlock<typename PackBlocks<SizesPack>::type,BLOCK_ID>::type::count>
+struct BlockRange
+{
+  typedef typename PackBlock<typename PackBlocks<SizesPack>::type,BLOCK_ID>::type block;
+  typedef BlockRange<SizesPack,BLOCK_ID,COUNT-1> lower;
+
+  static constexpr size_t view_begin = ViewOffset<SizesPack,BLOCK_ID,COUNT-1>::value;
+  static constexpr size_t view_end   = view_begin + block::size;
+
+  static constexpr size_t begin = view_begin<lower::begin ? view_begin : lower::begin;
+  static constexpr size_t end   = view_end>lower::end ? view_end : lower::end;
+};
+
+template<typename SizesPack, size_t BLOCK_ID>
+struct BlockRange<SizesPack,BLOCK_ID,1>
+{
+  typedef typename PackBlock<typename PackBlocks<SizesPack>::type,BLOCK_ID>::type block;
+
+  static constexpr size_t begin = ViewOffset<SizesPack,BLOCK_ID,0>::value;
+  static constexpr size_t end   = begin + block::size;
+};
+
+// Fill the ranges of the first NUM_BLOCKS blocks
+template<typename SizesPack, size_t NUM_BLOCKS = SizesPack::num_blocks>
+struct BlockRanges
+{
+  KOKKOS_INLINE_FUNCTION
+  static void fill (size_t* begins, size_t* ends)
+  {
+    BlockRanges<SizesPack,NUM_BLOCKS-1>::fill(begins,ends);
+    begins[NUM_BLOCKS-1] = BlockRange<SizesPack,NUM_BLOCKS-1>::begin;
+    ends[NUM_BLOCKS-1]   = BlockRange<SizesPack,NUM_BLOCKS-1>::end;
+  }
+};
+
+template<typename SizesPack>
+struct BlockRanges<SizesPack,0>
+{
+  KOKKOS_INLINE_FUNCTION
+  static void fill (size_t*, size_t*) {}
+};
+
+// The type of the views of the BLOCK_ID-th block, which must be a CountAndType
+template<typename SizesPack, size_t BLOCK_ID>
+struct BlockDataType
+{
+  typedef typename PackBlock<typename PackBlocks<SizesPack>::type,BLOCK_ID>::type::data_type type;
+};
+
+// Whether the views of all the blocks are a multiple of ALIGNMENT Reals, so
+// that each view starts where its level does, modulo ALIGNMENT
+template<typename CountAndSizePack, size_t ALIGNMENT, size_t NUM_BLOCKS = CountAndSizePack::num_blocks>
+struct BlocksAligned
+{
+  static constexpr bool value = CountAndSizePack::head::size%ALIGNMENT==0
+                             && BlocksAligned<typename CountAndSizePack::tail,ALIGNMENT,NUM_BLOCKS-1>::value;
+};
+
+template<typename CountAndSizePack, size_t ALIGNMENT>
+struct BlocksAligned<CountAndSizePack,ALIGNMENT,1>
+{
+  static constexpr bool value = CountAndSizePack::head::size%ALIGNMENT==0;
+};
+
+} // namespace Impl
+
+// The most blocks a pack can have
+constexpr int max_scratch_blocks = 8;
+
+// The scratch level, 0 or 1, of each block of the team and thread packs.
+// Level 0 is the small and fast one (shared memory on GPUs), level 1 the large
+// one. A default constructed placement puts everything in level 0
+struct ScratchPlacement
+{
+  int team_levels[max_scratch_blocks]   = {};
+  int thread_levels[max_scratch_blocks] = {};
+};
+
 template<typename TeamSizesPack, typename ThreadSizesPack>
 class ScratchManager
 {
@@ -94,28 +483,174 @@ public:
   static constexpr size_t sum_team_sizes   = team_sizes_pack::total_size;
   static constexpr size_t sum_thread_sizes = thread_sizes_pack::total_size;
 
+  static constexpr int num_team_blocks   = team_sizes_pack::num_blocks;
+  static constexpr int num_thread_blocks = thread_sizes_pack::num_blocks;
+
+  static_assert (num_team_blocks<=max_scratch_blocks && num_thread_blocks<=max_scratch_blocks,
+                 "Error! Too many blocks for a ScratchPlacement.\n");
+
+  // Every view starts on a boundary of this many bytes, so that vector loads
+  // and stores of scratch can assume it
+  static constexpr size_t alignment = 64;
+  static constexpr size_t reals_per_alignment = alignment/sizeof(Real);
+
+  static_assert (Impl::BlocksAligned<typename Impl::PackBlocks<team_sizes_pack>::type,reals_per_alignment>::value &&
+                 Impl::BlocksAligned<typename Impl::PackBlocks<thread_sizes_pack>::type,reals_per_alignment>::value,
+                 "Error! The views of every block must be a multiple of the alignment.\n");
+
+  // Each level holds the blocks placed in it, keeping their relative offsets
+  // (so that views of different blocks still share memory), and then the
+  // blocks of each thread placed in it
+  KOKKOS_INLINE_FUNCTION
+  ScratchManager (const ScratchPlacement& placement = ScratchPlacement())
+  {
+    place_blocks<team_sizes_pack>(placement.team_levels, m_team_levels, m_team_bases, m_team_sizes);
+    place_blocks<thread_sizes_pack>(placement.thread_levels, m_thread_levels, m_thread_bases, m_thread_sizes);
+    m_level_memory[0] = m_level_memory[1] = nullptr;
+  }
+
   // Get a block of memory for a given block ID
   template<size_t BLOCK_ID, size_t COUNTER_ID>
-  Real* get_team_scratch () { return m_team_scratch + ScratchOffset<team_sizes_pack,BLOCK_ID,COUNTER_ID>::value; }
+  KOKKOS_INLINE_FUNCTION
+  Real* get_team_scratch () const
+  {
+    static_assert (BLOCK_ID<num_team_blocks, "Error! The BLOCK_ID parameter is out of bounds.\n");
+
+    const int level = m_team_levels[BLOCK_ID];
+    const size_t offset = m_team_bases[BLOCK_ID] + ViewOffset<team_sizes_pack,BLOCK_ID,COUNTER_ID>::value
+                        - Impl::BlockRange<team_sizes_pack,BLOCK_ID>::begin;
+    typedef typename Impl::PackBlock<typename Impl::PackBlocks<team_sizes_pack>::type,BLOCK_ID>::type block;
+    assert (offset+block::size <= m_team_sizes[level]);
+
+    return m_level_memory[level] + offset;
+  }
 
   // Get a block of memory for a given thread and block ID
   template<size_t BLOCK_ID, size_t COUNTER_ID>
-  Real* get_thread_scratch (int thread_id) { return m_thread_scratch + thread_id*sum_thread_sizes + ScratchOffset<thread_sizes_pack,BLOCK_ID,COUNTER_ID>::value; }
+  KOKKOS_INLINE_FUNCTION
+  Real* get_thread_scratch (int thread_id) const
+  {
+    static_assert (BLOCK_ID<num_thread_blocks, "Error! The BLOCK_ID parameter is out of bounds.\n");
+
+    const int level = m_thread_levels[BLOCK_ID];
+    const size_t offset = m_thread_bases[BLOCK_ID] + ViewOffset<thread_sizes_pack,BLOCK_ID,COUNTER_ID>::value
+                        - Impl::BlockRange<thread_sizes_pack,BLOCK_ID>::begin;
+    typedef typename Impl::PackBlock<typename Impl::PackBlocks<thread_sizes_pack>::type,BLOCK_ID>::type block;
+    assert (offset+block::size <= m_thread_sizes[level]);
 
-  static int memory_needed (const int team_size) { return sizeof(Real) * (sum_team_sizes + sum_thread_sizes*team_size); }
+    return m_level_memory[level] + m_team_sizes[level] + thread_id*m_thread_sizes[level] + offset;
+  }
 
+  // The COUNTER_ID-th view of the BLOCK_ID-th team block, with the type given
+  // by its CountAndType. View is ExecViewUnmanaged or ScratchView
+  template<size_t BLOCK_ID, size_t COUNTER_ID, template<typename> class View = ExecViewUnmanaged>
+  KOKKOS_INLINE_FUNCTION
+  View<typename Impl::BlockDataType<team_sizes_pack,BLOCK_ID>::type> get_team_view () const
+  {
+    typedef typename Impl::BlockDataType<team_sizes_pack,BLOCK_ID>::type data_type;
+    typedef typename std::remove_all_extents<data_type>::type            value_type;
+
+    return View<data_type>(reinterpret_cast<value_type*>(get_team_scratch<BLOCK_ID,COUNTER_ID>()));
+  }
+
+  // The same, for the views of a thread
+  template<size_t BLOCK_ID, size_t COUNTER_ID, template<typename> class View = ExecViewUnmanaged>
+  KOKKOS_INLINE_FUNCTION
+  View<typename Impl::BlockDataType<thread_sizes_pack,BLOCK_ID>::type> get_thread_view (int thread_id) const
+  {
+    typedef typename Impl::BlockDataType<thread_sizes_pack,BLOCK_ID>::type data_type;
+    typedef typename std::remove_all_extents<data_type>::type              value_type;
+
+    return View<data_type>(reinterpret_cast<value_type*>(get_thread_scratch<BLOCK_ID,COUNTER_ID>(thread_id)));
+  }
+
+  // The memory needed with all the blocks in level 0
+  static int memory_needed (const int team_size) { return sizeof(Real) * (sum_team_sizes + sum_thread_sizes*team_size) + alignment; }
+
+  // The memory needed in a level, including the room to align its start
+  KOKKOS_INLINE_FUNCTION
+  int memory_needed (const int level, const int team_size) const
+  {
+    const int bytes = sizeof(Real) * (m_team_sizes[level] + m_thread_sizes[level]*team_size);
+    return bytes>0 ? bytes + alignment : 0;
+  }
+
+  // Use the given memory for level 0, when nothing is placed in level 1.
+  // It must be aligned
+  KOKKOS_INLINE_FUNCTION
   void set_scratch_memory (Real* const scratch)
   {
-    m_team_scratch   = scratch;
-    // The threads offset is the sum of all the sizes of the team blocks
-    m_thread_scratch = scratch + sum_team_sizes;
+    assert (reinterpret_cast<uintptr_t>(scratch)%alignment==0);
+
+    m_level_memory[0] = scratch;
+    m_level_memory[1] = nullptr;
+  }
+
+  // Take the memory of both levels out of the scratch space of the team
+  template<typename TeamMember>
+  KOKKOS_INLINE_FUNCTION
+  void set_scratch_memory (const TeamMember& team)
+  {
+    for (int level=0; level<2; ++level)
+    {
+      const int bytes = memory_needed(level,team.team_size());
+      m_level_memory[level] = bytes>0 ? align(team.team_scratch(level).get_shmem(bytes)) : nullptr;
+    }
   }
 
 private:
 
-  // The memory buffer
-  Real* m_team_scratch;
-  Real* m_thread_scratch;
+  // The first aligned address in some scratch memory
+  KOKKOS_INLINE_FUNCTION
+  static Real* align (void* const memory)
+  {
+    const uintptr_t address = reinterpret_cast<uintptr_t>(memory);
+    return reinterpret_cast<Real*>((address + alignment - 1) / alignment * alignment);
+  }
+
+  // The base of each block in its level, and the size of each level
+  template<typename SizesPack>
+  KOKKOS_INLINE_FUNCTION
+  static void place_blocks (const int* placement, int* levels, size_t* bases, size_t* level_sizes)
+  {
+    size_t begins[max_scratch_blocks];
+    size_t ends[max_scratch_blocks];
+    Impl::BlockRanges<SizesPack>::fill(begins,ends);
+
+    for (int level=0; level<2; ++level)
+    {
+      size_t level_begin = static_cast<size_t>(-1);
+      size_t level_end   = 0;
+      for (int block=0; block<SizesPack::num_blocks; ++block)
+      {
+        if (placement[block]==level)
+        {
+          level_begin = begins[block]<level_begin ? begins[block] : level_begin;
+          level_end   = ends[block]>level_end ? ends[block] : level_end;
+        }
+      }
+      level_sizes[level] = level_end>0 ? level_end-level_begin : 0;
+      for (int block=0; block<SizesPack::num_blocks; ++block)
+      {
+        if (placement[block]==level)
+        {
+          levels[block] = level;
+          bases[block]  = begins[block]-level_begin;
+        }
+      }
+    }
+  }
+
+  // The memory of each level
+  Real* m_level_memory[2];
+
+  int    m_team_levels[max_scratch_blocks];
+  size_t m_team_bases[max_scratch_blocks];
+  size_t m_team_sizes[2];
+
+  int    m_thread_levels[max_scratch_blocks];
+  size_t m_thread_bases[max_scratch_blocks];
+  size_t m_thread_sizes[2];
 };
 
 } // namespace TinMan
@@ -16,6 +16,23 @@ constexpr int ID_3D_P_SCALAR = 2;
 constexpr int ID_2D_SCALAR = 0;
 constexpr int ID_2D_VECTOR = 1;
 
+// The team 3d scalars of compute_and_apply_rhs
+constexpr int DIV_VDP    = 0;
+constexpr int PRESSURE   = 1;
+constexpr int VORT       = 2;
+constexpr int VGRAD_P    = 3;
+constexpr int KAPPA_STAR = 4;
+constexpr int T_V        = 5;
+constexpr int OMEGA_P    = 6;
+constexpr int T_VADV     = 7;
+
+// The team 3d vectors of compute_and_apply_rhs
+constexpr int GRAD_P = 0;
+constexpr int V_VADV = 1;
+
+// The team 3d interface scalar of compute_and_apply_rhs
+constexpr int ETA_DOT_DPDN = 0;
+
 namespace ScratchMemoryDefs
 {
 
@@ -32,24 +49,94 @@ constexpr size_t num_3d_scalars   = 8;
 constexpr size_t num_3d_vectors   = 2;
 constexpr size_t num_3d_p_scalars = 1;
 
-constexpr int team_mem_needed = ( num_3d_scalars   * size_3d_scalar
-                                + num_3d_vectors   * size_3d_vector
-                                + num_3d_p_scalars * size_3d_p_scalar) * sizeof(Real);
-
 constexpr int thread_mem_needed = ( num_2d_scalars   * size_2d_scalar
                                   + num_2d_vectors   * size_2d_vector ) * sizeof(Real);
 
-typedef CountAndSizePack<num_3d_scalars  , size_3d_scalar,
-                         num_3d_vectors  , size_3d_vector,
-                         num_3d_p_scalars, size_3d_p_scalar
-                      > TeamPack;
+typedef CountAndTypePack<CountAndType<num_3d_scalars  , Real[NUM_LEV][NP][NP]>,
+                         CountAndType<num_3d_vectors  , Real[NUM_LEV][2][NP][NP]>,
+                         CountAndType<num_3d_p_scalars, Real[NUM_LEV_P][NP][NP]>
+                        > TeamBlocks;
+
+// The vertical advection terms, which are off in this test: eta_dot_dpdn is
+// only read, and T_vadv is read before it is reused as ttens
+typedef ScratchZeroed<ScratchBuffer<ID_3D_SCALAR,T_VADV>,
+                      ScratchBuffer<ID_3D_P_SCALAR,ETA_DOT_DPDN>
+                     > ZeroedBuffers;
+
+// The phases of compute_and_apply_rhs, between its team barriers, and the
+// team views each one uses
+typedef ScratchPhase<ScratchBuffer<ID_3D_SCALAR,PRESSURE>
+                    > PressurePhase;
+
+typedef ScratchPhase<ScratchBuffer<ID_3D_SCALAR,PRESSURE>,
+                     ScratchBuffer<ID_3D_VECTOR,GRAD_P>,
+                     ScratchBuffer<ID_3D_SCALAR,VGRAD_P>,
+                     ScratchBuffer<ID_3D_SCALAR,DIV_VDP>,
+                     ScratchBuffer<ID_3D_SCALAR,VORT>
+                    > LevelOperatorsPhase;
+
+typedef ScratchPhase<ScratchBuffer<ID_3D_SCALAR,T_V>,
+                     ScratchBuffer<ID_3D_SCALAR,KAPPA_STAR>
+                    > VirtualTemperaturePhase;
 
-typedef CountAndSizePack<num_2d_scalars, size_2d_scalar,
-                         num_2d_vectors, size_2d_vector
+// preq_omega_ps and the accumulation of eta_dot_dpdn and omega_p are not
+// separated by a barrier
+typedef ScratchPhase<ScratchBuffer<ID_3D_SCALAR,T_V>,
+                     ScratchBuffer<ID_3D_SCALAR,PRESSURE>,
+                     ScratchBuffer<ID_3D_SCALAR,VGRAD_P>,
+                     ScratchBuffer<ID_3D_SCALAR,DIV_VDP>,
+                     ScratchBuffer<ID_3D_SCALAR,OMEGA_P>,
+                     ScratchBuffer<ID_3D_P_SCALAR,ETA_DOT_DPDN>
+                    > ColumnScansPhase;
+
+typedef ScratchPhase<ScratchBuffer<ID_3D_SCALAR,T_VADV>,
+                     ScratchBuffer<ID_3D_VECTOR,V_VADV>
+                    > VerticalAdvectionPhase;
+
+typedef ScratchPhase<ScratchBuffer<ID_3D_SCALAR,T_V>,
+                     ScratchBuffer<ID_3D_SCALAR,PRESSURE>,
+                     ScratchBuffer<ID_3D_VECTOR,GRAD_P>,
+                     ScratchBuffer<ID_3D_SCALAR,VORT>,
+                     ScratchBuffer<ID_3D_SCALAR,KAPPA_STAR>,
+                     ScratchBuffer<ID_3D_SCALAR,OMEGA_P>,
+                     ScratchBuffer<ID_3D_SCALAR,T_VADV>,
+                     ScratchBuffer<ID_3D_VECTOR,V_VADV>
+                    > TendenciesPhase;
+
+typedef ScratchPhase<ScratchBuffer<ID_3D_SCALAR,T_VADV>,
+                     ScratchBuffer<ID_3D_VECTOR,V_VADV>,
+                     ScratchBuffer<ID_3D_SCALAR,DIV_VDP>
+                    > UpdatePhase;
+
+typedef ScratchLayout<TeamBlocks,
+                      ZeroedBuffers,
+                      PressurePhase,
+                      LevelOperatorsPhase,
+                      VirtualTemperaturePhase,
+                      ColumnScansPhase,
+                      VerticalAdvectionPhase,
+                      TendenciesPhase,
+                      UpdatePhase
+                     > TeamPack;
+
+constexpr int team_mem_needed = TeamPack::total_size * sizeof(Real);
+
+typedef CountAndTypePack<CountAndType<num_2d_scalars, Real[NP][NP]>,
+                         CountAndType<num_2d_vectors, Real[2][NP][NP]>
                         > ThreadPack;
 
 using CAARS_ScratchManager = ScratchManager<TeamPack, ThreadPack>;
 
+// Keep the small and hot 2d thread views and the 3d scalars in level 0, and
+// spill the 3d vectors and the interface scalar to level 1
+inline ScratchPlacement default_placement ()
+{
+  ScratchPlacement placement;
+  placement.team_levels[ID_3D_VECTOR]   = 1;
+  placement.team_levels[ID_3D_P_SCALAR] = 1;
+  return placement;
+}
+
 } // namespace ScratchMemoryDefs
 
 } // namespace TinMan
@@ -44,26 +44,26 @@ void preq_omega_ps(const ExecViewUnmanaged<Real[NUM_LEV][NP][NP]> p,
                    ExecViewUnmanaged<Real[NUM_LEV][NP][NP]> omega_p);
 
 
-void compute_and_apply_rhs (const Control& data, Region& region)
+void compute_and_apply_rhs (const Control& data, Region& region,
+                            const ScratchPlacement& placement)
 {
   using Kokkos::subview;
   using Kokkos::ALL;
 
   Kokkos::TeamPolicy<> policy(data.host_num_elems(), Kokkos::AUTO);
 
-  const int mem_needed = ScratchMemoryDefs::CAARS_ScratchManager::memory_needed(policy.team_size());
+  // Where each block of scratch goes, copied into each team
+  const ScratchMemoryDefs::CAARS_ScratchManager scratch_layout(placement);
 
-  policy = policy.set_scratch_size(0, Kokkos::PerTeam(mem_needed));
+  policy = policy.set_scratch_size(0, Kokkos::PerTeam(scratch_layout.memory_needed(0,policy.team_size())));
+  policy = policy.set_scratch_size(1, Kokkos::PerTeam(scratch_layout.memory_needed(1,policy.team_size())));
 
   Kokkos::parallel_for(policy,
                        KOKKOS_LAMBDA(const Kokkos::TeamPolicy<>::member_type &team) {
 
     // The manager for scratch memory
-    ScratchMemoryDefs::CAARS_ScratchManager scratch_manager;
-
-    // We only need to get a pointer out of the scratch space, doesn't really matter
-    // how much we ask for, as long as it fits. 1 byte should do
-    scratch_manager.set_scratch_memory(reinterpret_cast<Real*>(team.team_scratch(0).get_shmem(1)));
+    ScratchMemoryDefs::CAARS_ScratchManager scratch_manager(scratch_layout);
+    scratch_manager.set_scratch_memory(team);
 
     const int ie = team.league_rank();
     const int team_rank = team.team_rank(); // This is the thread id
@@ -76,14 +76,28 @@ void compute_and_apply_rhs (const Control& data, Region& region)
     const Real dt2 = data.dt2();
 
     // 3d scalars:
-    ExecViewUnmanaged<Real[NUM_LEV][NP][NP]> div_vdp    (scratch_manager.get_team_scratch<ID_3D_SCALAR,0>()); //
-    ExecViewUnmanaged<Real[NUM_LEV][NP][NP]> pressure   (scratch_manager.get_team_scratch<ID_3D_SCALAR,1>()); //
-    ExecViewUnmanaged<Real[NUM_LEV][NP][NP]> vort       (scratch_manager.get_team_scratch<ID_3D_SCALAR,2>());
+    ExecViewUnmanaged<Real[NUM_LEV][NP][NP]> div_vdp     = scratch_manager.get_team_view<ID_3D_SCALAR,DIV_VDP>(); //
+    ExecViewUnmanaged<Real[NUM_LEV][NP][NP]> pressure    = scratch_manager.get_team_view<ID_3D_SCALAR,PRESSURE>(); //
+    ExecViewUnmanaged<Real[NUM_LEV][NP][NP]> vort        = scratch_manager.get_team_view<ID_3D_SCALAR,VORT>();
 
     // 3d vectors:
-    ExecViewUnmanaged<Real[NUM_LEV][2][NP][NP]> grad_p(scratch_manager.get_team_scratch<ID_3D_VECTOR,0>());
+    ExecViewUnmanaged<Real[NUM_LEV][2][NP][NP]> grad_p = scratch_manager.get_team_view<ID_3D_VECTOR,GRAD_P>();
+
+    // The zeroed buffers (see ScratchMemoryDefs.hpp)
+    ExecViewUnmanaged<Real[NUM_LEV][NP][NP]>   T_vadv          = scratch_manager.get_team_view<ID_3D_SCALAR,T_VADV>();
+    ExecViewUnmanaged<Real[NUM_LEV_P][NP][NP]> eta_dot_dpdn_ie = scratch_manager.get_team_view<ID_3D_P_SCALAR,ETA_DOT_DPDN>();
 
     if(ie < data.num_elems()) {
+      Kokkos::parallel_for(Kokkos::TeamThreadRange(team, NUM_LEV_P), [&](const int ilev) {
+        Kokkos::parallel_for(Kokkos::ThreadVectorRange(team, NP * NP), [&](const int idx) {
+          const int igp = idx / NP;
+          const int jgp = idx % NP;
+          eta_dot_dpdn_ie(ilev,igp,jgp) = 0.0;
+          if (ilev<NUM_LEV)
+            T_vadv(ilev,igp,jgp) = 0.0;
+        });
+      });
+
       Kokkos::parallel_for(Kokkos::ThreadVectorRange(team, NP * NP), [&](const int idx) {
         const int igp = idx / NP;
         const int jgp = idx % NP;
@@ -102,8 +116,8 @@ void compute_and_apply_rhs (const Control& data, Region& region)
 
       team.team_barrier();
 
-      ExecViewUnmanaged<Real[2][NP][NP]> vdp_ilev(scratch_manager.get_thread_scratch<ID_2D_VECTOR,0>(team_rank));
-      ExecViewUnmanaged<Real[NUM_LEV][NP][NP]> vgrad_p    (scratch_manager.get_team_scratch<ID_3D_SCALAR,3>());
+      ExecViewUnmanaged<Real[2][NP][NP]> vdp_ilev = scratch_manager.get_thread_view<ID_2D_VECTOR,0>(team_rank);
+      ExecViewUnmanaged<Real[NUM_LEV][NP][NP]> vgrad_p     = scratch_manager.get_team_view<ID_3D_SCALAR,VGRAD_P>();
 
       Kokkos::parallel_for(Kokkos::TeamThreadRange(team, NUM_LEV), [&](const int ilev) {
 
@@ -136,8 +150,8 @@ void compute_and_apply_rhs (const Control& data, Region& region)
 
         vorticity_sphere(team, U_ilev, V_ilev, data, region.METDET(ie), region.D(ie), vort_ilev);
       });
-      ExecViewUnmanaged<Real[NUM_LEV][NP][NP]> kappa_star (scratch_manager.get_team_scratch<ID_3D_SCALAR,4>()); //
-      ExecViewUnmanaged<Real[NUM_LEV][NP][NP]> T_v        (scratch_manager.get_team_scratch<ID_3D_SCALAR,5>());
+      ExecViewUnmanaged<Real[NUM_LEV][NP][NP]> kappa_star  = scratch_manager.get_team_view<ID_3D_SCALAR,KAPPA_STAR>(); //
+      ExecViewUnmanaged<Real[NUM_LEV][NP][NP]> T_v         = scratch_manager.get_team_view<ID_3D_SCALAR,T_V>();
       if (qn0==-1)
       {
         Kokkos::parallel_for(Kokkos::TeamThreadRange(team, NUM_LEV), [&](const int ilev) {
@@ -167,12 +181,11 @@ void compute_and_apply_rhs (const Control& data, Region& region)
 
       ExecViewUnmanaged<Real[NP][NP]>          phis_ie = region.PHIS(ie);
       ExecViewUnmanaged<Real[NUM_LEV][NP][NP]> phi_ie  = region.PHI(ie);
-      ExecViewUnmanaged<Real[NUM_LEV][NP][NP]> omega_p (scratch_manager.get_team_scratch<ID_3D_SCALAR,6>());
+      ExecViewUnmanaged<Real[NUM_LEV][NP][NP]> omega_p  = scratch_manager.get_team_view<ID_3D_SCALAR,OMEGA_P>();
 
       preq_hydrostatic(team, phis_ie, T_v, pressure, region.DP3D(ie, n0), PhysicalConstants::Rgas, phi_ie);
       preq_omega_ps(pressure, vgrad_p, div_vdp, omega_p);
 
-      ExecViewUnmanaged<Real[NUM_LEV_P][NP][NP]>  eta_dot_dpdn_ie(scratch_manager.get_team_scratch<ID_3D_P_SCALAR,0>());
       Kokkos::parallel_for(Kokkos::TeamThreadRange(team, NUM_LEV_P), [&](const int ilev) {
         Kokkos::parallel_for(Kokkos::ThreadVectorRange(team, NP * NP), [&](const int idx) {
           const int igp = idx / NP;
@@ -188,21 +201,18 @@ void compute_and_apply_rhs (const Control& data, Region& region)
 
       // Note: the only purpose of T_vadv is to be stuffed (with other terms) into ttens. By making ttens share
       //       the same ptr of T_vadv, we save memory and flops. The same holds for vtens and v_vadv
-      ExecViewUnmanaged<Real[NUM_LEV][NP][NP]>    T_vadv (scratch_manager.get_team_scratch<ID_3D_SCALAR,7>());
-      ExecViewUnmanaged<Real[NUM_LEV][2][NP][NP]> v_vadv (scratch_manager.get_team_scratch<ID_3D_VECTOR,1>());
+      ExecViewUnmanaged<Real[NUM_LEV][2][NP][NP]> v_vadv  = scratch_manager.get_team_view<ID_3D_VECTOR,V_VADV>();
       ExecViewUnmanaged<Real[NUM_LEV][NP][NP]>    ttens  (T_vadv.data());//scratch_manager.get_team_scratch<ID_3D_SCALAR_8>());
       ExecViewUnmanaged<Real[NUM_LEV][2][NP][NP]> vtens  (v_vadv.data());//scratch_manager.get_team_scratch<ID_3D_SCALAR_8>());
 
-      ExecViewUnmanaged<Real[NP][NP]> Ephi              (scratch_manager.get_thread_scratch<ID_2D_SCALAR,0>(team_rank));
-      ExecViewUnmanaged<Real[NP][NP]> vgrad_T           (scratch_manager.get_thread_scratch<ID_2D_SCALAR,1>(team_rank));
-      ExecViewUnmanaged<Real[2][NP][NP]> grad_tmp       (scratch_manager.get_thread_scratch<ID_2D_VECTOR,0>(team_rank));
+      ExecViewUnmanaged<Real[NP][NP]> Ephi               = scratch_manager.get_thread_view<ID_2D_SCALAR,0>(team_rank);
+      ExecViewUnmanaged<Real[NP][NP]> vgrad_T            = scratch_manager.get_thread_view<ID_2D_SCALAR,1>(team_rank);
+      ExecViewUnmanaged<Real[2][NP][NP]> grad_tmp        = scratch_manager.get_thread_view<ID_2D_VECTOR,0>(team_rank);
 
       Kokkos::parallel_for(Kokkos::TeamThreadRange(team, NUM_LEV), [&](const int ilev) {
         Kokkos::parallel_for(Kokkos::ThreadVectorRange(team, NP * NP), [&](const int idx) {
           const int igp = idx / NP;
           const int jgp = idx % NP;
-          // T_vadv initialized
-          T_vadv(ilev, igp, jgp) = 0.0;
           // v_vadv initialized
           v_vadv(ilev, 0, igp, jgp) = v_vadv(ilev, 1, igp, jgp) = 0.0;
         });
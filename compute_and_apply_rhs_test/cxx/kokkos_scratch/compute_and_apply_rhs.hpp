@@ -4,6 +4,7 @@
 #include "config.h"
 
 #include "Types.hpp"
+#include "ScratchManager.hpp"
 
 namespace TinMan
 {
@@ -12,7 +13,8 @@ namespace TinMan
 class Control;
 class Region;
 
-void compute_and_apply_rhs (const Control& data, Region& region);
+void compute_and_apply_rhs (const Control& data, Region& region,
+                            const ScratchPlacement& placement);
 
 void print_results_2norm (const Control& data, const Region& region);
 
@@ -1,12 +1,15 @@
 #include "compute_and_apply_rhs.hpp"
 #include "Region.hpp"
 #include "TestData.hpp"
+#include "ScratchMemoryDefs.hpp"
 #include "timer.hpp"
 #include "Kokkos_Core.hpp"
 
 #include <iostream>
 #include <cstring>
+#include <iomanip>
 #include <memory>
+#include <string>
 
 bool is_unsigned_int(const char* str)
 {
@@ -19,7 +22,45 @@ bool is_unsigned_int(const char* str)
   return true;
 }
 
-void parse_args(int argc, char** argv, int &num_elems, int &num_exec, bool &dump_results) {
+using CAARS_ScratchManager = TinMan::ScratchMemoryDefs::CAARS_ScratchManager;
+
+constexpr int num_scratch_blocks = CAARS_ScratchManager::num_team_blocks + CAARS_ScratchManager::num_thread_blocks;
+
+// A placement is written as one level per block, the team blocks first and
+// then the thread blocks, e.g. 01100
+bool parse_placement(const char* str, TinMan::ScratchPlacement& placement)
+{
+  if (strlen(str) != num_scratch_blocks) {
+    return false;
+  }
+  for (int block = 0; block < num_scratch_blocks; ++block) {
+    if (str[block] != '0' && str[block] != '1') {
+      return false;
+    }
+    const int level = str[block] - '0';
+    if (block < CAARS_ScratchManager::num_team_blocks) {
+      placement.team_levels[block] = level;
+    } else {
+      placement.thread_levels[block - CAARS_ScratchManager::num_team_blocks] = level;
+    }
+  }
+  return true;
+}
+
+std::string placement_string(const TinMan::ScratchPlacement& placement)
+{
+  std::string str;
+  for (int block = 0; block < CAARS_ScratchManager::num_team_blocks; ++block) {
+    str += static_cast<char>('0' + placement.team_levels[block]);
+  }
+  for (int block = 0; block < CAARS_ScratchManager::num_thread_blocks; ++block) {
+    str += static_cast<char>('0' + placement.thread_levels[block]);
+  }
+  return str;
+}
+
+void parse_args(int argc, char** argv, int &num_elems, int &num_exec, bool &dump_results,
+                TinMan::ScratchPlacement &placement, bool &sweep_placements) {
   if (argc > 1) {
     int iarg = 1;
     while (iarg<argc)
@@ -64,6 +105,25 @@ void parse_args(int argc, char** argv, int &num_elems, int &num_exec, bool &dump
         ++iarg;
         continue;
       }
+      else if (strncmp(argv[iarg],"--tinman-scratch-placement=",27) == 0)
+      {
+        char* val = strchr(argv[iarg],'=')+1;
+        if (!parse_placement(val, placement))
+        {
+          std::cerr << "Expecting " << num_scratch_blocks << " levels, each 0 or 1, after '--tinman-scratch-placement='.\n";
+          std::exit(1);
+        }
+
+        ++iarg;
+        continue;
+      }
+      else if (strcmp(argv[iarg],"--tinman-scratch-sweep") == 0)
+      {
+        sweep_placements = true;
+
+        ++iarg;
+        continue;
+      }
       else if (strncmp(argv[iarg],"--tinman-help",13) == 0)
       {
         std::cout << "+------------------------------------------------------------------------+\n"
@@ -72,6 +132,9 @@ void parse_args(int argc, char** argv, int &num_elems, int &num_exec, bool &dump
                   << "|  --tinman-num-elems=N  : the number of elements (default=10)           |\n"
                   << "|  --tinman-dump-res=val : whether to dump results to file (default=no)  |\n"
                   << "|  --tinman-num-exec=N   : number of times to execute (default=1)        |\n"
+                  << "|  --tinman-scratch-placement=LLLLL : the scratch level, 0 or 1, of each |\n"
+                  << "|                          team block and then each thread block         |\n"
+                  << "|  --tinman-scratch-sweep : times every placement of the scratch blocks  |\n"
                   << "|  --tinman-help         : prints this message                           |\n"
                   << "|  --kokkos-help         : prints kokkos help                            |\n"
                   << "+------------------------------------------------------------------------+\n";
@@ -84,21 +147,74 @@ void parse_args(int argc, char** argv, int &num_elems, int &num_exec, bool &dump
   }
 }
 
-void run_simulation(int num_elems, int num_exec, bool dump_results) {
+void print_scratch_levels(const TinMan::ScratchPlacement& placement, const int team_size) {
+  const CAARS_ScratchManager scratch_layout(placement);
+  std::cout << "   ---> Scratch placement " << placement_string(placement) << ": "
+            << scratch_layout.memory_needed(0,team_size)/1024 << " KB in level 0, "
+            << scratch_layout.memory_needed(1,team_size)/1024 << " KB in level 1 per team\n";
+}
+
+// Time every placement of the scratch blocks, num_exec calls each
+void sweep_scratch_placements(int num_elems, int num_exec) {
+  const int team_size = Kokkos::TeamPolicy<>(num_elems, Kokkos::AUTO).team_size();
+
+  std::cout << "   placement   level 0 (KB)   level 1 (KB)   time per call (us)\n";
+  for (int mask = 0; mask < (1 << num_scratch_blocks); ++mask) {
+    TinMan::ScratchPlacement placement;
+    for (int block = 0; block < num_scratch_blocks; ++block) {
+      const int level = (mask >> (num_scratch_blocks - 1 - block)) & 1;
+      if (block < CAARS_ScratchManager::num_team_blocks) {
+        placement.team_levels[block] = level;
+      } else {
+        placement.thread_levels[block - CAARS_ScratchManager::num_team_blocks] = level;
+      }
+    }
+    const CAARS_ScratchManager scratch_layout(placement);
+
+    TinMan::Control data(num_elems);
+    TinMan::Region region(num_elems);
+
+    // Burn in, so that the first call does not pay for the allocations
+    TinMan::compute_and_apply_rhs(data, region, placement);
+
+    Timer::Timer timer;
+    timer.startTimer();
+    for (int i=0; i<num_exec; ++i) {
+      TinMan::compute_and_apply_rhs(data, region, placement);
+    }
+#ifdef KOKKOS_HAVE_DEFAULT_DEVICE_TYPE_OPENMP
+    Kokkos::OpenMP::fence();
+#endif
+    timer.stopTimer();
+
+    std::cout << "   " << placement_string(placement)
+              << "       " << std::setw(8) << scratch_layout.memory_needed(0,team_size)/1024
+              << "       " << std::setw(8) << scratch_layout.memory_needed(1,team_size)/1024
+              << "       " << std::setw(12) << timer.elapsed_us()/num_exec << "\n";
+  }
+}
+
+void run_simulation(int num_elems, int num_exec, bool dump_results,
+                    const TinMan::ScratchPlacement& placement) {
   TinMan::Control data(num_elems);
   TinMan::Region region(num_elems);
 
   // Print norm of initial states, to check we are using same data in all tests
   print_results_2norm(data, region);
 
+  using TeamPack = TinMan::ScratchMemoryDefs::TeamPack;
+  std::cout << "   ---> Team scratch: " << TeamPack::total_size*sizeof(TinMan::Real)/1024 << " KB ("
+            << TeamPack::unshared_size*sizeof(TinMan::Real)/1024 << " KB without sharing memory)\n";
+  print_scratch_levels(placement, Kokkos::TeamPolicy<>(num_elems, Kokkos::AUTO).team_size());
+
   // Burn in before timing to reduce cache effect
-  //TinMan::compute_and_apply_rhs(data, region);
+  //TinMan::compute_and_apply_rhs(data, region, placement);
 
   std::unique_ptr<Timer::Timer[]> timers(new Timer::Timer[num_exec]);
   for (int i=0; i<num_exec; ++i)
   {
     timers[i].startTimer();
-    TinMan::compute_and_apply_rhs(data, region);
+    TinMan::compute_and_apply_rhs(data, region, placement);
 //    data.update_time_levels();
     timers[i].stopTimer();
   }
@@ -124,7 +240,9 @@ int main (int argc, char** argv)
   int num_elems = 10;
   int num_exec = 1;
   bool dump_results = false;
-  parse_args(argc, argv, num_elems, num_exec, dump_results);
+  TinMan::ScratchPlacement placement = TinMan::ScratchMemoryDefs::default_placement();
+  bool sweep_placements = false;
+  parse_args(argc, argv, num_elems, num_exec, dump_results, placement, sweep_placements);
 
   if (num_elems < 1) {
     std::cerr << "Invalid number of elements: " << num_elems << std::endl;
@@ -137,7 +255,11 @@ int main (int argc, char** argv)
   Kokkos::OpenMP::print_configuration(std::cout,true);
 #endif
 
-  run_simulation(num_elems, num_exec, dump_results);
+  if (sweep_placements) {
+    sweep_scratch_placements(num_elems, num_exec);
+  } else {
+    run_simulation(num_elems, num_exec, dump_results, placement);
+  }
 
   Kokkos::finalize ();
   return 0;
@@ -113,7 +113,7 @@ void gradient_sphere (const Kokkos::TeamPolicy<>::member_type &team,
 {
   Real rrearth = PhysicalConstants::rrearth;
 
-  ScratchView<Real[2][NP][NP]> v(scratch_manager.get_thread_scratch<ID_2D_VECTOR,0>(team.team_rank()));
+  ScratchView<Real[2][NP][NP]> v = scratch_manager.get_thread_view<ID_2D_VECTOR,0,ScratchView>(team.team_rank());
   constexpr const int contra_iters = NP * NP;
   Kokkos::parallel_for(Kokkos::ThreadVectorRange(team, contra_iters),
                        [&](const int loop_idx) {
@@ -0,0 +1,38 @@
+#include "AttainableBandwidth.hpp"
+
+#include <fstream>
+#include <sstream>
+
+namespace Homme {
+
+bool AttainableBandwidth::read(const std::string &file_name) {
+  m_levels.clear();
+  std::ifstream in(file_name);
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::istringstream fields(line);
+    Level level;
+    if (fields >> level.name >> level.bytes >> level.gb_per_second) {
+      m_levels.push_back(level);
+    }
+  }
+  return !m_levels.empty();
+}
+
+double AttainableBandwidth::gb_per_second(const long working_set,
+                                          std::string &level) const {
+  // The levels are listed from the smallest
+  for (const Level &candidate : m_levels) {
+    if (candidate.bytes == 0 || working_set <= candidate.bytes) {
+      level = candidate.name;
+      return candidate.gb_per_second;
+    }
+  }
+  level.clear();
+  return 0.0;
+}
+
+} // namespace Homme
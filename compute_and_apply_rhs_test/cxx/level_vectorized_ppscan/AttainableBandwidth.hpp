@@ -0,0 +1,42 @@
+#ifndef HOMMEXX_ATTAINABLE_BANDWIDTH_HPP
+#define HOMMEXX_ATTAINABLE_BANDWIDTH_HPP
+
+#include <string>
+#include <vector>
+
+namespace Homme {
+
+/* The peak bandwidth of each level of the memory of the node, as measured by
+ * the STREAM kernels of saxpby_test (saxbpy_test_cxx --stream), which write
+ * them to bandwidth.dat.
+ *
+ * A CAAR step is only as good as the fraction of this bandwidth it reaches
+ * with its working set, which is what the driver reports.
+ */
+class AttainableBandwidth {
+public:
+  AttainableBandwidth() = default;
+
+  // Returns false, with no levels, if the file cannot be read
+  bool read(const std::string &file_name);
+
+  bool empty() const { return m_levels.empty(); }
+
+  // The peak bandwidth in GB/s of the smallest level holding working_set
+  // bytes, and its name. 0 if the file has no such level
+  double gb_per_second(const long working_set, std::string &level) const;
+
+private:
+  struct Level {
+    std::string name;
+    // The largest working set measured in the level, 0 if unbounded
+    long bytes;
+    double gb_per_second;
+  };
+
+  std::vector<Level> m_levels;
+};
+
+} // namespace Homme
+
+#endif // HOMMEXX_ATTAINABLE_BANDWIDTH_HPP
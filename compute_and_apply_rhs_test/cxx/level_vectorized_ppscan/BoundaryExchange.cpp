@@ -0,0 +1,370 @@
+#include "BoundaryExchange.hpp"
+
+#include "profiling.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace Homme {
+
+using clock_type = std::chrono::high_resolution_clock;
+
+namespace {
+double seconds_since(const clock_type::time_point &start) {
+  return std::chrono::duration_cast<std::chrono::duration<double> >(
+             clock_type::now() - start).count();
+}
+} // anonymous namespace
+
+BoundaryExchange::BoundaryExchange(const Connectivity &connectivity,
+                                   const Elements &elements)
+    : m_connectivity(connectivity), m_num_elems(connectivity.num_elems()),
+      m_tl(-1), m_posted(false), m_delivered(false), m_done(false),
+      m_num_exchanges(0), m_seconds_packing(0.0), m_seconds_unpacking(0.0),
+      m_seconds_waiting(0.0), m_seconds_in_transfers(0.0) {
+  m_fields[U] = elements.m_u;
+  m_fields[V] = elements.m_v;
+  m_fields[T] = elements.m_t;
+  m_fields[DP3D] = elements.m_dp3d;
+
+  m_edge_buffer = ExecViewManaged<
+      Scalar * [Connectivity::NUM_EDGES][NUM_FIELDS][NP][NUM_LEV]>(
+      "Packed edges", m_num_elems);
+  m_corner_buffer = ExecViewManaged<
+      Scalar * [Connectivity::NUM_CORNERS][NUM_FIELDS][NUM_LEV]>(
+      "Packed corners", m_num_elems);
+
+  init_messages();
+  init_rspheremp(elements);
+
+  m_transport = std::thread(&BoundaryExchange::transport_loop, this);
+}
+
+BoundaryExchange::~BoundaryExchange() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_done = true;
+  }
+  m_cv.notify_all();
+  m_transport.join();
+}
+
+void BoundaryExchange::init_messages() {
+  ExecViewManaged<int * [Connectivity::NUM_DIRECTIONS]>::HostMirror
+      h_neighbor_elem = Kokkos::create_mirror_view(m_connectivity.m_neighbor_elem);
+  ExecViewManaged<int *>::HostMirror h_rank =
+      Kokkos::create_mirror_view(m_connectivity.m_rank);
+  Kokkos::deep_copy(h_neighbor_elem, m_connectivity.m_neighbor_elem);
+  Kokkos::deep_copy(h_rank, m_connectivity.m_rank);
+
+  m_message_offset = ExecViewManaged<int * [Connectivity::NUM_DIRECTIONS]>(
+      "Offsets of the boundaries in the messages", m_num_elems);
+  ExecViewManaged<int * [Connectivity::NUM_DIRECTIONS]>::HostMirror
+      h_message_offset = Kokkos::create_mirror_view(m_message_offset);
+
+  // Group the remote boundaries by (source rank, destination rank), so that
+  // each message is contiguous
+  struct RemoteBoundary {
+    int src_rank, dst_rank, ie, dir;
+  };
+  std::vector<RemoteBoundary> remote;
+  std::vector<int> interior, boundary;
+  for (int ie = 0; ie < m_num_elems; ++ie) {
+    bool is_interior = true;
+    for (int dir = 0; dir < Connectivity::NUM_DIRECTIONS; ++dir) {
+      h_message_offset(ie, dir) = -1;
+      const int neighbor = h_neighbor_elem(ie, dir);
+      if (neighbor >= 0 && h_rank(neighbor) != h_rank(ie)) {
+        remote.push_back({ h_rank(ie), h_rank(neighbor), ie, dir });
+        is_interior = false;
+      }
+    }
+    (is_interior ? interior : boundary).push_back(ie);
+  }
+  std::stable_sort(remote.begin(), remote.end(),
+                   [](const RemoteBoundary &a, const RemoteBoundary &b) {
+    return a.src_rank < b.src_rank ||
+           (a.src_rank == b.src_rank && a.dst_rank < b.dst_rank);
+  });
+
+  int num_columns = 0;
+  for (const RemoteBoundary &rb : remote) {
+    if (m_messages.empty() || m_messages.back().src_rank != rb.src_rank ||
+        m_messages.back().dst_rank != rb.dst_rank) {
+      m_messages.push_back({ rb.src_rank, rb.dst_rank, num_columns,
+                             num_columns });
+    }
+    h_message_offset(rb.ie, rb.dir) = num_columns;
+    num_columns += (rb.dir < Connectivity::NUM_EDGES ? NP : 1);
+    m_messages.back().end = num_columns;
+  }
+  Kokkos::deep_copy(m_message_offset, h_message_offset);
+
+  m_send_messages = ExecViewManaged<Scalar * [NUM_FIELDS][NUM_LEV]>(
+      "Messages sent", num_columns);
+  m_recv_messages = ExecViewManaged<Scalar * [NUM_FIELDS][NUM_LEV]>(
+      "Messages received", num_columns);
+
+  m_interior = ExecViewManaged<int *>("Interior elements", interior.size());
+  m_boundary = ExecViewManaged<int *>("Boundary elements", boundary.size());
+  ExecViewManaged<int *>::HostMirror h_interior =
+      Kokkos::create_mirror_view(m_interior);
+  ExecViewManaged<int *>::HostMirror h_boundary =
+      Kokkos::create_mirror_view(m_boundary);
+  std::copy(interior.begin(), interior.end(), h_interior.data());
+  std::copy(boundary.begin(), boundary.end(), h_boundary.data());
+  Kokkos::deep_copy(m_interior, h_interior);
+  Kokkos::deep_copy(m_boundary, h_boundary);
+}
+
+void BoundaryExchange::init_rspheremp(const Elements &elements) {
+  ExecViewManaged<Real * [NP][NP]>::HostMirror h_spheremp =
+      Kokkos::create_mirror_view(elements.m_spheremp);
+  Kokkos::deep_copy(h_spheremp, elements.m_spheremp);
+  ExecViewManaged<int * [Connectivity::NUM_DIRECTIONS]>::HostMirror
+      h_neighbor_elem = Kokkos::create_mirror_view(m_connectivity.m_neighbor_elem);
+  ExecViewManaged<int * [Connectivity::NUM_DIRECTIONS]>::HostMirror
+      h_neighbor_dir = Kokkos::create_mirror_view(m_connectivity.m_neighbor_dir);
+  ExecViewManaged<int * [Connectivity::NUM_DIRECTIONS]>::HostMirror
+      h_reversed = Kokkos::create_mirror_view(m_connectivity.m_reversed);
+  Kokkos::deep_copy(h_neighbor_elem, m_connectivity.m_neighbor_elem);
+  Kokkos::deep_copy(h_neighbor_dir, m_connectivity.m_neighbor_dir);
+  Kokkos::deep_copy(h_reversed, m_connectivity.m_reversed);
+
+  m_rspheremp = ExecViewManaged<Real * [NP][NP]>(
+      "Inverse of the assembled spheremp", m_num_elems);
+  ExecViewManaged<Real * [NP][NP]>::HostMirror h_rspheremp =
+      Kokkos::create_mirror_view(m_rspheremp);
+
+  // Same summation as in unpack, on the host
+  for (int ie = 0; ie < m_num_elems; ++ie) {
+    for (int igp = 0; igp < NP; ++igp) {
+      for (int jgp = 0; jgp < NP; ++jgp) {
+        h_rspheremp(ie, igp, jgp) = h_spheremp(ie, igp, jgp);
+      }
+    }
+    for (int dir = 0; dir < Connectivity::NUM_DIRECTIONS; ++dir) {
+      const int neighbor = h_neighbor_elem(ie, dir);
+      if (neighbor < 0) {
+        continue;
+      }
+      const int neighbor_dir = h_neighbor_dir(ie, dir);
+      if (dir < Connectivity::NUM_EDGES) {
+        for (int ipoint = 0; ipoint < NP; ++ipoint) {
+          const int jpoint = (h_reversed(ie, dir) ? NP - 1 - ipoint : ipoint);
+          int igp, jgp, n_igp, n_jgp;
+          edge_point(dir, ipoint, igp, jgp);
+          edge_point(neighbor_dir, jpoint, n_igp, n_jgp);
+          h_rspheremp(ie, igp, jgp) += h_spheremp(neighbor, n_igp, n_jgp);
+        }
+      } else {
+        int igp, jgp, n_igp, n_jgp;
+        corner_point(dir, igp, jgp);
+        corner_point(neighbor_dir, n_igp, n_jgp);
+        h_rspheremp(ie, igp, jgp) += h_spheremp(neighbor, n_igp, n_jgp);
+      }
+    }
+    for (int igp = 0; igp < NP; ++igp) {
+      for (int jgp = 0; jgp < NP; ++jgp) {
+        h_rspheremp(ie, igp, jgp) = 1.0 / h_rspheremp(ie, igp, jgp);
+      }
+    }
+  }
+  Kokkos::deep_copy(m_rspheremp, h_rspheremp);
+}
+
+void BoundaryExchange::start(const int tl) {
+  start_timer("dss pack");
+  const auto start = clock_type::now();
+  m_tl = tl;
+
+  // Local copies, so that the lambda does not capture this
+  const auto fields = m_fields;
+  const auto edge_buffer = m_edge_buffer;
+  const auto corner_buffer = m_corner_buffer;
+  const auto message_offset = m_message_offset;
+  const auto send_messages = m_send_messages;
+
+  Kokkos::parallel_for(
+      Kokkos::RangePolicy<ExecSpace>(0, m_num_elems * NUM_FIELDS *
+                                            NUM_BOUNDARY_POINTS),
+      KOKKOS_LAMBDA(const int idx) {
+        const int ie = idx / (NUM_FIELDS * NUM_BOUNDARY_POINTS);
+        const int ifield = (idx / NUM_BOUNDARY_POINTS) % NUM_FIELDS;
+        const int ipoint = idx % NUM_BOUNDARY_POINTS;
+
+        int dir, igp, jgp, icolumn;
+        if (ipoint < NUM_EDGE_POINTS) {
+          dir = ipoint / NP;
+          icolumn = ipoint % NP;
+          edge_point(dir, icolumn, igp, jgp);
+        } else {
+          dir = Connectivity::NUM_EDGES + ipoint - NUM_EDGE_POINTS;
+          icolumn = 0;
+          corner_point(dir, igp, jgp);
+        }
+
+        const int offset = message_offset(ie, dir);
+        for (int ilev = 0; ilev < NUM_LEV; ++ilev) {
+          const Scalar &value = fields[ifield](ie, tl, igp, jgp, ilev);
+          if (offset >= 0) {
+            send_messages(offset + icolumn, ifield, ilev) = value;
+          } else if (dir < Connectivity::NUM_EDGES) {
+            edge_buffer(ie, dir, ifield, icolumn, ilev) = value;
+          } else {
+            corner_buffer(ie, dir - Connectivity::NUM_EDGES, ifield, ilev) =
+                value;
+          }
+        }
+      });
+  ExecSpace::fence();
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_posted = true;
+    m_delivered = false;
+  }
+  m_cv.notify_all();
+
+  ++m_num_exchanges;
+  m_seconds_packing += seconds_since(start);
+  stop_timer("dss pack");
+}
+
+void BoundaryExchange::unpack_interior() { unpack(m_interior); }
+
+void BoundaryExchange::finish() {
+  start_timer("dss wait");
+  const auto start = clock_type::now();
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [&]() { return m_delivered; });
+    m_delivered = false;
+  }
+  m_seconds_waiting += seconds_since(start);
+  stop_timer("dss wait");
+
+  unpack(m_boundary);
+}
+
+void BoundaryExchange::exchange(const int tl) {
+  start(tl);
+  unpack_interior();
+  finish();
+}
+
+void BoundaryExchange::unpack(const ExecViewManaged<int *> &elems) {
+  start_timer("dss unpack");
+  const auto start = clock_type::now();
+
+  const int tl = m_tl;
+  const auto fields = m_fields;
+  const auto rspheremp = m_rspheremp;
+  const auto edge_buffer = m_edge_buffer;
+  const auto corner_buffer = m_corner_buffer;
+  const auto message_offset = m_message_offset;
+  const auto recv_messages = m_recv_messages;
+  const auto neighbor_elem = m_connectivity.m_neighbor_elem;
+  const auto neighbor_dir = m_connectivity.m_neighbor_dir;
+  const auto reversed = m_connectivity.m_reversed;
+
+  // Each index is a GLL point of a field of an element, which gathers the
+  // values of all its neighbours, so there are no races
+  Kokkos::parallel_for(
+      Kokkos::RangePolicy<ExecSpace>(0, elems.extent_int(0) * NUM_FIELDS * NP *
+                                            NP),
+      KOKKOS_LAMBDA(const int idx) {
+        const int ie = elems(idx / (NUM_FIELDS * NP * NP));
+        const int ifield = (idx / (NP * NP)) % NUM_FIELDS;
+        const int igp = (idx / NP) % NP;
+        const int jgp = idx % NP;
+
+        // The directions sharing this point, and its position along the edges
+        int dirs[3];
+        int positions[3];
+        int num_dirs = 0;
+        if (igp == 0 || igp == NP - 1) {
+          dirs[num_dirs] = (igp == 0 ? Connectivity::WEST : Connectivity::EAST);
+          positions[num_dirs++] = jgp;
+        }
+        if (jgp == 0 || jgp == NP - 1) {
+          dirs[num_dirs] =
+              (jgp == 0 ? Connectivity::SOUTH : Connectivity::NORTH);
+          positions[num_dirs++] = igp;
+        }
+        if (num_dirs == 2) {
+          dirs[num_dirs] =
+              (jgp == 0 ? (igp == 0 ? Connectivity::SWEST : Connectivity::SEAST)
+                        : (igp == 0 ? Connectivity::NWEST
+                                    : Connectivity::NEAST));
+          positions[num_dirs++] = 0;
+        }
+
+        for (int ilev = 0; ilev < NUM_LEV; ++ilev) {
+          Scalar sum = fields[ifield](ie, tl, igp, jgp, ilev);
+          for (int idir = 0; idir < num_dirs; ++idir) {
+            const int dir = dirs[idir];
+            const int neighbor = neighbor_elem(ie, dir);
+            if (neighbor < 0) {
+              continue;
+            }
+            const int ndir = neighbor_dir(ie, dir);
+            const int icolumn =
+                (dir < Connectivity::NUM_EDGES && reversed(ie, dir)
+                     ? NP - 1 - positions[idir]
+                     : positions[idir]);
+            const int offset = message_offset(neighbor, ndir);
+            if (offset >= 0) {
+              sum += recv_messages(offset + icolumn, ifield, ilev);
+            } else if (ndir < Connectivity::NUM_EDGES) {
+              sum += edge_buffer(neighbor, ndir, ifield, icolumn, ilev);
+            } else {
+              sum += corner_buffer(neighbor, ndir - Connectivity::NUM_EDGES,
+                                   ifield, ilev);
+            }
+          }
+          fields[ifield](ie, tl, igp, jgp, ilev) =
+              rspheremp(ie, igp, jgp) * sum;
+        }
+      });
+  ExecSpace::fence();
+
+  m_seconds_unpacking += seconds_since(start);
+  stop_timer("dss unpack");
+}
+
+void BoundaryExchange::transport_loop() {
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_cv.wait(lock, [&]() { return m_posted || m_done; });
+      if (!m_posted) {
+        return;
+      }
+      m_posted = false;
+    }
+
+    // Each message is one transfer, as it would be with MPI. Scalar only
+    // holds its lanes, so the messages are copied as raw memory
+    const auto start = clock_type::now();
+    for (const Message &message : m_messages) {
+      const size_t bytes = static_cast<size_t>(message.end - message.begin) *
+                           NUM_FIELDS * NUM_LEV * sizeof(Scalar);
+      std::memcpy(static_cast<void *>(&m_recv_messages(message.begin, 0, 0)),
+                  static_cast<const void *>(
+                      &m_send_messages(message.begin, 0, 0)),
+                  bytes);
+    }
+    const double seconds = seconds_since(start);
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_seconds_in_transfers += seconds;
+      m_delivered = true;
+    }
+    m_cv.notify_all();
+  }
+}
+
+} // namespace Homme
@@ -0,0 +1,165 @@
+#ifndef HOMMEXX_BOUNDARY_EXCHANGE_HPP
+#define HOMMEXX_BOUNDARY_EXCHANGE_HPP
+
+#include "Types.hpp"
+#include "Connectivity.hpp"
+#include "Elements.hpp"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Homme {
+
+/* Direct stiffness summation (DSS) of the prognostic fields at the end of a
+ * CAAR stage.
+ *
+ * Each element packs the GLL points on its edges and corners into the edge
+ * and corner buffers. Then each element adds the packed values of its
+ * neighbours to its shared points, and multiplies by the inverse of the
+ * assembled mass matrix. The fields coming out of the CaarFunctor are
+ * already multiplied by spheremp, so the result is the DSS of the fields.
+ *
+ * The ranks of the Connectivity are emulated as a stand-in for MPI. The
+ * boundaries of the elements with a neighbour on another rank are packed
+ * into one contiguous message per pair of ranks. A transport thread copies
+ * the messages to the receive buffer while the caller goes on, e.g. with
+ * unpack_interior() and the next stage on the interior elements. The
+ * messages are copied with memcpy, which requires ExecMemSpace to be host
+ * accessible.
+ */
+class BoundaryExchange {
+public:
+  // The fields exchanged, all taken at the time level passed to start()
+  enum Field { U = 0, V, T, DP3D, NUM_FIELDS };
+
+  BoundaryExchange(const Connectivity &connectivity, const Elements &elements);
+
+  // Joins the transport thread. Must not be called with an exchange pending
+  ~BoundaryExchange();
+
+  BoundaryExchange(const BoundaryExchange &) = delete;
+  BoundaryExchange &operator=(const BoundaryExchange &) = delete;
+
+  // Packs the boundaries of the fields at time level tl, and hands the
+  // messages between ranks over to the transport thread
+  void start(const int tl);
+  // Completes the DSS of the interior elements, which need no message.
+  // Does not wait for the transport thread
+  void unpack_interior();
+  // Waits for the messages, and completes the DSS of the boundary elements
+  void finish();
+
+  // The whole DSS of the fields at time level tl, without overlap
+  void exchange(const int tl);
+
+  // Elements with all their neighbours on the same rank, and the others
+  ExecViewManaged<int *> interior_elements() const { return m_interior; }
+  ExecViewManaged<int *> boundary_elements() const { return m_boundary; }
+
+  int num_messages() const { return m_messages.size(); }
+  // Size of all the messages of one exchange
+  size_t message_bytes() const {
+    return m_send_messages.size() * sizeof(Scalar);
+  }
+
+  int num_exchanges() const { return m_num_exchanges; }
+  double seconds_packing() const { return m_seconds_packing; }
+  double seconds_unpacking() const { return m_seconds_unpacking; }
+  // Time spent by the caller waiting for the transport thread in finish()
+  double seconds_waiting() const { return m_seconds_waiting; }
+  // Time spent by the transport thread copying messages
+  double seconds_in_transfers() const { return m_seconds_in_transfers; }
+
+  // The GLL point at position ipoint along an edge, and at a corner
+  KOKKOS_INLINE_FUNCTION
+  static void edge_point(const int edge, const int ipoint, int &igp,
+                         int &jgp) {
+    igp = (edge == Connectivity::WEST ? 0 : edge == Connectivity::EAST
+                                                ? NP - 1
+                                                : ipoint);
+    jgp = (edge == Connectivity::SOUTH ? 0 : edge == Connectivity::NORTH
+                                                 ? NP - 1
+                                                 : ipoint);
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  static void corner_point(const int corner_dir, int &igp, int &jgp) {
+    igp = (corner_dir == Connectivity::SWEST ||
+                   corner_dir == Connectivity::NWEST
+               ? 0
+               : NP - 1);
+    jgp = (corner_dir == Connectivity::SWEST ||
+                   corner_dir == Connectivity::SEAST
+               ? 0
+               : NP - 1);
+  }
+
+private:
+  // A contiguous range of columns of the message buffers
+  struct Message {
+    int src_rank;
+    int dst_rank;
+    int begin;
+    int end;
+  };
+
+  void init_messages();
+  void init_rspheremp(const Elements &elements);
+  void unpack(const ExecViewManaged<int *> &elems);
+  void transport_loop();
+
+  static constexpr int NUM_EDGE_POINTS = Connectivity::NUM_EDGES * NP;
+  static constexpr int NUM_BOUNDARY_POINTS =
+      NUM_EDGE_POINTS + Connectivity::NUM_CORNERS;
+
+  const Connectivity m_connectivity;
+  const int m_num_elems;
+
+  Kokkos::Array<ExecViewManaged<Scalar * [NUM_TIME_LEVELS][NP][NP][NUM_LEV]>,
+                NUM_FIELDS> m_fields;
+
+  // The inverse of the assembled spheremp
+  ExecViewManaged<Real * [NP][NP]> m_rspheremp;
+
+  // The boundaries packed by each element, read by its neighbours on the
+  // same rank
+  ExecViewManaged<Scalar * [Connectivity::NUM_EDGES][NUM_FIELDS][NP][NUM_LEV]>
+      m_edge_buffer;
+  ExecViewManaged<Scalar * [Connectivity::NUM_CORNERS][NUM_FIELDS][NUM_LEV]>
+      m_corner_buffer;
+
+  // The first column of the messages holding the boundary of each element in
+  // each direction, or -1 if the neighbour is on the same rank
+  ExecViewManaged<int * [Connectivity::NUM_DIRECTIONS]> m_message_offset;
+  // One column is one GLL point of every field
+  ExecViewManaged<Scalar * [NUM_FIELDS][NUM_LEV]> m_send_messages;
+  ExecViewManaged<Scalar * [NUM_FIELDS][NUM_LEV]> m_recv_messages;
+  std::vector<Message> m_messages;
+
+  ExecViewManaged<int *> m_interior;
+  ExecViewManaged<int *> m_boundary;
+
+  // The time level of the pending exchange
+  int m_tl;
+
+  // Protected by m_mutex
+  bool m_posted;
+  bool m_delivered;
+  bool m_done;
+
+  int m_num_exchanges;
+  double m_seconds_packing;
+  double m_seconds_unpacking;
+  double m_seconds_waiting;
+  double m_seconds_in_transfers;
+
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::thread m_transport;
+};
+
+} // namespace Homme
+
+#endif // HOMMEXX_BOUNDARY_EXCHANGE_HPP
@@ -5,8 +5,11 @@
 #include "Control.hpp"
 #include "Elements.hpp"
 #include "Derivative.hpp"
+#include "Diagnostics.hpp"
 #include "KernelVariables.hpp"
+#include "LoadBalance.hpp"
 #include "SphereOperators.hpp"
+#include "Trace.hpp"
 
 #include "Utility.hpp"
 #include "profiling.hpp"
@@ -15,104 +18,178 @@
 
 namespace Homme {
 
+// The value type of the reduction over the levels in compute_dp3d_np1, when
+// the diagnostics are computed as well
+struct Dp3dNp1Values {
+  KOKKOS_INLINE_FUNCTION Dp3dNp1Values() : num_bad_levels(0) {}
+
+  KOKKOS_INLINE_FUNCTION void operator+=(const Dp3dNp1Values &rhs) {
+    diagnostics += rhs.diagnostics;
+    num_bad_levels += rhs.num_bad_levels;
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  void operator+=(const volatile Dp3dNp1Values &rhs) volatile {
+    diagnostics += rhs.diagnostics;
+    num_bad_levels += rhs.num_bad_levels;
+  }
+
+  Diagnostics::Values diagnostics;
+  int num_bad_levels;
+};
+
 struct CaarFunctor {
   Control m_data;
   const Elements m_elements;
   const Derivative m_deriv;
+  const Diagnostics m_diagnostics;
+  // The elements processed by the league, or all of them if empty
+  ExecViewManaged<int *> m_elem_ids;
+  // If positive, each team runs the phases on chunks of this many elements
+  int m_chunk_elems = 0;
+  // The number of chunks the levels are split in, between the threads of a
+  // team. See ThreadsDistribution::level_chunks
+  int m_level_chunks = 1;
+  // If set, the teams take the chunks from m_next_chunk as they go instead
+  // of a fixed range of chunks. See run_step
+  bool m_dynamic_schedule = false;
+  ExecViewManaged<int> m_next_chunk;
+  // If positive, each launch runs this many steps. See run_phases
+  int m_persistent_steps = 0;
+  // The number of teams which reached the barrier after each step
+  ExecViewManaged<int> m_step_arrivals;
+  // The kernel_seconds() at which the last team reached each barrier
+  ExecViewManaged<double *> m_step_end_times;
+  // The number of times the scan phase runs on each element, to emulate
+  // elements of different costs. Once if empty
+  ExecViewManaged<int *> m_elem_costs;
+  // The busy time of the teams, when running on chunks
+  LoadBalance::TeamTimes m_team_times;
+  // The timeline of the phases, if enabled
+  Trace m_trace;
+  // If set, the pressure, PHI and omega_p are computed in one sweep of each
+  // column. See preq_hydrostatic_omega_ps
+  bool m_fused_scan = false;
 
   static constexpr Kokkos::Impl::ALL_t ALL = Kokkos::ALL;
 
   CaarFunctor()
-      : m_data(), m_elements(get_elements()), m_deriv(get_derivative()) {
+      : m_data(), m_elements(get_elements()), m_deriv(get_derivative()),
+        m_diagnostics(get_diagnostics()) {
     // Nothing to be done here
   }
 
-  KOKKOS_INLINE_FUNCTION
   CaarFunctor(const Control &data, const Elements &elements,
               const Derivative &deriv)
-      : m_data(data), m_elements(elements), m_deriv(deriv) {
+      : m_data(data), m_elements(elements), m_deriv(deriv),
+        m_diagnostics(get_diagnostics()) {
     // Nothing to be done here
   }
 
+  KOKKOS_INLINE_FUNCTION
+  CaarFunctor(const Control &data, const Elements &elements,
+              const Derivative &deriv, const Diagnostics &diagnostics)
+      : m_data(data), m_elements(elements), m_deriv(deriv),
+        m_diagnostics(diagnostics) {
+    // Nothing to be done here
+  }
+
+  // Runs f(igp, jgp, ilev) on all the (GLL point, level pack) pairs of the
+  // element, for work which is pointwise in the levels. The threads of the
+  // team split the GLL points and, with m_level_chunks > 1, contiguous chunks
+  // of levels. The vector lanes run over the levels of a chunk
+  template <typename Lambda>
+  KOKKOS_INLINE_FUNCTION void
+  parallel_for_points_levels(const KernelVariables &kv, const Lambda &f) const {
+    const int num_chunks = m_level_chunks;
+    const int chunk_levels = (NUM_LEV + num_chunks - 1) / num_chunks;
+    Kokkos::parallel_for(Kokkos::TeamThreadRange(kv.team, NP * NP * num_chunks),
+                         [&](const int idx) {
+      const int igp = (idx / num_chunks) / NP;
+      const int jgp = (idx / num_chunks) % NP;
+      const int lev_begin = (idx % num_chunks) * chunk_levels;
+      const int num_levels = (lev_begin + chunk_levels < NUM_LEV
+                                  ? chunk_levels
+                                  : NUM_LEV - lev_begin);
+      Kokkos::parallel_for(Kokkos::ThreadVectorRange(kv.team, num_levels),
+                           [&](const int &i) { f(igp, jgp, lev_begin + i); });
+    });
+  }
+
   // Depends on PHI (after preq_hydrostatic), PECND
   // Modifies Ephi_grad
   // Computes \nabla (E + phi) + \nabla (P) * Rgas * T_v / P
   KOKKOS_INLINE_FUNCTION void compute_energy_grad(KernelVariables &kv) const {
-    Kokkos::parallel_for(Kokkos::TeamThreadRange(kv.team, NP * NP),
-                         [&](const int idx) {
-      const int igp = idx / NP;
-      const int jgp = idx % NP;
-      Kokkos::parallel_for(Kokkos::ThreadVectorRange(kv.team, NUM_LEV),
-                           [&](const int &ilev) {
-        // pre-fill energy_grad with the pressure(_grad)-temperature part
-        m_elements.buffers.energy_grad(kv.ie, 0, igp, jgp, ilev) =
-            PhysicalConstants::Rgas *
-            (m_elements.buffers.temperature_virt(kv.ie, igp, jgp, ilev) /
-             m_elements.buffers.pressure(kv.ie, igp, jgp, ilev)) *
-            m_elements.buffers.pressure_grad(kv.ie, 0, igp, jgp, ilev);
-
-        m_elements.buffers.energy_grad(kv.ie, 1, igp, jgp, ilev) =
-            PhysicalConstants::Rgas *
-            (m_elements.buffers.temperature_virt(kv.ie, igp, jgp, ilev) /
-             m_elements.buffers.pressure(kv.ie, igp, jgp, ilev)) *
-            m_elements.buffers.pressure_grad(kv.ie, 1, igp, jgp, ilev);
-
-        // Kinetic energy + PHI (geopotential energy) +
-        // PECND (potential energy?)
-        Scalar k_energy =
-            0.5 * (m_elements.m_u(kv.ie, m_data.n0, igp, jgp, ilev) *
-                       m_elements.m_u(kv.ie, m_data.n0, igp, jgp, ilev) +
-                   m_elements.m_v(kv.ie, m_data.n0, igp, jgp, ilev) *
-                       m_elements.m_v(kv.ie, m_data.n0, igp, jgp, ilev));
-        m_elements.buffers.ephi(kv.ie, igp, jgp, ilev) =
-            k_energy + (m_elements.m_phi(kv.ie, igp, jgp, ilev) +
-                        m_elements.m_pecnd(kv.ie, igp, jgp, ilev));
-      });
+    start_perf_region(COMPUTE_ENERGY_GRAD);
+    parallel_for_points_levels(
+        kv, [&](const int igp, const int jgp, const int ilev) {
+      // pre-fill energy_grad with the pressure(_grad)-temperature part
+      m_elements.buffers.energy_grad(kv.ibuf, 0, igp, jgp, ilev) =
+          PhysicalConstants::Rgas *
+          (m_elements.buffers.temperature_virt(kv.ibuf, igp, jgp, ilev) /
+           m_elements.buffers.pressure(kv.ibuf, igp, jgp, ilev)) *
+          m_elements.buffers.pressure_grad(kv.ibuf, 0, igp, jgp, ilev);
+
+      m_elements.buffers.energy_grad(kv.ibuf, 1, igp, jgp, ilev) =
+          PhysicalConstants::Rgas *
+          (m_elements.buffers.temperature_virt(kv.ibuf, igp, jgp, ilev) /
+           m_elements.buffers.pressure(kv.ibuf, igp, jgp, ilev)) *
+          m_elements.buffers.pressure_grad(kv.ibuf, 1, igp, jgp, ilev);
+
+      // Kinetic energy + PHI (geopotential energy) +
+      // PECND (potential energy?)
+      Scalar k_energy =
+          0.5 * (m_elements.m_u(kv.ie, m_data.n0, igp, jgp, ilev) *
+                     m_elements.m_u(kv.ie, m_data.n0, igp, jgp, ilev) +
+                 m_elements.m_v(kv.ie, m_data.n0, igp, jgp, ilev) *
+                     m_elements.m_v(kv.ie, m_data.n0, igp, jgp, ilev));
+      m_elements.buffers.ephi(kv.ibuf, igp, jgp, ilev) =
+          k_energy + (m_elements.m_phi(kv.ie, igp, jgp, ilev) +
+                      m_elements.m_pecnd(kv.ie, igp, jgp, ilev));
     });
     kv.team_barrier();
 
     gradient_sphere_update(
         kv, m_elements.m_dinv, m_deriv.get_dvv(),
-        Kokkos::subview(m_elements.buffers.ephi, kv.ie, ALL, ALL, ALL),
+        Kokkos::subview(m_elements.buffers.ephi, kv.ibuf, ALL, ALL, ALL),
         m_elements.buffers.grad_buf,
-        Kokkos::subview(m_elements.buffers.energy_grad, kv.ie, ALL, ALL, ALL,
+        Kokkos::subview(m_elements.buffers.energy_grad, kv.ibuf, ALL, ALL, ALL,
                         ALL));
+    stop_perf_region(COMPUTE_ENERGY_GRAD);
   } // TESTED 1
 
-#ifdef NDEBUG
-  KOKKOS_INLINE_FUNCTION void check_dp3d(KernelVariables &kv) const {}
-#else
-  KOKKOS_INLINE_FUNCTION void check_dp3d(KernelVariables &kv) const {
-    Kokkos::parallel_for(Kokkos::TeamThreadRange(kv.team,
-                                                 NP * NP * NUM_PHYSICAL_LEV),
-                         [&](const int &idx) {
-      const int igp = (idx / NUM_PHYSICAL_LEV) / NP;
-      const int jgp = (idx / NUM_PHYSICAL_LEV) % NP;
-      const int ilev = (idx % NUM_PHYSICAL_LEV) / VECTOR_SIZE;
-      const int ivec = (idx % NUM_PHYSICAL_LEV) % VECTOR_SIZE;
-      assert(m_elements.m_dp3d(kv.ie, m_data.np1, igp, jgp, ilev)[ivec] > 0.0);
-    });
-    kv.team_barrier();
-  }
-#endif
-
   // Depends on pressure, PHI, U_current, V_current, METDET,
   // D, DINV, U, V, FCOR, SPHEREMP, T_v, ETA_DPDN
   KOKKOS_INLINE_FUNCTION void compute_phase_3(KernelVariables &kv) const {
-    compute_eta_dpdn_rsplit(kv);
+    if (m_data.rsplit == 0) {
+      compute_phase_3_impl<true>(kv);
+    } else {
+      compute_eta_dpdn_rsplit(kv);
+      compute_phase_3_impl<false>(kv);
+    }
+  } // TRIVIAL
+
+  // With HAS_VERTICAL_FLUX (rsplit == 0), computes eta_dot_dpdn and the
+  // vertical advection of T and v, and includes them in the tendencies.
+  // Otherwise eta_dot_dpdn must be zero, and is not read
+  template <bool HAS_VERTICAL_FLUX>
+  KOKKOS_INLINE_FUNCTION void compute_phase_3_impl(KernelVariables &kv) const {
+    if (HAS_VERTICAL_FLUX) {
+      compute_eta_dpdn_no_rsplit(kv);
+      preq_vertadv(kv);
+    }
     compute_omega_p(kv);
-    compute_temperature_np1(kv);
-    compute_velocity_np1(kv);
-    // Note this is dependent on eta_dot_dpdn from other levels and will cause
-    // issues when rsplit is 0
-    compute_dp3d_np1(kv);
-    check_dp3d(kv);
+    compute_temperature_np1<HAS_VERTICAL_FLUX>(kv);
+    compute_velocity_np1<HAS_VERTICAL_FLUX>(kv);
+    compute_dp3d_np1<HAS_VERTICAL_FLUX>(kv);
   } // TRIVIAL
 
   // Depends on pressure, PHI, U_current, V_current, METDET,
-  // D, DINV, U, V, FCOR, SPHEREMP, T_v
+  // D, DINV, U, V, FCOR, SPHEREMP, T_v, and v_vadv if HAS_VERTICAL_FLUX
+  template <bool HAS_VERTICAL_FLUX>
   KOKKOS_INLINE_FUNCTION
   void compute_velocity_np1(KernelVariables &kv) const {
+    start_perf_region(COMPUTE_VELOCITY_NP1);
     compute_energy_grad(kv);
 
     vorticity_sphere(
@@ -120,51 +197,50 @@ struct CaarFunctor {
         Kokkos::subview(m_elements.m_u, kv.ie, m_data.n0, ALL, ALL, ALL),
         Kokkos::subview(m_elements.m_v, kv.ie, m_data.n0, ALL, ALL, ALL),
         m_elements.buffers.vort_buf,
-        Kokkos::subview(m_elements.buffers.vorticity, kv.ie, ALL, ALL, ALL));
+        Kokkos::subview(m_elements.buffers.vorticity, kv.ibuf, ALL, ALL, ALL));
+
+    parallel_for_points_levels(
+        kv, [&](const int igp, const int jgp, const int ilev) {
+      // Recycle vort to contain (fcor+vort)
+      m_elements.buffers.vorticity(kv.ibuf, igp, jgp, ilev) +=
+          m_elements.m_fcor(kv.ie, igp, jgp);
+
+      m_elements.buffers.energy_grad(kv.ibuf, 0, igp, jgp, ilev) *= -1;
+      m_elements.buffers.energy_grad(kv.ibuf, 0, igp, jgp, ilev) +=
+          m_elements.m_v(kv.ie, m_data.n0, igp, jgp, ilev) *
+          m_elements.buffers.vorticity(kv.ibuf, igp, jgp, ilev);
+      m_elements.buffers.energy_grad(kv.ibuf, 1, igp, jgp, ilev) *= -1;
+      m_elements.buffers.energy_grad(kv.ibuf, 1, igp, jgp, ilev) +=
+          -m_elements.m_u(kv.ie, m_data.n0, igp, jgp, ilev) *
+          m_elements.buffers.vorticity(kv.ibuf, igp, jgp, ilev);
+      if (HAS_VERTICAL_FLUX) {
+        m_elements.buffers.energy_grad(kv.ibuf, 0, igp, jgp, ilev) -=
+            m_elements.buffers.v_vadv(kv.ibuf, 0, igp, jgp, ilev);
+        m_elements.buffers.energy_grad(kv.ibuf, 1, igp, jgp, ilev) -=
+            m_elements.buffers.v_vadv(kv.ibuf, 1, igp, jgp, ilev);
+      }
 
-    Kokkos::parallel_for(Kokkos::TeamThreadRange(kv.team, NP * NP),
-                         [&](const int idx) {
-      const int igp = idx / NP;
-      const int jgp = idx % NP;
-      Kokkos::parallel_for(Kokkos::ThreadVectorRange(kv.team, NUM_LEV),
-                           [&](const int &ilev) {
-        // Recycle vort to contain (fcor+vort)
-        m_elements.buffers.vorticity(kv.ie, igp, jgp, ilev) +=
-            m_elements.m_fcor(kv.ie, igp, jgp);
-
-        m_elements.buffers.energy_grad(kv.ie, 0, igp, jgp, ilev) *= -1;
-        m_elements.buffers.energy_grad(kv.ie, 0, igp, jgp, ilev) +=
-            /* v_vadv(igp, jgp) + */ m_elements.m_v(kv.ie, m_data.n0, igp, jgp,
-                                                    ilev) *
-            m_elements.buffers.vorticity(kv.ie, igp, jgp, ilev);
-        m_elements.buffers.energy_grad(kv.ie, 1, igp, jgp, ilev) *= -1;
-        m_elements.buffers.energy_grad(kv.ie, 1, igp, jgp, ilev) +=
-            /* v_vadv(igp, jgp) + */ -m_elements.m_u(kv.ie, m_data.n0, igp, jgp,
-                                                     ilev) *
-            m_elements.buffers.vorticity(kv.ie, igp, jgp, ilev);
-
-        m_elements.buffers.energy_grad(kv.ie, 0, igp, jgp, ilev) *= m_data.dt;
-        m_elements.buffers.energy_grad(kv.ie, 0, igp, jgp, ilev) +=
-            m_elements.m_u(kv.ie, m_data.nm1, igp, jgp, ilev);
-        m_elements.buffers.energy_grad(kv.ie, 1, igp, jgp, ilev) *= m_data.dt;
-        m_elements.buffers.energy_grad(kv.ie, 1, igp, jgp, ilev) +=
-            m_elements.m_v(kv.ie, m_data.nm1, igp, jgp, ilev);
-
-        // Velocity at np1 = spheremp * buffer
-        m_elements.m_u(kv.ie, m_data.np1, igp, jgp, ilev) =
-            m_elements.m_spheremp(kv.ie, igp, jgp) *
-            m_elements.buffers.energy_grad(kv.ie, 0, igp, jgp, ilev);
-        m_elements.m_v(kv.ie, m_data.np1, igp, jgp, ilev) =
-            m_elements.m_spheremp(kv.ie, igp, jgp) *
-            m_elements.buffers.energy_grad(kv.ie, 1, igp, jgp, ilev);
-      });
+      m_elements.buffers.energy_grad(kv.ibuf, 0, igp, jgp, ilev) *= m_data.dt;
+      m_elements.buffers.energy_grad(kv.ibuf, 0, igp, jgp, ilev) +=
+          m_elements.m_u(kv.ie, m_data.nm1, igp, jgp, ilev);
+      m_elements.buffers.energy_grad(kv.ibuf, 1, igp, jgp, ilev) *= m_data.dt;
+      m_elements.buffers.energy_grad(kv.ibuf, 1, igp, jgp, ilev) +=
+          m_elements.m_v(kv.ie, m_data.nm1, igp, jgp, ilev);
+
+      // Velocity at np1 = spheremp * buffer
+      m_elements.m_u(kv.ie, m_data.np1, igp, jgp, ilev) =
+          m_elements.m_spheremp(kv.ie, igp, jgp) *
+          m_elements.buffers.energy_grad(kv.ibuf, 0, igp, jgp, ilev);
+      m_elements.m_v(kv.ie, m_data.np1, igp, jgp, ilev) =
+          m_elements.m_spheremp(kv.ie, igp, jgp) *
+          m_elements.buffers.energy_grad(kv.ibuf, 1, igp, jgp, ilev);
     });
     kv.team_barrier();
+    stop_perf_region(COMPUTE_VELOCITY_NP1);
   } // UNTESTED 2
 
-  // TODO: Use partial template specialization to determine if we need this
-  // Make a templated subclass of an untemplated version of CaarFunctor
-  // Specialize the templated subclass to implement these based on rsplit
+  // Not needed by the CaarFunctorImpl specializations with rsplit > 0, where
+  // eta_dot_dpdn is zeroed once at setup instead
   KOKKOS_INLINE_FUNCTION
   void compute_eta_dpdn_rsplit(KernelVariables &kv) const {
     Kokkos::parallel_for(Kokkos::TeamThreadRange(kv.team, NP * NP),
@@ -178,24 +254,68 @@ struct CaarFunctor {
     kv.team_barrier();
   } // TRIVIAL
 
+  // Depends on div_vdp, hybrid_b
+  // Modifies ETA_DPDN
+  // At interface k, eta_dot_dpdn = hybi(k) * sdot_sum - sum_{l < k} div_vdp(l),
+  // where sdot_sum is the sum over the whole column. It is zero at the top and
+  // bottom interfaces. The partial sums within a pack are computed with a
+  // lane-parallel prefix sum, which takes log2(VECTOR_SIZE) shifts
   KOKKOS_INLINE_FUNCTION
   void compute_eta_dpdn_no_rsplit(KernelVariables &kv) const {
-    Kokkos::parallel_for(
-        Kokkos::TeamThreadRange(kv.team, NP * NP),
-        KOKKOS_LAMBDA(const int idx) {
-          // TODO: Compute the actual value for this if rsplit=0.
-          // Note this will be unsafe to thread over levels,
-          // so thread over points instead
-          // for (int ilev=0; ilev<NUM_INTERFACE_LEV; ++ilev) {
-          //   m_elements.eta_dot_dpdn += eta_ave_w*eta_dot_dpdn
-          // }
-        });
-  } // Unimplemented
+    Kokkos::parallel_for(Kokkos::TeamThreadRange(kv.team, NP * NP),
+                         [&](const int loop_idx) {
+      Kokkos::single(Kokkos::PerThread(kv.team), [&]() {
+        const int igp = loop_idx / NP;
+        const int jgp = loop_idx % NP;
+
+        // The sum of div_vdp over the levels of the previous packs
+        Real sdot_sum = 0;
+        for (int ilev = 0; ilev < NUM_LEV; ++ilev) {
+          Scalar partial_sum = m_elements.buffers.div_vdp(kv.ibuf, igp, jgp, ilev);
+          if (ilev == NUM_LEV - 1) {
+            // Leave the padding out of the sum
+            for (int iv = NUM_PHYSICAL_LEV - ilev * VECTOR_SIZE;
+                 iv < VECTOR_SIZE; ++iv) {
+              partial_sum[iv] = 0;
+            }
+          }
+          for (int shift = 1; shift < VECTOR_SIZE; shift *= 2) {
+            Scalar shifted = partial_sum;
+            shifted.shift_right(shift);
+            partial_sum += shifted;
+          }
+          partial_sum += sdot_sum;
+
+          // Interface k is above level k, so it gets the sum up to level k-1
+          Scalar eta = partial_sum;
+          eta.shift_right(1);
+          eta[0] = sdot_sum;
+          m_elements.m_eta_dot_dpdn(kv.ie, igp, jgp, ilev) = eta;
+
+          sdot_sum = partial_sum[VECTOR_SIZE - 1];
+        }
+
+        for (int ilev = 0; ilev < NUM_LEV_P; ++ilev) {
+          Scalar &eta = m_elements.m_eta_dot_dpdn(kv.ie, igp, jgp, ilev);
+          eta = m_data.hybrid_b(ilev) * sdot_sum - eta;
+        }
+        // No flux through the top and the bottom, nor in the padding
+        m_elements.m_eta_dot_dpdn(kv.ie, igp, jgp, 0)[0] = 0;
+        for (int ilevel = NUM_PHYSICAL_LEV; ilevel < NUM_LEV_P * VECTOR_SIZE;
+             ++ilevel) {
+          m_elements.m_eta_dot_dpdn(kv.ie, igp, jgp, ilevel / VECTOR_SIZE)
+              [ilevel % VECTOR_SIZE] = 0;
+        }
+      });
+    });
+    kv.team_barrier();
+  } // UNTESTED 14
 
   // Depends on PHIS, DP3D, PHI, pressure, T_v
   // Modifies PHI
   KOKKOS_INLINE_FUNCTION
   void preq_hydrostatic(KernelVariables &kv) const {
+    start_perf_region(PREQ_HYDROSTATIC);
     Kokkos::parallel_for(Kokkos::TeamThreadRange(kv.team, NP * NP),
                          [&](const int loop_idx) {
       Kokkos::single(Kokkos::PerThread(kv.team), [&]() {
@@ -216,10 +336,10 @@ struct CaarFunctor {
           const Real phis = m_elements.m_phis(kv.ie, igp, jgp);
           auto &phi = m_elements.m_phi(kv.ie, igp, jgp, ilev);
           const auto &t_v =
-              m_elements.buffers.temperature_virt(kv.ie, igp, jgp, ilev);
+              m_elements.buffers.temperature_virt(kv.ibuf, igp, jgp, ilev);
           const auto &dp3d =
               m_elements.m_dp3d(kv.ie, m_data.n0, igp, jgp, ilev);
-          const auto &p = m_elements.buffers.pressure(kv.ie, igp, jgp, ilev);
+          const auto &p = m_elements.buffers.pressure(kv.ibuf, igp, jgp, ilev);
 
           // Precompute this product as a SIMD operation
           const auto rgas_tv_dp_over_p =
@@ -239,17 +359,19 @@ struct CaarFunctor {
       });
     });
     kv.team_barrier();
+    stop_perf_region(PREQ_HYDROSTATIC);
   } // TESTED 3
 
   // Depends on pressure, U_current, V_current, div_vdp,
   // omega_p
   KOKKOS_INLINE_FUNCTION
   void preq_omega_ps(KernelVariables &kv) const {
+    start_perf_region(PREQ_OMEGA_PS);
     gradient_sphere(
         kv, m_elements.m_dinv, m_deriv.get_dvv(),
-        Kokkos::subview(m_elements.buffers.pressure, kv.ie, ALL, ALL, ALL),
+        Kokkos::subview(m_elements.buffers.pressure, kv.ibuf, ALL, ALL, ALL),
         m_elements.buffers.grad_buf,
-        Kokkos::subview(m_elements.buffers.pressure_grad, kv.ie, ALL, ALL, ALL,
+        Kokkos::subview(m_elements.buffers.pressure_grad, kv.ibuf, ALL, ALL, ALL,
                         ALL));
 
     Kokkos::parallel_for(Kokkos::TeamThreadRange(kv.team, NP * NP),
@@ -267,13 +389,13 @@ struct CaarFunctor {
 
           const Scalar vgrad_p =
               m_elements.m_u(kv.ie, m_data.n0, igp, jgp, ilev) *
-                  m_elements.buffers.pressure_grad(kv.ie, 0, igp, jgp, ilev) +
+                  m_elements.buffers.pressure_grad(kv.ibuf, 0, igp, jgp, ilev) +
               m_elements.m_v(kv.ie, m_data.n0, igp, jgp, ilev) *
-                  m_elements.buffers.pressure_grad(kv.ie, 1, igp, jgp, ilev);
-          auto &omega_p = m_elements.buffers.omega_p(kv.ie, igp, jgp, ilev);
-          const auto &p = m_elements.buffers.pressure(kv.ie, igp, jgp, ilev);
+                  m_elements.buffers.pressure_grad(kv.ibuf, 1, igp, jgp, ilev);
+          auto &omega_p = m_elements.buffers.omega_p(kv.ibuf, igp, jgp, ilev);
+          const auto &p = m_elements.buffers.pressure(kv.ibuf, igp, jgp, ilev);
           const auto &div_vdp =
-              m_elements.buffers.div_vdp(kv.ie, igp, jgp, ilev);
+              m_elements.buffers.div_vdp(kv.ibuf, igp, jgp, ilev);
 
           Scalar integration_ij;
           integration_ij[0] = integration;
@@ -285,11 +407,13 @@ struct CaarFunctor {
       });
     });
     kv.team_barrier();
+    stop_perf_region(PREQ_OMEGA_PS);
   } // TESTED 4
 
   // Depends on DP3D
   KOKKOS_INLINE_FUNCTION
   void compute_pressure(KernelVariables &kv) const {
+    start_perf_region(COMPUTE_PRESSURE);
     Kokkos::parallel_for(Kokkos::TeamThreadRange(kv.team, NP * NP),
                          [&](const int loop_idx) {
       Kokkos::single(Kokkos::PerThread(kv.team), [&]() {
@@ -304,7 +428,7 @@ struct CaarFunctor {
                    ? ((NUM_PHYSICAL_LEV + VECTOR_SIZE - 1) % VECTOR_SIZE)
                    : VECTOR_SIZE - 1);
 
-          auto p = m_elements.buffers.pressure(kv.ie, igp, jgp, ilev);
+          auto p = m_elements.buffers.pressure(kv.ibuf, igp, jgp, ilev);
           const auto &dp = m_elements.m_dp3d(kv.ie, m_data.n0, igp, jgp, ilev);
 
           for (int iv = 0; iv <= vector_end; ++iv) {
@@ -314,13 +438,121 @@ struct CaarFunctor {
             p_prev = p[iv];
             dp_prev = dp[iv];
           }
-          m_elements.buffers.pressure(kv.ie, igp, jgp, ilev) = p;
+          m_elements.buffers.pressure(kv.ibuf, igp, jgp, ilev) = p;
         };
       });
     });
     kv.team_barrier();
+    stop_perf_region(COMPUTE_PRESSURE);
   } // TESTED 5
 
+  // Depends on U_current, V_current, DP3D, PHIS, T_v, div_vdp
+  // Modifies pressure, pressure_grad, omega_p, PHI
+  // compute_pressure, preq_hydrostatic and preq_omega_ps in one sweep of
+  // each column, as in merged_hydro_omega of routine_st_fused.F90. Going
+  // down, each pack of dp3d, T_v and div_vdp is loaded once to accumulate the
+  // pressure, and to leave the hydrostatic terms Rgas * T_v * dp / (2 p) in
+  // PHI and the integral of div_vdp in omega_p. The gradient of the pressure
+  // needs the whole element, so it is taken between the two halves of the
+  // sweep. Going up, v . grad(p) completes omega_p and the hydrostatic terms
+  // below each level are summed into PHI. The operations are those of the
+  // split scans, but PHI only has to match theirs up to rounding, so that the
+  // compiler may contract them differently
+  KOKKOS_INLINE_FUNCTION
+  void preq_hydrostatic_omega_ps(KernelVariables &kv) const {
+    start_perf_region(PREQ_HYDROSTATIC_OMEGA_PS);
+    constexpr int last_lvl_last_vector_idx =
+        (NUM_PHYSICAL_LEV + VECTOR_SIZE - 1) % VECTOR_SIZE;
+
+    Kokkos::parallel_for(Kokkos::TeamThreadRange(kv.team, NP * NP),
+                         [&](const int loop_idx) {
+      Kokkos::single(Kokkos::PerThread(kv.team), [&]() {
+        const int igp = loop_idx / NP;
+        const int jgp = loop_idx % NP;
+
+        Real dp_prev = 0;
+        Real p_prev = m_data.hybrid_a(0) * m_data.ps0;
+        // The sum of div_vdp above the level
+        Real summ = 0;
+        for (int ilev = 0; ilev < NUM_LEV; ++ilev) {
+          const int vector_end =
+              (ilev == NUM_LEV - 1 ? last_lvl_last_vector_idx
+                                   : VECTOR_SIZE - 1);
+
+          const Scalar dp3d = m_elements.m_dp3d(kv.ie, m_data.n0, igp, jgp, ilev);
+          const Scalar div_vdp =
+              m_elements.buffers.div_vdp(kv.ibuf, igp, jgp, ilev);
+
+          Scalar p = m_elements.buffers.pressure(kv.ibuf, igp, jgp, ilev);
+          Scalar summ_ij;
+          for (int iv = 0; iv <= vector_end; ++iv) {
+            // p[k] = p[k-1] + 0.5*dp[k-1] + 0.5*dp[k]
+            p[iv] = p_prev + 0.5 * dp_prev + 0.5 * dp3d[iv];
+            p_prev = p[iv];
+            dp_prev = dp3d[iv];
+
+            summ_ij[iv] = summ;
+            summ += div_vdp[iv];
+          }
+          m_elements.buffers.pressure(kv.ibuf, igp, jgp, ilev) = p;
+
+          m_elements.m_phi(kv.ie, igp, jgp, ilev) =
+              PhysicalConstants::Rgas *
+              m_elements.buffers.temperature_virt(kv.ibuf, igp, jgp, ilev) *
+              (dp3d * 0.5 / p);
+          m_elements.buffers.omega_p(kv.ibuf, igp, jgp, ilev) =
+              -(summ_ij + 0.5 * div_vdp);
+        }
+      });
+    });
+    kv.team_barrier();
+
+    gradient_sphere(
+        kv, m_elements.m_dinv, m_deriv.get_dvv(),
+        Kokkos::subview(m_elements.buffers.pressure, kv.ibuf, ALL, ALL, ALL),
+        m_elements.buffers.grad_buf,
+        Kokkos::subview(m_elements.buffers.pressure_grad, kv.ibuf, ALL, ALL, ALL,
+                        ALL));
+
+    Kokkos::parallel_for(Kokkos::TeamThreadRange(kv.team, NP * NP),
+                         [&](const int loop_idx) {
+      Kokkos::single(Kokkos::PerThread(kv.team), [&]() {
+        const int igp = loop_idx / NP;
+        const int jgp = loop_idx % NP;
+
+        const Real phis = m_elements.m_phis(kv.ie, igp, jgp);
+        // The sum of the hydrostatic terms below the level
+        Real integration = 0;
+        for (int ilev = NUM_LEV - 1; ilev >= 0; --ilev) {
+          const int vec_start =
+              (ilev == (NUM_LEV - 1) ? last_lvl_last_vector_idx
+                                     : VECTOR_SIZE - 1);
+
+          const Scalar vgrad_p =
+              m_elements.m_u(kv.ie, m_data.n0, igp, jgp, ilev) *
+                  m_elements.buffers.pressure_grad(kv.ibuf, 0, igp, jgp, ilev) +
+              m_elements.m_v(kv.ie, m_data.n0, igp, jgp, ilev) *
+                  m_elements.buffers.pressure_grad(kv.ibuf, 1, igp, jgp, ilev);
+          auto &omega_p = m_elements.buffers.omega_p(kv.ibuf, igp, jgp, ilev);
+          omega_p = (vgrad_p + omega_p) /
+                    m_elements.buffers.pressure(kv.ibuf, igp, jgp, ilev);
+
+          auto &phi = m_elements.m_phi(kv.ie, igp, jgp, ilev);
+          Scalar integration_ij;
+          integration_ij[vec_start] = integration;
+          for (int iv = vec_start - 1; iv >= 0; --iv)
+            integration_ij[iv] = integration_ij[iv + 1] + phi[iv + 1];
+
+          // PHI holds the hydrostatic terms
+          integration = integration_ij[0] + phi[0];
+          phi = phis + 2.0 * integration_ij + phi;
+        }
+      });
+    });
+    kv.team_barrier();
+    stop_perf_region(PREQ_HYDROSTATIC_OMEGA_PS);
+  }
+
   // Depends on DP3D, PHIS, DP3D, PHI, T_v
   // Modifies pressure, PHI
   KOKKOS_INLINE_FUNCTION
@@ -328,41 +560,41 @@ struct CaarFunctor {
     // Use this instead of Kokkos::single(Kokkos::PerTeam
     // due to Kokkos failing to execute the TeamThreadRange parallel for
     // on CUDA
-    compute_pressure(kv);
-    preq_hydrostatic(kv);
-    preq_omega_ps(kv);
+    if (m_fused_scan) {
+      preq_hydrostatic_omega_ps(kv);
+    } else {
+      compute_pressure(kv);
+      preq_hydrostatic(kv);
+      preq_omega_ps(kv);
+    }
   } // TRIVIAL
 
   KOKKOS_INLINE_FUNCTION
   void compute_temperature_no_tracers_helper(KernelVariables &kv) const {
-    Kokkos::parallel_for(Kokkos::TeamThreadRange(kv.team, NP * NP),
-                         [&](const int idx) {
-      const int igp = idx / NP;
-      const int jgp = idx % NP;
-      for (int ilev = 0; ilev < NUM_LEV; ++ilev) {
-        m_elements.buffers.temperature_virt(kv.ie, igp, jgp, ilev) =
-            m_elements.m_t(kv.ie, m_data.n0, igp, jgp, ilev);
-      }
+    start_perf_region(COMPUTE_TEMPERATURE);
+    parallel_for_points_levels(
+        kv, [&](const int igp, const int jgp, const int ilev) {
+      m_elements.buffers.temperature_virt(kv.ibuf, igp, jgp, ilev) =
+          m_elements.m_t(kv.ie, m_data.n0, igp, jgp, ilev);
     });
     kv.team_barrier();
+    stop_perf_region(COMPUTE_TEMPERATURE);
   } // TESTED 6
 
   KOKKOS_INLINE_FUNCTION
   void compute_temperature_tracers_helper(KernelVariables &kv) const {
-    Kokkos::parallel_for(Kokkos::TeamThreadRange(kv.team, NP * NP),
-                         [&](const int idx) {
-      const int igp = idx / NP;
-      const int jgp = idx % NP;
-      for (int ilev = 0; ilev < NUM_LEV; ++ilev) {
-        Scalar Qt = m_elements.m_qdp(kv.ie, m_data.qn0, 0, igp, jgp, ilev) /
-                    m_elements.m_dp3d(kv.ie, m_data.n0, igp, jgp, ilev);
-        Qt *= (PhysicalConstants::Rwater_vapor / PhysicalConstants::Rgas - 1.0);
-        Qt += 1.0;
-        m_elements.buffers.temperature_virt(kv.ie, igp, jgp, ilev) =
-            m_elements.m_t(kv.ie, m_data.n0, igp, jgp, ilev) * Qt;
-      }
+    start_perf_region(COMPUTE_TEMPERATURE);
+    parallel_for_points_levels(
+        kv, [&](const int igp, const int jgp, const int ilev) {
+      Scalar Qt = m_elements.m_qdp(kv.ie, m_data.qn0, 0, igp, jgp, ilev) /
+                  m_elements.m_dp3d(kv.ie, m_data.n0, igp, jgp, ilev);
+      Qt *= (PhysicalConstants::Rwater_vapor / PhysicalConstants::Rgas - 1.0);
+      Qt += 1.0;
+      m_elements.buffers.temperature_virt(kv.ibuf, igp, jgp, ilev) =
+          m_elements.m_t(kv.ie, m_data.n0, igp, jgp, ilev) * Qt;
     });
     kv.team_barrier();
+    stop_perf_region(COMPUTE_TEMPERATURE);
   } // TESTED 7
 
   // Depends on DERIVED_UN0, DERIVED_VN0, METDET, DINV
@@ -371,33 +603,31 @@ struct CaarFunctor {
   // Requires NUM_LEV * 5 * NP * NP
   KOKKOS_INLINE_FUNCTION
   void compute_div_vdp(KernelVariables &kv) const {
-    Kokkos::parallel_for(Kokkos::TeamThreadRange(kv.team, NP * NP),
-                         [&](const int idx) {
-      const int igp = idx / NP;
-      const int jgp = idx % NP;
-      for (int ilev = 0; ilev < NUM_LEV; ++ilev) {
-        m_elements.buffers.vdp(kv.ie, 0, igp, jgp, ilev) =
-            m_elements.m_u(kv.ie, m_data.n0, igp, jgp, ilev) *
-            m_elements.m_dp3d(kv.ie, m_data.n0, igp, jgp, ilev);
-
-        m_elements.buffers.vdp(kv.ie, 1, igp, jgp, ilev) =
-            m_elements.m_v(kv.ie, m_data.n0, igp, jgp, ilev) *
-            m_elements.m_dp3d(kv.ie, m_data.n0, igp, jgp, ilev);
-
-        m_elements.m_derived_un0(kv.ie, igp, jgp, ilev) +=
-            m_data.eta_ave_w * m_elements.buffers.vdp(kv.ie, 0, igp, jgp, ilev);
-
-        m_elements.m_derived_vn0(kv.ie, igp, jgp, ilev) +=
-            m_data.eta_ave_w * m_elements.buffers.vdp(kv.ie, 1, igp, jgp, ilev);
-      }
+    start_perf_region(COMPUTE_DIV_VDP);
+    parallel_for_points_levels(
+        kv, [&](const int igp, const int jgp, const int ilev) {
+      m_elements.buffers.vdp(kv.ibuf, 0, igp, jgp, ilev) =
+          m_elements.m_u(kv.ie, m_data.n0, igp, jgp, ilev) *
+          m_elements.m_dp3d(kv.ie, m_data.n0, igp, jgp, ilev);
+
+      m_elements.buffers.vdp(kv.ibuf, 1, igp, jgp, ilev) =
+          m_elements.m_v(kv.ie, m_data.n0, igp, jgp, ilev) *
+          m_elements.m_dp3d(kv.ie, m_data.n0, igp, jgp, ilev);
+
+      m_elements.m_derived_un0(kv.ie, igp, jgp, ilev) +=
+          m_data.eta_ave_w * m_elements.buffers.vdp(kv.ibuf, 0, igp, jgp, ilev);
+
+      m_elements.m_derived_vn0(kv.ie, igp, jgp, ilev) +=
+          m_data.eta_ave_w * m_elements.buffers.vdp(kv.ibuf, 1, igp, jgp, ilev);
     });
     kv.team_barrier();
 
     divergence_sphere(
         kv, m_elements.m_dinv, m_elements.m_metdet, m_deriv.get_dvv(),
-        Kokkos::subview(m_elements.buffers.vdp, kv.ie, ALL, ALL, ALL, ALL),
+        Kokkos::subview(m_elements.buffers.vdp, kv.ibuf, ALL, ALL, ALL, ALL),
         m_elements.buffers.div_buf,
-        Kokkos::subview(m_elements.buffers.div_vdp, kv.ie, ALL, ALL, ALL));
+        Kokkos::subview(m_elements.buffers.div_vdp, kv.ibuf, ALL, ALL, ALL));
+    stop_perf_region(COMPUTE_DIV_VDP);
   } // TESTED 8
 
   // Depends on T_current, DERIVE_UN0, DERIVED_VN0, METDET,
@@ -415,150 +645,523 @@ struct CaarFunctor {
 
   KOKKOS_INLINE_FUNCTION
   void compute_omega_p(KernelVariables &kv) const {
-    Kokkos::parallel_for(Kokkos::TeamThreadRange(kv.team, NP * NP),
-                         [&](const int idx) {
-      const int igp = idx / NP;
-      const int jgp = idx % NP;
-      Kokkos::parallel_for(Kokkos::ThreadVectorRange(kv.team, NUM_LEV),
-                           [&](const int &ilev) {
-        m_elements.m_omega_p(kv.ie, igp, jgp, ilev) +=
-            m_data.eta_ave_w *
-            m_elements.buffers.omega_p(kv.ie, igp, jgp, ilev);
-      });
+    parallel_for_points_levels(
+        kv, [&](const int igp, const int jgp, const int ilev) {
+      m_elements.m_omega_p(kv.ie, igp, jgp, ilev) +=
+          m_data.eta_ave_w *
+          m_elements.buffers.omega_p(kv.ibuf, igp, jgp, ilev);
     });
     kv.team_barrier();
   } // TESTED 10
 
   // Depends on T (global), OMEGA_P (global), U (global), V
   // (global),
-  // SPHEREMP (global), T_v, and omega_p
+  // SPHEREMP (global), T_v, omega_p, and t_vadv if HAS_VERTICAL_FLUX
   // block_3d_scalars
+  template <bool HAS_VERTICAL_FLUX>
   KOKKOS_INLINE_FUNCTION
   void compute_temperature_np1(KernelVariables &kv) const {
+    start_perf_region(COMPUTE_TEMPERATURE_NP1);
 
     gradient_sphere(
         kv, m_elements.m_dinv, m_deriv.get_dvv(),
         Kokkos::subview(m_elements.m_t, kv.ie, m_data.n0, ALL, ALL, ALL),
         m_elements.buffers.grad_buf,
-        Kokkos::subview(m_elements.buffers.temperature_grad, kv.ie, ALL, ALL,
+        Kokkos::subview(m_elements.buffers.temperature_grad, kv.ibuf, ALL, ALL,
                         ALL, ALL));
 
-    Kokkos::parallel_for(Kokkos::TeamThreadRange(kv.team, NP * NP),
-                         [&](const int idx) {
-      const int igp = idx / NP;
-      const int jgp = idx % NP;
+    parallel_for_points_levels(
+        kv, [&](const int igp, const int jgp, const int ilev) {
+      const Scalar vgrad_t =
+          m_elements.m_u(kv.ie, m_data.n0, igp, jgp, ilev) *
+              m_elements.buffers.temperature_grad(kv.ibuf, 0, igp, jgp, ilev) +
+          m_elements.m_v(kv.ie, m_data.n0, igp, jgp, ilev) *
+              m_elements.buffers.temperature_grad(kv.ibuf, 1, igp, jgp, ilev);
+
+      // vgrad_t + kappa * T_v * omega_p
+      Scalar ttens =
+          -vgrad_t +
+          PhysicalConstants::kappa *
+              m_elements.buffers.temperature_virt(kv.ibuf, igp, jgp, ilev) *
+              m_elements.buffers.omega_p(kv.ibuf, igp, jgp, ilev);
+      if (HAS_VERTICAL_FLUX) {
+        ttens -= m_elements.buffers.t_vadv(kv.ibuf, igp, jgp, ilev);
+      }
 
-      Kokkos::parallel_for(Kokkos::ThreadVectorRange(kv.team, NUM_LEV),
-                           [&](const int &ilev) {
-        const Scalar vgrad_t =
-            m_elements.m_u(kv.ie, m_data.n0, igp, jgp, ilev) *
-                m_elements.buffers.temperature_grad(kv.ie, 0, igp, jgp, ilev) +
-            m_elements.m_v(kv.ie, m_data.n0, igp, jgp, ilev) *
-                m_elements.buffers.temperature_grad(kv.ie, 1, igp, jgp, ilev);
-
-        // vgrad_t + kappa * T_v * omega_p
-        const Scalar ttens =
-            -vgrad_t +
-            PhysicalConstants::kappa *
-                m_elements.buffers.temperature_virt(kv.ie, igp, jgp, ilev) *
-                m_elements.buffers.omega_p(kv.ie, igp, jgp, ilev);
-
-        Scalar temp_np1 = ttens * m_data.dt +
-                          m_elements.m_t(kv.ie, m_data.nm1, igp, jgp, ilev);
-        temp_np1 *= m_elements.m_spheremp(kv.ie, igp, jgp);
-        m_elements.m_t(kv.ie, m_data.np1, igp, jgp, ilev) = temp_np1;
-      });
+      Scalar temp_np1 = ttens * m_data.dt +
+                        m_elements.m_t(kv.ie, m_data.nm1, igp, jgp, ilev);
+      temp_np1 *= m_elements.m_spheremp(kv.ie, igp, jgp);
+      m_elements.m_t(kv.ie, m_data.np1, igp, jgp, ilev) = temp_np1;
     });
     kv.team_barrier();
+    stop_perf_region(COMPUTE_TEMPERATURE_NP1);
   } // TESTED 11
 
   // Depends on DERIVED_UN0, DERIVED_VN0, U, V,
   // Modifies DERIVED_UN0, DERIVED_VN0, OMEGA_P, T, and DP3D
+  // With HAS_VERTICAL_FLUX false, eta_dot_dpdn is known to be zero (rsplit > 0)
+  // and is not read.
+  // Counts the levels with non-positive dp3d at np1, and records them in
+  // Elements::m_dp3d_num_bad_levels.
+  // If compute_diagonstics is set, also accumulates the diagnostics of the
+  // state at np1, while dp3d at np1 is still in registers
+  template <bool HAS_VERTICAL_FLUX = true>
   KOKKOS_INLINE_FUNCTION
   void compute_dp3d_np1(KernelVariables &kv) const {
+    start_perf_region(COMPUTE_DP3D_NP1);
+    int elem_bad_levels = 0;
+    Kokkos::parallel_reduce(Kokkos::TeamThreadRange(kv.team, NP * NP),
+                            [&](const int idx, int &bad_levels) {
+      const int igp = idx / NP;
+      const int jgp = idx % NP;
+      int gp_bad_levels = 0;
+      if (m_data.compute_diagonstics) {
+        Dp3dNp1Values gp_values;
+        Kokkos::parallel_reduce(Kokkos::ThreadVectorRange(kv.team, NUM_LEV),
+                                [&](const int &ilev, Dp3dNp1Values &values) {
+          const Scalar dp3d_np1 =
+              compute_dp3d_np1_pack<HAS_VERTICAL_FLUX>(kv, igp, jgp, ilev);
+          values.num_bad_levels += count_nonpositive_levels(ilev, dp3d_np1);
+          accumulate_diagnostics(kv, igp, jgp, ilev, dp3d_np1,
+                                 values.diagnostics);
+        }, gp_values);
+        Kokkos::single(Kokkos::PerThread(kv.team), [&]() {
+          for (int idiag = 0; idiag < Diagnostics::NUM_DIAGNOSTICS; ++idiag) {
+            m_diagnostics.m_gp_values(kv.ie, igp, jgp, idiag) =
+                gp_values.diagnostics.value[idiag];
+          }
+        });
+        gp_bad_levels = gp_values.num_bad_levels;
+      } else {
+        Kokkos::parallel_reduce(Kokkos::ThreadVectorRange(kv.team, NUM_LEV),
+                                [&](const int &ilev, int &num_bad_levels) {
+          const Scalar dp3d_np1 =
+              compute_dp3d_np1_pack<HAS_VERTICAL_FLUX>(kv, igp, jgp, ilev);
+          num_bad_levels += count_nonpositive_levels(ilev, dp3d_np1);
+        }, gp_bad_levels);
+      }
+      bad_levels += gp_bad_levels;
+    }, elem_bad_levels);
+
+    Kokkos::single(Kokkos::PerTeam(kv.team), [&]() {
+      m_elements.m_dp3d_num_bad_levels(kv.ie) = elem_bad_levels;
+      if (elem_bad_levels > 0) {
+        // Only offending elements touch the shared counter
+        Kokkos::atomic_add(&m_elements.m_dp3d_num_bad_elems(), 1);
+      }
+    });
+
+    if (m_data.compute_diagonstics) {
+      // The values of all the gauss points must be in m_gp_values
+      kv.team_barrier();
+      reduce_diagnostics(kv);
+    }
+    stop_perf_region(COMPUTE_DP3D_NP1);
+  } // TESTED 12
+
+  // Min-reduces the lanes of the pack, and only counts the offending lanes if
+  // the minimum is not positive. Lanes past the last physical level are
+  // ignored
+  KOKKOS_INLINE_FUNCTION
+  int count_nonpositive_levels(const int ilev, const Scalar &dp3d) const {
+    const int num_lanes = (ilev == NUM_LEV - 1
+                               ? NUM_PHYSICAL_LEV - ilev * VECTOR_SIZE
+                               : VECTOR_SIZE);
+    Real min_dp3d = dp3d[0];
+    for (int iv = 1; iv < num_lanes; ++iv) {
+      min_dp3d = (dp3d[iv] < min_dp3d ? dp3d[iv] : min_dp3d);
+    }
+    if (min_dp3d > 0.0) {
+      return 0;
+    }
+    int num_bad = 0;
+    for (int iv = 0; iv < num_lanes; ++iv) {
+      num_bad += (dp3d[iv] > 0.0 ? 0 : 1);
+    }
+    return num_bad;
+  }
+
+  template <bool HAS_VERTICAL_FLUX = true>
+  KOKKOS_INLINE_FUNCTION
+  Scalar compute_dp3d_np1_pack(KernelVariables &kv, const int igp,
+                               const int jgp, const int ilev) const {
+    Scalar tmp;
+    if (HAS_VERTICAL_FLUX) {
+      tmp = next_levels(Kokkos::subview(m_elements.m_eta_dot_dpdn, kv.ie, igp,
+                                        jgp, ALL),
+                        ilev, NUM_INTERFACE_LEV);
+      // Add div_vdp before subtracting the previous value to eta_dot_dpdn
+      // This will hopefully reduce numeric error
+      tmp += m_elements.buffers.div_vdp(kv.ibuf, igp, jgp, ilev);
+      tmp -= m_elements.m_eta_dot_dpdn(kv.ie, igp, jgp, ilev);
+    } else {
+      tmp = m_elements.buffers.div_vdp(kv.ibuf, igp, jgp, ilev);
+    }
+    tmp = m_elements.m_dp3d(kv.ie, m_data.nm1, igp, jgp, ilev) -
+          tmp * m_data.dt;
+
+    const Scalar dp3d_np1 = m_elements.m_spheremp(kv.ie, igp, jgp) * tmp;
+    m_elements.m_dp3d(kv.ie, m_data.np1, igp, jgp, ilev) = dp3d_np1;
+    return dp3d_np1;
+  }
+
+  // Depends on U, V, T at np1, which have been computed by this team
+  // Lanes past the last physical level are not accumulated
+  KOKKOS_INLINE_FUNCTION
+  void accumulate_diagnostics(KernelVariables &kv, const int igp,
+                              const int jgp, const int ilev,
+                              const Scalar &dp3d_np1,
+                              Diagnostics::Values &values) const {
+    const Scalar &u = m_elements.m_u(kv.ie, m_data.np1, igp, jgp, ilev);
+    const Scalar &v = m_elements.m_v(kv.ie, m_data.np1, igp, jgp, ilev);
+    const Scalar &t = m_elements.m_t(kv.ie, m_data.np1, igp, jgp, ilev);
+
+    const Scalar v_sq = u * u + v * v;
+    const Scalar energy =
+        dp3d_np1 * (0.5 * v_sq + PhysicalConstants::cp * t);
+
+    const int num_lanes = (ilev == NUM_LEV - 1
+                               ? NUM_PHYSICAL_LEV - ilev * VECTOR_SIZE
+                               : VECTOR_SIZE);
+    for (int iv = 0; iv < num_lanes; ++iv) {
+      values.value[Diagnostics::V_NORM_SQ] += v_sq[iv];
+      values.value[Diagnostics::T_NORM_SQ] += t[iv] * t[iv];
+      values.value[Diagnostics::DP_NORM_SQ] += dp3d_np1[iv] * dp3d_np1[iv];
+      values.value[Diagnostics::MASS] += dp3d_np1[iv];
+      values.value[Diagnostics::ENERGY] += energy[iv];
+    }
+  }
+
+  // Sums the gauss point contributions of this element in a fixed order
+  KOKKOS_INLINE_FUNCTION
+  void reduce_diagnostics(KernelVariables &kv) const {
+    Kokkos::single(Kokkos::PerTeam(kv.team), [&]() {
+      for (int idiag = 0; idiag < Diagnostics::NUM_DIAGNOSTICS; ++idiag) {
+        Real sum = 0.0;
+        for (int igp = 0; igp < NP; ++igp) {
+          for (int jgp = 0; jgp < NP; ++jgp) {
+            sum += m_diagnostics.m_gp_values(kv.ie, igp, jgp, idiag);
+          }
+        }
+        m_diagnostics.m_elem_values(kv.ie, idiag) = sum;
+      }
+    });
+    kv.team_barrier();
+  }
+
+  // Lane i of the result is level ilev * VECTOR_SIZE + i + 1 of column.
+  // Where that is past the last of the num_levels levels, lane i is level
+  // ilev * VECTOR_SIZE + i instead
+  template <typename ColumnType>
+  KOKKOS_INLINE_FUNCTION static Scalar
+  next_levels(const ColumnType &column, const int ilev, const int num_levels) {
+    Scalar next = column(ilev);
+    next.shift_left(1);
+    const int last_lane = num_levels - 1 - ilev * VECTOR_SIZE;
+    if (last_lane >= VECTOR_SIZE) {
+      next[VECTOR_SIZE - 1] = column(ilev + 1)[0];
+    } else {
+      for (int iv = last_lane; iv < VECTOR_SIZE; ++iv) {
+        next[iv] = column(ilev)[iv];
+      }
+    }
+    return next;
+  }
+
+  // Lane i of the result is level ilev * VECTOR_SIZE + i - 1 of column.
+  // Lane 0 of the first pack is level 0 instead
+  template <typename ColumnType>
+  KOKKOS_INLINE_FUNCTION static Scalar previous_levels(const ColumnType &column,
+                                                       const int ilev) {
+    Scalar previous = column(ilev);
+    previous.shift_right(1);
+    previous[0] = (ilev > 0 ? column(ilev - 1)[VECTOR_SIZE - 1]
+                            : column(0)[0]);
+    return previous;
+  }
+
+  // Depends on T, U, V, DP3D at n0, ETA_DPDN
+  // Modifies t_vadv, v_vadv
+  // Computes the vertical advection of T and v. The neighbours of the levels
+  // of a pack are built with lane shifts, so the levels can be threaded over.
+  // At the top and bottom, the missing neighbour is replaced by the level
+  // itself, which is consistent with eta_dot_dpdn being zero there
+  KOKKOS_INLINE_FUNCTION
+  void preq_vertadv(KernelVariables &kv) const {
     Kokkos::parallel_for(Kokkos::TeamThreadRange(kv.team, NP * NP),
                          [&](const int idx) {
       const int igp = idx / NP;
       const int jgp = idx % NP;
-      Kokkos::parallel_for(Kokkos::ThreadVectorRange(kv.team, NUM_LEV), [&] (const int& ilev) {
-        Scalar tmp = m_elements.m_eta_dot_dpdn(kv.ie, igp, jgp, ilev);
-        tmp.shift_left(1);
-        tmp[VECTOR_SIZE - 1] =
-            m_elements.m_eta_dot_dpdn(kv.ie, igp, jgp, ilev + 1)[0];
-        // Add div_vdp before subtracting the previous value to eta_dot_dpdn
-        // This will hopefully reduce numeric error
-        tmp += m_elements.buffers.div_vdp(kv.ie, igp, jgp, ilev);
-        tmp -= m_elements.m_eta_dot_dpdn(kv.ie, igp, jgp, ilev);
-        tmp = m_elements.m_dp3d(kv.ie, m_data.nm1, igp, jgp, ilev) -
-              tmp * m_data.dt;
-
-        m_elements.m_dp3d(kv.ie, m_data.np1, igp, jgp, ilev) =
-            m_elements.m_spheremp(kv.ie, igp, jgp) * tmp;
+      const auto eta_dot_dpdn =
+          Kokkos::subview(m_elements.m_eta_dot_dpdn, kv.ie, igp, jgp, ALL);
+      const auto t =
+          Kokkos::subview(m_elements.m_t, kv.ie, m_data.n0, igp, jgp, ALL);
+      const auto u =
+          Kokkos::subview(m_elements.m_u, kv.ie, m_data.n0, igp, jgp, ALL);
+      const auto v =
+          Kokkos::subview(m_elements.m_v, kv.ie, m_data.n0, igp, jgp, ALL);
+      Kokkos::parallel_for(Kokkos::ThreadVectorRange(kv.team, NUM_LEV),
+                           [&](const int &ilev) {
+        Scalar dp = m_elements.m_dp3d(kv.ie, m_data.n0, igp, jgp, ilev);
+        if (ilev == NUM_LEV - 1) {
+          // The padding is not initialized, keep it from dividing by zero
+          for (int iv = NUM_PHYSICAL_LEV - ilev * VECTOR_SIZE;
+               iv < VECTOR_SIZE; ++iv) {
+            dp[iv] = 1;
+          }
+        }
+        const Scalar half_rdp = 0.5 / dp;
+        // eta_dot_dpdn above (facm) and below (facp) the levels
+        const Scalar facm = half_rdp * eta_dot_dpdn(ilev);
+        const Scalar facp =
+            half_rdp * next_levels(eta_dot_dpdn, ilev, NUM_INTERFACE_LEV);
+
+        m_elements.buffers.t_vadv(kv.ibuf, igp, jgp, ilev) =
+            facp * (next_levels(t, ilev, NUM_PHYSICAL_LEV) - t(ilev)) +
+            facm * (t(ilev) - previous_levels(t, ilev));
+        m_elements.buffers.v_vadv(kv.ibuf, 0, igp, jgp, ilev) =
+            facp * (next_levels(u, ilev, NUM_PHYSICAL_LEV) - u(ilev)) +
+            facm * (u(ilev) - previous_levels(u, ilev));
+        m_elements.buffers.v_vadv(kv.ibuf, 1, igp, jgp, ilev) =
+            facp * (next_levels(v, ilev, NUM_PHYSICAL_LEV) - v(ilev)) +
+            facm * (v(ilev) - previous_levels(v, ilev));
       });
     });
     kv.team_barrier();
-  } // TESTED 12
+  } // UNTESTED 13
 
-  // Computes the vertical advection of T and v
-  // Not currently used
-  KOKKOS_INLINE_FUNCTION
-  void preq_vertadv(
-      const TeamMember &,
-      const ExecViewUnmanaged<const Scalar[NUM_LEV][NP][NP]> T,
-      const ExecViewUnmanaged<const Scalar[NUM_LEV][2][NP][NP]> v,
-      const ExecViewUnmanaged<const Scalar[NUM_LEV_P][NP][NP]> eta_dp_deta,
-      const ExecViewUnmanaged<const Scalar[NUM_LEV][NP][NP]> rpdel,
-      ExecViewUnmanaged<Scalar[NUM_LEV][NP][NP]> T_vadv,
-      ExecViewUnmanaged<Scalar[NUM_LEV][2][NP][NP]> v_vadv) {
-    constexpr const int k_0 = 0;
-    for (int j = 0; j < NP; ++j) {
-      for (int i = 0; i < NP; ++i) {
-        Scalar facp = 0.5 * rpdel(k_0, j, i) * eta_dp_deta(k_0 + 1, j, i);
-        T_vadv(k_0, j, i) = facp * (T(k_0 + 1, j, i) - T(k_0, j, i));
-        for (int h = 0; h < 2; ++h) {
-          v_vadv(k_0, h, j, i) = facp * (v(k_0 + 1, h, j, i) - v(k_0, h, j, i));
-        }
-      }
+  // Runs the steps of a launch: one, or m_persistent_steps separated by
+  // grid_barrier. The persistent steps run on chunks, with the static
+  // schedule
+  template <typename Functor>
+  KOKKOS_INLINE_FUNCTION static void run_phases(const Functor &functor,
+                                                const TeamMember &team) {
+    if (functor.m_persistent_steps <= 0) {
+      run_step(functor, team);
+      return;
     }
-    constexpr const int k_f = NUM_LEV - 1;
-    for (int k = k_0 + 1; k < k_f; ++k) {
-      for (int j = 0; j < NP; ++j) {
-        for (int i = 0; i < NP; ++i) {
-          Scalar facp = 0.5 * rpdel(k, j, i) * eta_dp_deta(k + 1, j, i);
-          Scalar facm = 0.5 * rpdel(k, j, i) * eta_dp_deta(k, j, i);
-          T_vadv(k, j, i) = facp * (T(k + 1, j, i) - T(k, j, i)) +
-                            facm * (T(k, j, i) - T(k - 1, j, i));
-          for (int h = 0; h < 2; ++h) {
-            v_vadv(k, h, j, i) = facp * (v(k + 1, h, j, i) - v(k, h, j, i)) +
-                                 facm * (v(k, h, j, i) - v(k - 1, h, j, i));
+    assert(functor.m_chunk_elems > 0 && !functor.m_dynamic_schedule);
+    for (int step = 0; step < functor.m_persistent_steps; ++step) {
+      run_step(functor, team);
+      functor.grid_barrier(team, step);
+    }
+  }
+
+  // Runs the phases of a CAAR step. Without chunks, each team runs all the
+  // phases on one element. With chunks of m_chunk_elems consecutive
+  // elements, each team takes a contiguous range of chunks, and runs each
+  // phase on the whole chunk before the next phase, so that the buffers of
+  // the chunk stay in cache. Team t uses the slots t * m_chunk_elems, ... of
+  // the buffers, which must have league_size * m_chunk_elems slots.
+  // Functor is the (specialized) functor whose phases are called
+  template <typename Functor>
+  KOKKOS_INLINE_FUNCTION static void run_step(const Functor &functor,
+                                              const TeamMember &team) {
+    start_hot_timer(CAAR_COMPUTE);
+    if (functor.m_chunk_elems <= 0) {
+      KernelVariables kv(team, functor.element_index(team.league_rank()));
+
+      start_hot_timer(CAAR_TEMPERATURE_DIV_VDP);
+      double start = functor.m_trace.start();
+      functor.compute_temperature_div_vdp(kv);
+      functor.m_trace.record(team, Trace::TEMPERATURE_DIV_VDP, kv.ie, start);
+      kv.team.team_barrier();
+      stop_hot_timer(CAAR_TEMPERATURE_DIV_VDP);
+
+      start_hot_timer(CAAR_SCAN);
+      start = functor.m_trace.start();
+      for (int rep = functor.element_cost(kv.ie); rep > 0; --rep) {
+        functor.compute_scan_properties(kv);
+        kv.team.team_barrier();
+      }
+      functor.m_trace.record(team, Trace::SCAN, kv.ie, start);
+      stop_hot_timer(CAAR_SCAN);
+
+      start_hot_timer(CAAR_PHASE_3);
+      start = functor.m_trace.start();
+      functor.compute_phase_3(kv);
+      functor.m_trace.record(team, Trace::PHASE_3, kv.ie, start);
+      stop_hot_timer(CAAR_PHASE_3);
+    } else {
+      const int chunk = functor.m_chunk_elems;
+      const int first_slot = team.league_rank() * chunk;
+      assert(team.league_size() * chunk <=
+             functor.m_elements.buffers.pressure.extent_int(0));
+
+      const int num_elems = functor.num_league_elements();
+      const int num_chunks = (num_elems + chunk - 1) / chunk;
+      // With the static schedule, each team runs a contiguous range of
+      // chunks. With the dynamic one, the teams take the next chunk of the
+      // league until there is none left, so that the teams with cheap
+      // elements take more of them
+      int ichunk, last_chunk;
+      if (functor.m_dynamic_schedule) {
+        ichunk = functor.take_chunk(team);
+        last_chunk = num_chunks;
+      } else {
+        const int team_chunks =
+            (num_chunks + team.league_size() - 1) / team.league_size();
+        ichunk = team.league_rank() * team_chunks;
+        last_chunk = (ichunk + team_chunks < num_chunks ? ichunk + team_chunks
+                                                        : num_chunks);
+      }
+      while (ichunk < last_chunk) {
+        const double start = kernel_seconds();
+        const int first = ichunk * chunk;
+        const int last = (first + chunk < num_elems ? first + chunk : num_elems);
+        start_hot_timer(CAAR_TEMPERATURE_DIV_VDP);
+        for (int ipos = first; ipos < last; ++ipos) {
+          KernelVariables kv(team, functor.element_index(ipos),
+                             first_slot + ipos - first);
+          const double phase_start = functor.m_trace.start();
+          functor.compute_temperature_div_vdp(kv);
+          functor.m_trace.record(team, Trace::TEMPERATURE_DIV_VDP, kv.ie,
+                                 phase_start);
+        }
+        team.team_barrier();
+        stop_hot_timer(CAAR_TEMPERATURE_DIV_VDP);
+        start_hot_timer(CAAR_SCAN);
+        for (int ipos = first; ipos < last; ++ipos) {
+          KernelVariables kv(team, functor.element_index(ipos),
+                             first_slot + ipos - first);
+          const double phase_start = functor.m_trace.start();
+          for (int rep = functor.element_cost(kv.ie); rep > 0; --rep) {
+            functor.compute_scan_properties(kv);
+            team.team_barrier();
           }
+          functor.m_trace.record(team, Trace::SCAN, kv.ie, phase_start);
+        }
+        team.team_barrier();
+        stop_hot_timer(CAAR_SCAN);
+        start_hot_timer(CAAR_PHASE_3);
+        for (int ipos = first; ipos < last; ++ipos) {
+          KernelVariables kv(team, functor.element_index(ipos),
+                             first_slot + ipos - first);
+          const double phase_start = functor.m_trace.start();
+          functor.compute_phase_3(kv);
+          functor.m_trace.record(team, Trace::PHASE_3, kv.ie, phase_start);
         }
+        team.team_barrier();
+        stop_hot_timer(CAAR_PHASE_3);
+        functor.m_team_times.add_chunk(team, start, last - first);
+
+        ichunk = (functor.m_dynamic_schedule ? functor.take_chunk(team)
+                                             : ichunk + 1);
       }
     }
-    for (int j = 0; j < NP; ++j) {
-      for (int i = 0; i < NP; ++i) {
-        Scalar facm = 0.5 * rpdel(k_f, j, i) * eta_dp_deta(k_f, j, i);
-        T_vadv(k_f, j, i) = facm * (T(k_f, j, i) - T(k_f - 1, j, i));
-        for (int h = 0; h < 2; ++h) {
-          v_vadv(k_f, h, j, i) = facm * (v(k_f, h, j, i) - v(k_f - 1, h, j, i));
-        }
+    stop_hot_timer(CAAR_COMPUTE);
+  }
+
+  // Waits for all the teams of the league to be done with step. All the
+  // teams must be resident at the same time, as with the leagues of at most
+  // one team per concurrent chunk of caar_policy on the host backends. Nothing
+  // guarantees it on CUDA, so the persistent launches are only run when
+  // EXEC_SPACE_IS_HOST
+  KOKKOS_INLINE_FUNCTION
+  void grid_barrier(const TeamMember &team, const int step) const {
+    team.team_barrier();
+    Kokkos::single(Kokkos::PerTeam(team), [&]() {
+      Kokkos::atomic_fetch_add(&m_step_arrivals(), 1);
+      const int target = (step + 1) * team.league_size();
+      volatile int *const arrivals = &m_step_arrivals();
+      while (*arrivals < target) {
+        // Spin
+      }
+      Kokkos::memory_fence();
+      if (team.league_rank() == 0) {
+        m_step_end_times(step) = kernel_seconds();
       }
+    });
+    team.team_barrier();
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const TeamMember &team) const { run_phases(*this, team); }
+
+  // Restricts the functor to the elements in elem_ids, with a league of
+  // elem_ids.extent(0) teams. An empty view selects all the elements again
+  void set_elements(const ExecViewManaged<int *> &elem_ids) {
+    m_elem_ids = elem_ids;
+  }
+
+  // Runs the phases on chunks of chunk_elems elements, or on one element per
+  // team if chunk_elems is 0. See run_step
+  void set_element_chunks(const int chunk_elems) {
+    m_chunk_elems = chunk_elems;
+  }
+
+  void set_level_chunks(const int level_chunks) {
+    m_level_chunks = level_chunks;
+  }
+
+  // Hands the chunks of elements to the teams as they become free. Only
+  // applies when running on chunks
+  void set_dynamic_schedule(const bool dynamic_schedule) {
+    m_dynamic_schedule = dynamic_schedule;
+    if (dynamic_schedule) {
+      m_next_chunk = ExecViewManaged<int>("Next chunk of elements");
     }
-  } // UNTESTED 13
+  }
+
+  // Runs num_steps steps per launch, with the threads kept resident between
+  // the steps. 0 runs a single step
+  void set_persistent_steps(const int num_steps) {
+    m_persistent_steps = num_steps;
+    if (num_steps > 0) {
+      m_step_arrivals = ExecViewManaged<int>("Teams done with the steps");
+      m_step_end_times =
+          ExecViewManaged<double *>("End time of the steps", num_steps);
+    }
+  }
 
+  // Must be called before each launch with the dynamic schedule or with
+  // persistent steps
+  void reset_schedule() const {
+    if (m_dynamic_schedule) {
+      Kokkos::deep_copy(m_next_chunk, 0);
+    }
+    if (m_persistent_steps > 0) {
+      Kokkos::deep_copy(m_step_arrivals, 0);
+    }
+  }
+
+  void set_element_costs(const ExecViewManaged<int *> &elem_costs) {
+    m_elem_costs = elem_costs;
+  }
+
+  void set_team_times(const LoadBalance::TeamTimes &team_times) {
+    m_team_times = team_times;
+  }
+
+  void set_trace(const Trace &trace) { m_trace = trace; }
+
+  void set_fused_scan(const bool fused_scan) { m_fused_scan = fused_scan; }
+
+  // The next chunk of the league, the same on all the threads of the team
   KOKKOS_INLINE_FUNCTION
-  void operator()(const TeamMember &team) const {
-    start_timer("caar compute");
-    KernelVariables kv(team);
+  int take_chunk(const TeamMember &team) const {
+    int ichunk;
+    Kokkos::single(Kokkos::PerTeam(team), [&](int &value) {
+      value = Kokkos::atomic_fetch_add(&m_next_chunk(), 1);
+    }, ichunk);
+    return ichunk;
+  }
 
-    compute_temperature_div_vdp(kv);
-    kv.team.team_barrier();
+  KOKKOS_INLINE_FUNCTION
+  int element_cost(const int ie) const {
+    return (m_elem_costs.extent_int(0) > 0 ? m_elem_costs(ie) : 1);
+  }
 
-    compute_scan_properties(kv);
-    kv.team.team_barrier();
+  // The element at position ipos of the league
+  KOKKOS_INLINE_FUNCTION
+  int element_index(const int ipos) const {
+    return (m_elem_ids.extent_int(0) > 0 ? m_elem_ids(ipos) : ipos);
+  }
 
-    compute_phase_3(kv);
-    stop_timer("caar compute");
+  KOKKOS_INLINE_FUNCTION
+  int num_league_elements() const {
+    return (m_elem_ids.extent_int(0) > 0 ? m_elem_ids.extent_int(0)
+                                         : m_elements.m_u.extent_int(0));
   }
 
   KOKKOS_INLINE_FUNCTION
@@ -567,6 +1170,40 @@ struct CaarFunctor {
   }
 };
 
+// CaarFunctor specialized on the vertical coordinate (rsplit == 0 means
+// eulerian vertical, with a vertical flux eta_dot_dpdn) and on the presence
+// of tracers. The sweeps and branches which do not apply to a configuration
+// are removed at compile time:
+//  - without tracers T_v = T, and qdp is never read
+//  - with rsplit > 0, eta_dot_dpdn is zero: it is not zeroed at every step
+//    (the driver zeroes it once), and compute_dp3d_np1 does not read it
+template <bool RSPLIT_ZERO, bool HAS_TRACERS>
+struct CaarFunctorImpl : public CaarFunctor {
+
+  CaarFunctorImpl(const CaarFunctor &functor) : CaarFunctor(functor) {
+    assert((m_data.rsplit == 0) == RSPLIT_ZERO);
+    assert((m_data.qn0 != -1) == HAS_TRACERS);
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  void compute_temperature_div_vdp(KernelVariables &kv) const {
+    if (HAS_TRACERS) {
+      compute_temperature_tracers_helper(kv);
+    } else {
+      compute_temperature_no_tracers_helper(kv);
+    }
+    compute_div_vdp(kv);
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  void compute_phase_3(KernelVariables &kv) const {
+    compute_phase_3_impl<RSPLIT_ZERO>(kv);
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const TeamMember &team) const { run_phases(*this, team); }
+};
+
 } // Namespace Homme
 
 #endif // CAAR_FUNCTOR_HPP
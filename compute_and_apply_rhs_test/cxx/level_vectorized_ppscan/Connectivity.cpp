@@ -0,0 +1,228 @@
+#include "Connectivity.hpp"
+#include "CubedSphere.hpp"
+
+#include <array>
+#include <cassert>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace Homme {
+
+void Connectivity::allocate(const int num_elems) {
+  m_num_elems = num_elems;
+  m_neighbor_elem = ExecViewManaged<int * [NUM_DIRECTIONS]>(
+      "Neighbouring element in each direction", m_num_elems);
+  m_neighbor_dir = ExecViewManaged<int * [NUM_DIRECTIONS]>(
+      "Direction as seen from the neighbour", m_num_elems);
+  m_reversed = ExecViewManaged<int * [NUM_DIRECTIONS]>(
+      "Reversed edge connections", m_num_elems);
+  m_rank = ExecViewManaged<int *>("Rank owning each element", m_num_elems);
+}
+
+void Connectivity::init_periodic_plane(const int ne, const int num_ranks) {
+  assert(ne > 0 && num_ranks > 0 && num_ranks <= ne * ne);
+  allocate(ne * ne);
+
+  ExecViewManaged<int * [NUM_DIRECTIONS]>::HostMirror h_neighbor_elem =
+      Kokkos::create_mirror_view(m_neighbor_elem);
+  ExecViewManaged<int * [NUM_DIRECTIONS]>::HostMirror h_neighbor_dir =
+      Kokkos::create_mirror_view(m_neighbor_dir);
+  ExecViewManaged<int * [NUM_DIRECTIONS]>::HostMirror h_reversed =
+      Kokkos::create_mirror_view(m_reversed);
+
+  // The offset of the neighbour in each direction, and the direction of this
+  // element as seen from it
+  constexpr int offset_x[NUM_DIRECTIONS] = { -1, 1, 0, 0, -1, 1, -1, 1 };
+  constexpr int offset_y[NUM_DIRECTIONS] = { 0, 0, -1, 1, -1, -1, 1, 1 };
+  constexpr int opposite[NUM_DIRECTIONS] = { EAST,  WEST,  NORTH, SOUTH,
+                                             NEAST, NWEST, SEAST, SWEST };
+
+  for (int ey = 0; ey < ne; ++ey) {
+    for (int ex = 0; ex < ne; ++ex) {
+      const int ie = ey * ne + ex;
+      for (int dir = 0; dir < NUM_DIRECTIONS; ++dir) {
+        const int nx = (ex + offset_x[dir] + ne) % ne;
+        const int ny = (ey + offset_y[dir] + ne) % ne;
+        h_neighbor_elem(ie, dir) = ny * ne + nx;
+        h_neighbor_dir(ie, dir) = opposite[dir];
+        h_reversed(ie, dir) = 0;
+      }
+    }
+  }
+
+  Kokkos::deep_copy(m_neighbor_elem, h_neighbor_elem);
+  Kokkos::deep_copy(m_neighbor_dir, h_neighbor_dir);
+  Kokkos::deep_copy(m_reversed, h_reversed);
+  assign_ranks(num_ranks);
+}
+
+void Connectivity::init_cubed_sphere(const int ne, const int num_ranks) {
+  const CubedSphere mesh(ne);
+  assert(num_ranks > 0 && num_ranks <= mesh.num_elems());
+  allocate(mesh.num_elems());
+
+  ExecViewManaged<int * [NUM_DIRECTIONS]>::HostMirror h_neighbor_elem =
+      Kokkos::create_mirror_view(m_neighbor_elem);
+  ExecViewManaged<int * [NUM_DIRECTIONS]>::HostMirror h_neighbor_dir =
+      Kokkos::create_mirror_view(m_neighbor_dir);
+  ExecViewManaged<int * [NUM_DIRECTIONS]>::HostMirror h_reversed =
+      Kokkos::create_mirror_view(m_reversed);
+
+  // The vertices (ivertex, jvertex) at the ends of each edge, in the order
+  // of its points, and at each corner
+  constexpr int edge_vertices[NUM_EDGES][2][2] = {
+    { { 0, 0 }, { 0, 1 } }, { { 1, 0 }, { 1, 1 } },
+    { { 0, 0 }, { 1, 0 } }, { { 0, 1 }, { 1, 1 } }
+  };
+  constexpr int corner_vertices[NUM_CORNERS][2] = {
+    { 0, 0 }, { 1, 0 }, { 0, 1 }, { 1, 1 }
+  };
+
+  // The elements are glued by matching their vertices, which have exact
+  // integer coordinates on the cube
+  using Vertex = std::array<int, 3>;
+  using ElemDir = std::pair<int, int>;
+  std::map<std::pair<Vertex, Vertex>, std::vector<ElemDir> > edges;
+  std::map<Vertex, std::vector<ElemDir> > corners;
+  std::vector<std::array<Vertex, 2> > edge_ends(mesh.num_elems() * NUM_EDGES);
+
+  for (int ie = 0; ie < m_num_elems; ++ie) {
+    for (int edge = 0; edge < NUM_EDGES; ++edge) {
+      std::array<Vertex, 2> &ends = edge_ends[ie * NUM_EDGES + edge];
+      for (int iend = 0; iend < 2; ++iend) {
+        mesh.vertex(ie, edge_vertices[edge][iend][0],
+                    edge_vertices[edge][iend][1], ends[iend].data());
+      }
+      edges[std::minmax(ends[0], ends[1])].push_back(ElemDir(ie, edge));
+    }
+    for (int corner = 0; corner < NUM_CORNERS; ++corner) {
+      Vertex v;
+      mesh.vertex(ie, corner_vertices[corner][0], corner_vertices[corner][1],
+                  v.data());
+      corners[v].push_back(ElemDir(ie, NUM_EDGES + corner));
+    }
+  }
+
+  for (int ie = 0; ie < m_num_elems; ++ie) {
+    for (int dir = 0; dir < NUM_DIRECTIONS; ++dir) {
+      h_neighbor_elem(ie, dir) = -1;
+      h_neighbor_dir(ie, dir) = -1;
+      h_reversed(ie, dir) = 0;
+    }
+  }
+
+  for (const auto &edge : edges) {
+    assert(edge.second.size() == 2);
+    for (int iside = 0; iside < 2; ++iside) {
+      const ElemDir &self = edge.second[iside];
+      const ElemDir &other = edge.second[1 - iside];
+      h_neighbor_elem(self.first, self.second) = other.first;
+      h_neighbor_dir(self.first, self.second) = other.second;
+      h_reversed(self.first, self.second) =
+          (edge_ends[self.first * NUM_EDGES + self.second][0] !=
+           edge_ends[other.first * NUM_EDGES + other.second][0]);
+    }
+  }
+
+  // Four elements share a vertex, except at the vertices of the cube where
+  // there are three: the corner neighbour is the one which does not share
+  // an edge
+  for (const auto &corner : corners) {
+    assert(corner.second.size() == 3 || corner.second.size() == 4);
+    if (corner.second.size() != 4) {
+      continue;
+    }
+    for (const ElemDir &self : corner.second) {
+      for (const ElemDir &other : corner.second) {
+        bool is_edge_neighbor = (other.first == self.first);
+        for (int edge = 0; edge < NUM_EDGES; ++edge) {
+          is_edge_neighbor |= (h_neighbor_elem(self.first, edge) == other.first);
+        }
+        if (!is_edge_neighbor) {
+          h_neighbor_elem(self.first, self.second) = other.first;
+          h_neighbor_dir(self.first, self.second) = other.second;
+        }
+      }
+    }
+  }
+
+  Kokkos::deep_copy(m_neighbor_elem, h_neighbor_elem);
+  Kokkos::deep_copy(m_neighbor_dir, h_neighbor_dir);
+  Kokkos::deep_copy(m_reversed, h_reversed);
+  assign_ranks(num_ranks);
+}
+
+void Connectivity::permute(const std::vector<int> &new_to_old) {
+  assert(static_cast<int>(new_to_old.size()) == m_num_elems);
+
+  ExecViewManaged<int * [NUM_DIRECTIONS]>::HostMirror h_neighbor_elem =
+      Kokkos::create_mirror_view(m_neighbor_elem);
+  ExecViewManaged<int * [NUM_DIRECTIONS]>::HostMirror h_neighbor_dir =
+      Kokkos::create_mirror_view(m_neighbor_dir);
+  ExecViewManaged<int * [NUM_DIRECTIONS]>::HostMirror h_reversed =
+      Kokkos::create_mirror_view(m_reversed);
+  Kokkos::deep_copy(h_neighbor_elem, m_neighbor_elem);
+  Kokkos::deep_copy(h_neighbor_dir, m_neighbor_dir);
+  Kokkos::deep_copy(h_reversed, m_reversed);
+
+  std::vector<int> old_to_new(m_num_elems);
+  for (int ie = 0; ie < m_num_elems; ++ie) {
+    old_to_new[new_to_old[ie]] = ie;
+  }
+
+  // Fresh views, as the old ones are read while filling the new ones
+  const int num_ranks = m_num_ranks;
+  allocate(m_num_elems);
+  ExecViewManaged<int * [NUM_DIRECTIONS]>::HostMirror h_new_neighbor_elem =
+      Kokkos::create_mirror_view(m_neighbor_elem);
+  ExecViewManaged<int * [NUM_DIRECTIONS]>::HostMirror h_new_neighbor_dir =
+      Kokkos::create_mirror_view(m_neighbor_dir);
+  ExecViewManaged<int * [NUM_DIRECTIONS]>::HostMirror h_new_reversed =
+      Kokkos::create_mirror_view(m_reversed);
+  for (int ie = 0; ie < m_num_elems; ++ie) {
+    const int old_ie = new_to_old[ie];
+    for (int dir = 0; dir < NUM_DIRECTIONS; ++dir) {
+      const int neighbor = h_neighbor_elem(old_ie, dir);
+      h_new_neighbor_elem(ie, dir) = (neighbor < 0 ? -1 : old_to_new[neighbor]);
+      h_new_neighbor_dir(ie, dir) = h_neighbor_dir(old_ie, dir);
+      h_new_reversed(ie, dir) = h_reversed(old_ie, dir);
+    }
+  }
+  Kokkos::deep_copy(m_neighbor_elem, h_new_neighbor_elem);
+  Kokkos::deep_copy(m_neighbor_dir, h_new_neighbor_dir);
+  Kokkos::deep_copy(m_reversed, h_new_reversed);
+  assign_ranks(num_ranks);
+}
+
+void Connectivity::assign_ranks(const int num_ranks) {
+  m_num_ranks = num_ranks;
+  ExecViewManaged<int *>::HostMirror h_rank = Kokkos::create_mirror_view(m_rank);
+  for (int ie = 0; ie < m_num_elems; ++ie) {
+    // Contiguous, balanced ranges of elements
+    h_rank(ie) = static_cast<int>((static_cast<long>(ie) * m_num_ranks) /
+                                  m_num_elems);
+  }
+  Kokkos::deep_copy(m_rank, h_rank);
+}
+
+int Connectivity::num_remote_connections() const {
+  ExecViewManaged<int * [NUM_DIRECTIONS]>::HostMirror h_neighbor_elem =
+      Kokkos::create_mirror_view(m_neighbor_elem);
+  ExecViewManaged<int *>::HostMirror h_rank = Kokkos::create_mirror_view(m_rank);
+  Kokkos::deep_copy(h_neighbor_elem, m_neighbor_elem);
+  Kokkos::deep_copy(h_rank, m_rank);
+
+  int num_remote = 0;
+  for (int ie = 0; ie < m_num_elems; ++ie) {
+    for (int dir = 0; dir < NUM_DIRECTIONS; ++dir) {
+      const int neighbor = h_neighbor_elem(ie, dir);
+      if (neighbor >= 0 && h_rank(neighbor) != h_rank(ie)) {
+        ++num_remote;
+      }
+    }
+  }
+  return num_remote;
+}
+
+} // namespace Homme
@@ -0,0 +1,79 @@
+#ifndef HOMMEXX_CONNECTIVITY_HPP
+#define HOMMEXX_CONNECTIVITY_HPP
+
+#include "Types.hpp"
+
+#include <vector>
+
+namespace Homme {
+
+/* The neighbours of each element, as needed by the boundary exchange.
+ *
+ * Each element has up to one neighbour in each of the NUM_DIRECTIONS
+ * directions: the 4 edges and the 4 corners. The GLL points of an edge are
+ * ordered by increasing index along the edge, and an edge connection is
+ * reversed if the neighbour orders the shared points the other way around.
+ *
+ * Elements are also assigned to ranks. The ranks are emulated within this
+ * process, and only determine which connections go through messages in the
+ * BoundaryExchange.
+ */
+class Connectivity {
+public:
+  // With igp the first and jgp the second GLL index of an element, the WEST
+  // edge is igp = 0 and the SOUTH edge is jgp = 0
+  enum Direction : int {
+    WEST = 0,
+    EAST,
+    SOUTH,
+    NORTH,
+    SWEST,
+    SEAST,
+    NWEST,
+    NEAST,
+    NUM_DIRECTIONS
+  };
+
+  static constexpr int NUM_EDGES = 4;
+  static constexpr int NUM_CORNERS = 4;
+
+  Connectivity() = default;
+
+  // A doubly periodic mesh of ne x ne elements, numbered row by row, whose
+  // elements are split in num_ranks contiguous ranges
+  void init_periodic_plane(const int ne, const int num_ranks);
+  // The ne x ne x 6 elements of a CubedSphere, whose elements are split in
+  // num_ranks contiguous ranges. Edges between faces may be reversed, and
+  // the corners at the 8 vertices of the cube have no neighbour
+  void init_cubed_sphere(const int ne, const int num_ranks);
+
+  // Renumbers the elements as in Elements::permute, and assigns the ranks
+  // again, so that each rank gets a contiguous range of the new numbering
+  void permute(const std::vector<int> &new_to_old);
+
+  int num_elems() const { return m_num_elems; }
+  int num_ranks() const { return m_num_ranks; }
+
+  // Number of (element, direction) pairs whose neighbour is on another rank
+  int num_remote_connections() const;
+
+  // The neighbouring element in each direction, or -1 if there is none
+  ExecViewManaged<int * [NUM_DIRECTIONS]> m_neighbor_elem;
+  // The direction of this element as seen from the neighbour
+  ExecViewManaged<int * [NUM_DIRECTIONS]> m_neighbor_dir;
+  // 1 if the neighbour orders the points of the shared edge the other way
+  ExecViewManaged<int * [NUM_DIRECTIONS]> m_reversed;
+  // The rank owning each element
+  ExecViewManaged<int *> m_rank;
+
+private:
+  void allocate(const int num_elems);
+  void assign_ranks(const int num_ranks);
+
+  int m_num_elems;
+  int m_num_ranks;
+};
+
+} // namespace Homme
+
+#endif // HOMMEXX_CONNECTIVITY_HPP
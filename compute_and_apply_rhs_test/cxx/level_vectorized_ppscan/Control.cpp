@@ -7,7 +7,8 @@ void Control::init(const int nets_in, const int nete_in,
                    const int n0_in, const int np1_in, const int qn0_in,
                    const Real dt_in, const Real ps0_in,
                    const bool compute_diagonstics_in,
-                   const Real eta_ave_w_in, CRCPtr hybrid_a_ptr) {
+                   const Real eta_ave_w_in, CRCPtr hybrid_a_ptr,
+                   CRCPtr hybrid_b_ptr) {
   nets = nets_in;
   nete = nete_in;
   num_elems = num_elems_in;
@@ -24,6 +25,16 @@ void Control::init(const int nets_in, const int nete_in,
 
   HostViewUnmanaged<const Real[NUM_LEV_P]> host_hybrid_a(hybrid_a_ptr);
   Kokkos::deep_copy(hybrid_a, host_hybrid_a);
+
+  hybrid_b = ExecViewManaged<Scalar[NUM_LEV_P]>(
+      "Hybrid coordinates at the interfaces; multiply the surface pressure");
+  ExecViewManaged<Scalar[NUM_LEV_P]>::HostMirror host_hybrid_b =
+      Kokkos::create_mirror_view(hybrid_b);
+  for (int ilevel = 0; ilevel < NUM_INTERFACE_LEV; ++ilevel) {
+    host_hybrid_b(ilevel / VECTOR_SIZE)[ilevel % VECTOR_SIZE] =
+        hybrid_b_ptr[ilevel];
+  }
+  Kokkos::deep_copy(hybrid_b, host_hybrid_b);
 }
 
 Control &get_control() {
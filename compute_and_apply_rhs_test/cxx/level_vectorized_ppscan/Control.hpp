@@ -14,7 +14,7 @@ struct Control {
              const int nm1,  const int n0,   const int np1,
              const int qn0,  const Real dt2, const Real ps0,
              const bool compute_diagonstics, const Real eta_ave_w,
-             CRCPtr hybrid_a_ptr);
+             CRCPtr hybrid_a_ptr, CRCPtr hybrid_b_ptr);
 
   // Range of element indices to be handled by this thread is [nets,nete)
   int nets;
@@ -50,6 +50,10 @@ struct Control {
 
   // hybryd a
   ExecViewManaged<Real[NUM_LEV_P]> hybrid_a;
+
+  // hybrid b at the interfaces, packed like eta_dot_dpdn.
+  // Only used when rsplit == 0
+  ExecViewManaged<Scalar[NUM_LEV_P]> hybrid_b;
 };
 
 Control& get_control ();
@@ -0,0 +1,185 @@
+#include "CubedSphere.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace Homme {
+
+namespace {
+
+// The outward normal c of each face, and the directions a and b of alpha
+// and beta, with a x b = c
+constexpr int face_c[CubedSphere::NUM_FACES][3] = {
+  { 1, 0, 0 }, { 0, 1, 0 }, { -1, 0, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 }
+};
+constexpr int face_a[CubedSphere::NUM_FACES][3] = {
+  { 0, 1, 0 }, { -1, 0, 0 }, { 0, -1, 0 }, { 1, 0, 0 }, { 0, 1, 0 }, { 0, 1, 0 }
+};
+constexpr int face_b[CubedSphere::NUM_FACES][3] = {
+  { 0, 0, 1 }, { 0, 0, 1 }, { 0, 0, 1 }, { 0, 0, 1 }, { -1, 0, 0 }, { 1, 0, 0 }
+};
+
+constexpr Real pi = 3.14159265358979323846;
+
+// Each face shares an edge with the next one
+constexpr int face_order[CubedSphere::NUM_FACES] = { 4, 0, 1, 2, 3, 5 };
+
+// The cell at distance d along the Hilbert curve of an n x n grid, with n a
+// power of 2
+void hilbert_cell(const int n, const int d, int &x, int &y) {
+  x = y = 0;
+  for (int s = 1, t = d; s < n; s *= 2, t /= 4) {
+    const int rx = 1 & (t / 2);
+    const int ry = 1 & (t ^ rx);
+    if (ry == 0) {
+      if (rx == 1) {
+        x = s - 1 - x;
+        y = s - 1 - y;
+      }
+      std::swap(x, y);
+    }
+    x += s * rx;
+    y += s * ry;
+  }
+}
+
+// The cell at distance d along the Morton (Z) curve
+void morton_cell(const int d, int &x, int &y) {
+  x = y = 0;
+  for (int bit = 0; (d >> (2 * bit)) != 0; ++bit) {
+    x |= ((d >> (2 * bit)) & 1) << bit;
+    y |= ((d >> (2 * bit + 1)) & 1) << bit;
+  }
+}
+
+} // anonymous namespace
+
+CubedSphere::CubedSphere(const int ne) : m_ne(ne) {
+  assert(ne > 0);
+
+  // Newton iterations on the Lobatto points, starting from the Chebyshev
+  // Gauss Lobatto points. P_N is the Legendre polynomial of degree NP - 1
+  constexpr int N = NP - 1;
+  for (int ip = 0; ip < NP; ++ip) {
+    Real x = -std::cos(pi * ip / N);
+    Real p_n = 0.0;
+    for (int iter = 0; iter < 100; ++iter) {
+      Real p_prev = 1.0;
+      p_n = x;
+      for (int k = 2; k <= N; ++k) {
+        const Real p_next = ((2 * k - 1) * x * p_n - (k - 1) * p_prev) / k;
+        p_prev = p_n;
+        p_n = p_next;
+      }
+      const Real dx = (x * p_n - p_prev) / ((N + 1) * p_n);
+      x -= dx;
+      if (std::abs(dx) < 1e-16) {
+        break;
+      }
+    }
+    m_gll_points[ip] = x;
+    m_gll_weights[ip] = 2.0 / (N * (N + 1) * p_n * p_n);
+  }
+}
+
+std::vector<int> CubedSphere::element_order(const Ordering ordering) const {
+  std::vector<int> new_to_old;
+  new_to_old.reserve(num_elems());
+  if (ordering == NATURAL) {
+    for (int ie = 0; ie < num_elems(); ++ie) {
+      new_to_old.push_back(ie);
+    }
+    return new_to_old;
+  }
+
+  int n = 1;
+  while (n < m_ne) {
+    n *= 2;
+  }
+
+  for (int iface = 0; iface < NUM_FACES; ++iface) {
+    const int face = face_order[iface];
+    for (int d = 0; d < n * n; ++d) {
+      int ex, ey;
+      if (ordering == HILBERT) {
+        hilbert_cell(n, d, ex, ey);
+      } else {
+        morton_cell(d, ex, ey);
+      }
+      if (ex < m_ne && ey < m_ne) {
+        new_to_old.push_back((face * m_ne + ey) * m_ne + ex);
+      }
+    }
+  }
+  assert(static_cast<int>(new_to_old.size()) == num_elems());
+  return new_to_old;
+}
+
+void CubedSphere::vertex(const int ie, const int ivertex, const int jvertex,
+                         int xyz[3]) const {
+  const int face = ie / (m_ne * m_ne);
+  const int ey = (ie / m_ne) % m_ne;
+  const int ex = ie % m_ne;
+  const int x = 2 * (ex + ivertex) - m_ne;
+  const int y = 2 * (ey + jvertex) - m_ne;
+  for (int idim = 0; idim < 3; ++idim) {
+    xyz[idim] = face_c[face][idim] * m_ne + face_a[face][idim] * x +
+                face_b[face][idim] * y;
+  }
+}
+
+void CubedSphere::point(const int ie, const int igp, const int jgp,
+                        Real xyz[3], Real dxyz_dxi1[3],
+                        Real dxyz_dxi2[3]) const {
+  const int face = ie / (m_ne * m_ne);
+  const int ey = (ie / m_ne) % m_ne;
+  const int ex = ie % m_ne;
+
+  const Real dalpha_dxi = pi / (4 * m_ne);
+  const Real alpha =
+      -pi / 4 + (2 * ex + 1 + m_gll_points[igp]) * dalpha_dxi;
+  const Real beta = -pi / 4 + (2 * ey + 1 + m_gll_points[jgp]) * dalpha_dxi;
+
+  // Gnomonic projection of (1, x, y) in the frame of the face
+  const Real x = std::tan(alpha);
+  const Real y = std::tan(beta);
+  const Real r = std::sqrt(1.0 + x * x + y * y);
+  for (int idim = 0; idim < 3; ++idim) {
+    const Real q = face_c[face][idim] + x * face_a[face][idim] +
+                   y * face_b[face][idim];
+    xyz[idim] = q / r;
+    dxyz_dxi1[idim] = (face_a[face][idim] / r - q * x / (r * r * r)) *
+                      (1.0 + x * x) * dalpha_dxi;
+    dxyz_dxi2[idim] = (face_b[face][idim] / r - q * y / (r * r * r)) *
+                      (1.0 + y * y) * dalpha_dxi;
+  }
+}
+
+void CubedSphere::metric(const int ie, const int igp, const int jgp,
+                         Real d[2][2], Real &metdet, Real &lat,
+                         Real &lon) const {
+  Real xyz[3], dxi1[3], dxi2[3];
+  point(ie, igp, jgp, xyz, dxi1, dxi2);
+
+  lat = std::asin(std::max(-1.0, std::min(1.0, xyz[2])));
+  // Any longitude will do at the poles, as long as all the elements agree
+  lon = (std::hypot(xyz[0], xyz[1]) < 1e-12 ? 0.0
+                                             : std::atan2(xyz[1], xyz[0]));
+
+  const Real east[3] = { -std::sin(lon), std::cos(lon), 0.0 };
+  const Real north[3] = { -std::sin(lat) * std::cos(lon),
+                          -std::sin(lat) * std::sin(lon), std::cos(lat) };
+  const Real *const dxi[2] = { dxi1, dxi2 };
+  for (int jdim = 0; jdim < 2; ++jdim) {
+    d[0][jdim] = d[1][jdim] = 0.0;
+    for (int idim = 0; idim < 3; ++idim) {
+      d[0][jdim] += east[idim] * dxi[jdim][idim];
+      d[1][jdim] += north[idim] * dxi[jdim][idim];
+    }
+  }
+  metdet = d[0][0] * d[1][1] - d[0][1] * d[1][0];
+  assert(metdet > 0.0);
+}
+
+} // namespace Homme
@@ -0,0 +1,67 @@
+#ifndef HOMMEXX_CUBED_SPHERE_HPP
+#define HOMMEXX_CUBED_SPHERE_HPP
+
+#include "Types.hpp"
+
+#include <vector>
+
+namespace Homme {
+
+/* Equiangular gnomonic cubed sphere of ne x ne x 6 elements on the unit
+ * sphere.
+ *
+ * Element ie = (face * ne + ey) * ne + ex covers the equiangular coordinates
+ * alpha in [-pi/4 + ex * pi/(2 ne), -pi/4 + (ex + 1) * pi/(2 ne)], and the
+ * same for beta with ey. The GLL point (igp, jgp) sits at the reference
+ * coordinates (xi_igp, xi_jgp) in [-1, 1]^2, with xi_1 along alpha. Each face
+ * is right handed, so that all the elements have the same orientation seen
+ * from outside the sphere.
+ */
+class CubedSphere {
+public:
+  static constexpr int NUM_FACES = 6;
+
+  // Orders of the elements. NATURAL is the numbering described above, the
+  // others follow a space filling curve within each face
+  enum Ordering { NATURAL = 0, HILBERT, MORTON };
+
+  explicit CubedSphere(const int ne);
+
+  int ne() const { return m_ne; }
+  int num_elems() const { return NUM_FACES * m_ne * m_ne; }
+
+  // The GLL points and weights of [-1, 1]
+  const Real *gll_points() const { return m_gll_points; }
+  const Real *gll_weights() const { return m_gll_weights; }
+
+  // Vertex (ivertex, jvertex) in {0, 1}^2 of element ie, as integer
+  // coordinates on the surface of the cube [-ne, ne]^3. Shared vertices
+  // have the same coordinates in all their elements
+  void vertex(const int ie, const int ivertex, const int jvertex,
+              int xyz[3]) const;
+
+  // The cartesian coordinates of the GLL point, and the derivatives with
+  // respect to the reference coordinates xi_1 and xi_2
+  void point(const int ie, const int igp, const int jgp, Real xyz[3],
+             Real dxyz_dxi1[3], Real dxyz_dxi2[3]) const;
+
+  // The metric terms at the GLL point. D maps the contravariant components
+  // in the reference element to the (east, north) components on the sphere
+  void metric(const int ie, const int igp, const int jgp, Real d[2][2],
+              Real &metdet, Real &lat, Real &lon) const;
+
+  // The elements along the curve: element i of the new numbering is element
+  // new_to_old[i] of the natural one. The faces are visited so that
+  // consecutive faces share an edge. If ne is not a power of 2, the curve
+  // covers the next power of 2 and skips the cells outside the face
+  std::vector<int> element_order(const Ordering ordering) const;
+
+private:
+  int m_ne;
+  Real m_gll_points[NP];
+  Real m_gll_weights[NP];
+};
+
+} // namespace Homme
+
+#endif // HOMMEXX_CUBED_SPHERE_HPP
@@ -0,0 +1,54 @@
+#include "Diagnostics.hpp"
+
+#include <cmath>
+#include <iomanip>
+
+namespace Homme {
+
+void Diagnostics::init(const int num_elems) {
+  m_num_elems = num_elems;
+
+  m_gp_values = ExecViewManaged<Real * [NP][NP][NUM_DIAGNOSTICS]>(
+      "Diagnostics partial sums per gauss point", m_num_elems);
+  m_elem_values = ExecViewManaged<Real * [NUM_DIAGNOSTICS]>(
+      "Diagnostics per element", m_num_elems);
+}
+
+Diagnostics::Results Diagnostics::results() const {
+  ExecViewManaged<Real * [NUM_DIAGNOSTICS]>::HostMirror h_elem_values =
+      Kokkos::create_mirror_view(m_elem_values);
+  Kokkos::deep_copy(h_elem_values, m_elem_values);
+
+  Real sums[NUM_DIAGNOSTICS] = {};
+  for (int ie = 0; ie < m_num_elems; ++ie) {
+    for (int idiag = 0; idiag < NUM_DIAGNOSTICS; ++idiag) {
+      sums[idiag] += h_elem_values(ie, idiag);
+    }
+  }
+
+  Results res;
+  res.v_norm = std::sqrt(sums[V_NORM_SQ]);
+  res.t_norm = std::sqrt(sums[T_NORM_SQ]);
+  res.dp_norm = std::sqrt(sums[DP_NORM_SQ]);
+  res.mass = sums[MASS];
+  res.energy = sums[ENERGY];
+  return res;
+}
+
+void Diagnostics::print(std::ostream &out) const {
+  const Results res = results();
+  out << "   ---> Diagnostics:\n"
+      << "          ||v||_2  = " << std::setprecision(17) << res.v_norm << "\n"
+      << "          ||T||_2  = " << std::setprecision(17) << res.t_norm << "\n"
+      << "          ||dp||_2 = " << std::setprecision(17) << res.dp_norm << "\n"
+      << "          mass     = " << std::setprecision(17) << res.mass << "\n"
+      << "          energy   = " << std::setprecision(17) << res.energy
+      << "\n";
+}
+
+Diagnostics &get_diagnostics() {
+  static Diagnostics d;
+  return d;
+}
+
+} // namespace Homme
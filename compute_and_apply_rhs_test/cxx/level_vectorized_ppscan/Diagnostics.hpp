@@ -0,0 +1,84 @@
+#ifndef HOMMEXX_DIAGNOSTICS_HPP
+#define HOMMEXX_DIAGNOSTICS_HPP
+
+#include "Types.hpp"
+
+#include <ostream>
+
+namespace Homme {
+
+/* Norm and conservation diagnostics of the state at np1.
+ *
+ * The CaarFunctor accumulates the diagnostics while computing dp3d at np1,
+ * when Control::compute_diagonstics is set. Each team reduces its gauss point
+ * partial sums in a fixed order into its element slot, and the host sums the
+ * element slots in element order, so the result does not depend on the
+ * number of threads or on the scheduling of the teams.
+ */
+class Diagnostics {
+public:
+  enum : int {
+    V_NORM_SQ = 0, // sum of u^2 + v^2
+    T_NORM_SQ,     // sum of T^2
+    DP_NORM_SQ,    // sum of dp3d^2
+    MASS,          // sum of dp3d
+    ENERGY,        // sum of dp3d * (0.5 * (u^2 + v^2) + cp * T)
+    NUM_DIAGNOSTICS
+  };
+
+  // The value type of the reduction over the levels of a gauss point
+  struct Values {
+    KOKKOS_INLINE_FUNCTION Values() {
+      for (int i = 0; i < NUM_DIAGNOSTICS; ++i) {
+        value[i] = 0.0;
+      }
+    }
+
+    KOKKOS_INLINE_FUNCTION void operator+=(const Values &rhs) {
+      for (int i = 0; i < NUM_DIAGNOSTICS; ++i) {
+        value[i] += rhs.value[i];
+      }
+    }
+
+    KOKKOS_INLINE_FUNCTION void operator+=(const volatile Values &rhs) volatile {
+      for (int i = 0; i < NUM_DIAGNOSTICS; ++i) {
+        value[i] += rhs.value[i];
+      }
+    }
+
+    Real value[NUM_DIAGNOSTICS];
+  };
+
+  // The global diagnostics, as computed on the host
+  struct Results {
+    Real v_norm;
+    Real t_norm;
+    Real dp_norm;
+    Real mass;
+    Real energy;
+  };
+
+  Diagnostics() = default;
+
+  void init(const int num_elems);
+
+  // Sum the element contributions. Only valid after a CaarFunctor run with
+  // compute_diagonstics set
+  Results results() const;
+
+  void print(std::ostream &out) const;
+
+  // Partial sums of each gauss point, reduced by the team in a fixed order
+  ExecViewManaged<Real * [NP][NP][NUM_DIAGNOSTICS]> m_gp_values;
+  // The contribution of each element
+  ExecViewManaged<Real * [NUM_DIAGNOSTICS]> m_elem_values;
+
+private:
+  int m_num_elems;
+};
+
+Diagnostics &get_diagnostics();
+
+} // namespace Homme
+
+#endif // HOMMEXX_DIAGNOSTICS_HPP
@@ -1,10 +1,43 @@
 #include "Elements.hpp"
+#include "CubedSphere.hpp"
+#include "PhysicalConstants.hpp"
 #include "Utility.hpp"
 
+#include <algorithm>
 #include <assert.h>
+#include <cmath>
+#include <type_traits>
 
 namespace Homme {
 
+namespace {
+
+// Permutes the first dimension of a view, whose elements are contiguous
+template <typename ViewType>
+void permute_elements(const ViewType &view,
+                      const std::vector<int> &new_to_old) {
+  using value_type = typename ViewType::non_const_value_type;
+  // The elements are copied as blocks of elem_size values, which only holds
+  // if the first index is the slowest
+  static_assert(std::is_same<typename ViewType::HostMirror::array_layout,
+                             Kokkos::LayoutRight>::value,
+                "permute_elements requires views in LayoutRight");
+  typename ViewType::HostMirror h_view = Kokkos::create_mirror_view(view);
+  Kokkos::deep_copy(h_view, view);
+
+  const size_t elem_size = h_view.size() / h_view.extent(0);
+  const std::vector<value_type> old_values(h_view.data(),
+                                           h_view.data() + h_view.size());
+  for (size_t ie = 0; ie < new_to_old.size(); ++ie) {
+    std::copy(old_values.begin() + new_to_old[ie] * elem_size,
+              old_values.begin() + (new_to_old[ie] + 1) * elem_size,
+              h_view.data() + ie * elem_size);
+  }
+  Kokkos::deep_copy(view, h_view);
+}
+
+} // anonymous namespace
+
 void Elements::init(const int num_elems) {
   m_num_elems = num_elems;
 
@@ -43,6 +76,35 @@ void Elements::init(const int num_elems) {
           "qdp", m_num_elems);
   m_eta_dot_dpdn = ExecViewManaged<Scalar * [NP][NP][NUM_LEV_P]>("eta_dot_dpdn",
                                                                  m_num_elems);
+
+  m_dp3d_num_bad_levels =
+      ExecViewManaged<int *>("Non-positive dp3d levels", m_num_elems);
+  m_dp3d_num_bad_elems =
+      ExecViewManaged<int>("Number of elements with non-positive dp3d");
+}
+
+int Elements::num_bad_dp3d_elems() const {
+  ExecViewManaged<int>::HostMirror h_num_bad_elems =
+      Kokkos::create_mirror_view(m_dp3d_num_bad_elems);
+  Kokkos::deep_copy(h_num_bad_elems, m_dp3d_num_bad_elems);
+  return h_num_bad_elems();
+}
+
+void Elements::reset_dp3d_check() {
+  Kokkos::deep_copy(m_dp3d_num_bad_elems, 0);
+  Kokkos::deep_copy(m_dp3d_num_bad_levels, 0);
+}
+
+void Elements::print_bad_dp3d(std::ostream &out) const {
+  ExecViewManaged<int *>::HostMirror h_num_bad_levels =
+      Kokkos::create_mirror_view(m_dp3d_num_bad_levels);
+  Kokkos::deep_copy(h_num_bad_levels, m_dp3d_num_bad_levels);
+  for (int ie = 0; ie < m_num_elems; ++ie) {
+    if (h_num_bad_levels(ie) > 0) {
+      out << "   element " << ie << ": " << h_num_bad_levels(ie)
+          << " (gauss point, level) pairs with non-positive dp3d\n";
+    }
+  }
 }
 
 void Elements::init_2d(CF90Ptr &D, CF90Ptr &Dinv, CF90Ptr &fcor,
@@ -151,6 +213,78 @@ void Elements::random_init(const int num_elems, std::mt19937_64 &engine) {
   return;
 }
 
+void Elements::cubed_sphere_init(const int ne, std::mt19937_64 &engine) {
+  const CubedSphere mesh(ne);
+  random_init(mesh.num_elems(), engine);
+
+  ExecViewManaged<Real *[NP][NP]>::HostMirror h_fcor =
+      Kokkos::create_mirror_view(m_fcor);
+  ExecViewManaged<Real *[NP][NP]>::HostMirror h_metdet =
+      Kokkos::create_mirror_view(m_metdet);
+  ExecViewManaged<Real *[NP][NP]>::HostMirror h_spheremp =
+      Kokkos::create_mirror_view(m_spheremp);
+  ExecViewManaged<Real *[2][2][NP][NP]>::HostMirror h_d =
+      Kokkos::create_mirror_view(m_d);
+  ExecViewManaged<Real *[2][2][NP][NP]>::HostMirror h_dinv =
+      Kokkos::create_mirror_view(m_dinv);
+
+  for (int ie = 0; ie < m_num_elems; ++ie) {
+    for (int igp = 0; igp < NP; ++igp) {
+      for (int jgp = 0; jgp < NP; ++jgp) {
+        Real d[2][2], metdet, lat, lon;
+        mesh.metric(ie, igp, jgp, d, metdet, lat, lon);
+
+        h_fcor(ie, igp, jgp) = 2.0 * PhysicalConstants::omega * std::sin(lat);
+        h_metdet(ie, igp, jgp) = metdet;
+        // The mass matrix is on the sphere of radius rearth, as in HOMME,
+        // while metdet is on the unit sphere
+        h_spheremp(ie, igp, jgp) =
+            mesh.gll_weights()[igp] * mesh.gll_weights()[jgp] * metdet *
+            PhysicalConstants::rearth * PhysicalConstants::rearth;
+
+        for (int idim = 0; idim < 2; ++idim) {
+          for (int jdim = 0; jdim < 2; ++jdim) {
+            h_d(ie, idim, jdim, igp, jgp) = d[idim][jdim];
+          }
+        }
+        h_dinv(ie, 0, 0, igp, jgp) = d[1][1] / metdet;
+        h_dinv(ie, 0, 1, igp, jgp) = -d[0][1] / metdet;
+        h_dinv(ie, 1, 0, igp, jgp) = -d[1][0] / metdet;
+        h_dinv(ie, 1, 1, igp, jgp) = d[0][0] / metdet;
+      }
+    }
+  }
+
+  Kokkos::deep_copy(m_fcor, h_fcor);
+  Kokkos::deep_copy(m_metdet, h_metdet);
+  Kokkos::deep_copy(m_spheremp, h_spheremp);
+  Kokkos::deep_copy(m_d, h_d);
+  Kokkos::deep_copy(m_dinv, h_dinv);
+}
+
+void Elements::permute(const std::vector<int> &new_to_old) {
+  assert(static_cast<int>(new_to_old.size()) == m_num_elems);
+
+  permute_elements(m_fcor, new_to_old);
+  permute_elements(m_spheremp, new_to_old);
+  permute_elements(m_metdet, new_to_old);
+  permute_elements(m_phis, new_to_old);
+  permute_elements(m_d, new_to_old);
+  permute_elements(m_dinv, new_to_old);
+  permute_elements(m_omega_p, new_to_old);
+  permute_elements(m_pecnd, new_to_old);
+  permute_elements(m_phi, new_to_old);
+  permute_elements(m_derived_un0, new_to_old);
+  permute_elements(m_derived_vn0, new_to_old);
+  permute_elements(m_u, new_to_old);
+  permute_elements(m_v, new_to_old);
+  permute_elements(m_t, new_to_old);
+  permute_elements(m_dp3d, new_to_old);
+  permute_elements(m_qdp, new_to_old);
+  permute_elements(m_eta_dot_dpdn, new_to_old);
+  permute_elements(m_dp3d_num_bad_levels, new_to_old);
+}
+
 void Elements::pull_from_f90_pointers(
     CF90Ptr &state_v, CF90Ptr &state_t, CF90Ptr &state_dp3d,
     CF90Ptr &derived_phi, CF90Ptr &derived_pecnd, CF90Ptr &derived_omega_p,
@@ -459,42 +593,67 @@ void Elements::dinv(Real *dinv_ptr, int ie) const {
   Kokkos::deep_copy(dinv_host, dinv_device);
 }
 
-void Elements::BufferViews::init(int num_elems) {
+size_t Elements::caar_bytes_per_elem(const bool has_tracers,
+                                     const bool has_vertical_flux) {
+  // u, v, t and dp3d are read at nm1 and n0 and written at np1.
+  // derived_un0, derived_vn0 and omega_p are updated in place. pecnd and
+  // qdp at qn0 are read, phi written, and eta_dot_dpdn too with the vertical
+  // advection
+  const size_t level_fields = 12 + 3 * 2 + 1 + (has_tracers ? 1 : 0) + 1 +
+                              (has_vertical_flux ? 1 : 0);
+  // fcor, spheremp, metdet, phis, d and dinv
+  const size_t horizontal_fields = 4 + 2 * 2 * 2;
+  return level_fields * NP * NP * NUM_LEV * sizeof(Scalar) +
+         horizontal_fields * NP * NP * sizeof(Real);
+}
+
+size_t Elements::BufferViews::caar_bytes_per_slot() {
+  // pressure, temperature_virt, omega_p, div_vdp, ephi, vorticity and t_vadv
+  // are scalars, pressure_grad, temperature_grad, vdp, energy_grad, v_vadv,
+  // div_buf, grad_buf and vort_buf are vectors
+  return (7 + 8 * 2) * NP * NP * NUM_LEV * sizeof(Scalar);
+}
+
+void Elements::BufferViews::init(int num_slots) {
   pressure =
-      ExecViewManaged<Scalar * [NP][NP][NUM_LEV]>("Pressure buffer", num_elems);
+      ExecViewManaged<Scalar * [NP][NP][NUM_LEV]>("Pressure buffer", num_slots);
   pressure_grad = ExecViewManaged<Scalar * [2][NP][NP][NUM_LEV]>(
-      "Gradient of pressure", num_elems);
+      "Gradient of pressure", num_slots);
   temperature_virt = ExecViewManaged<Scalar * [NP][NP][NUM_LEV]>(
-      "Virtual Temperature", num_elems);
+      "Virtual Temperature", num_slots);
   temperature_grad = ExecViewManaged<Scalar * [2][NP][NP][NUM_LEV]>(
-      "Gradient of temperature", num_elems);
+      "Gradient of temperature", num_slots);
   omega_p = ExecViewManaged<Scalar * [NP][NP][NUM_LEV]>(
-      "Omega_P why two named the same thing???", num_elems);
-  vdp = ExecViewManaged<Scalar * [2][NP][NP][NUM_LEV]>("vdp???", num_elems);
+      "Omega_P why two named the same thing???", num_slots);
+  vdp = ExecViewManaged<Scalar * [2][NP][NP][NUM_LEV]>("vdp???", num_slots);
   div_vdp = ExecViewManaged<Scalar * [NP][NP][NUM_LEV]>(
-      "Divergence of dp3d * u", num_elems);
+      "Divergence of dp3d * u", num_slots);
   ephi = ExecViewManaged<Scalar * [NP][NP][NUM_LEV]>(
-      "Kinetic Energy + Geopotential Energy", num_elems);
+      "Kinetic Energy + Geopotential Energy", num_slots);
   energy_grad = ExecViewManaged<Scalar * [2][NP][NP][NUM_LEV]>(
-      "Gradient of ephi", num_elems);
+      "Gradient of ephi", num_slots);
   vorticity =
-      ExecViewManaged<Scalar * [NP][NP][NUM_LEV]>("Vorticity", num_elems);
+      ExecViewManaged<Scalar * [NP][NP][NUM_LEV]>("Vorticity", num_slots);
+  t_vadv = ExecViewManaged<Scalar * [NP][NP][NUM_LEV]>(
+      "Vertical advection of temperature", num_slots);
+  v_vadv = ExecViewManaged<Scalar * [2][NP][NP][NUM_LEV]>(
+      "Vertical advection of velocity", num_slots);
 
   qtens = ExecViewManaged<Scalar * [QSIZE_D][NP][NP][NUM_LEV]>(
-      "buffer for tracers", num_elems);
+      "buffer for tracers", num_slots);
   vstar = ExecViewManaged<Scalar * [2][NP][NP][NUM_LEV]>("buffer for v/dp",
-                                                         num_elems);
+                                                         num_slots);
   vstar_qdp = ExecViewManaged<Scalar * [QSIZE_D][2][NP][NP][NUM_LEV]>(
-      "buffer for vstar*qdp", num_elems);
+      "buffer for vstar*qdp", num_slots);
 
-  preq_buf = ExecViewManaged<Real * [NP][NP]>("Preq Buffer", num_elems);
+  preq_buf = ExecViewManaged<Real * [NP][NP]>("Preq Buffer", num_slots);
 
   div_buf = ExecViewManaged<Scalar * [2][NP][NP][NUM_LEV]>("Divergence Buffer",
-                                                           num_elems);
+                                                           num_slots);
   grad_buf = ExecViewManaged<Scalar * [2][NP][NP][NUM_LEV]>("Gradient Buffer",
-                                                            num_elems);
+                                                            num_slots);
   vort_buf = ExecViewManaged<Scalar * [2][NP][NP][NUM_LEV]>("Vorticity Buffer",
-                                                            num_elems);
+                                                            num_slots);
 }
 
 Elements &get_elements() {
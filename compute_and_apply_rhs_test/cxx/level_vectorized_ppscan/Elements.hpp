@@ -6,7 +6,9 @@
 
 #include <Kokkos_Core.hpp>
 
+#include <ostream>
 #include <random>
+#include <vector>
 
 namespace Homme {
 
@@ -52,10 +54,20 @@ public:
   // dpdn is the derivative of pressure with respect to eta
   ExecViewManaged<Scalar * [NP][NP][NUM_LEV_P]> m_eta_dot_dpdn;
 
+  // Number of (gauss point, level) pairs with non-positive dp3d at np1,
+  // as found by the last CAAR step
+  ExecViewManaged<int *> m_dp3d_num_bad_levels;
+  // Number of elements found with non-positive dp3d since the last reset
+  ExecViewManaged<int> m_dp3d_num_bad_elems;
+
   struct BufferViews {
 
     BufferViews() = default;
-    void init(const int num_elems);
+    // Allocates num_slots slots, one per element unless the CaarFunctor runs
+    // on chunks of elements
+    void init(const int num_slots);
+    // Size of the slot of one element in the buffers used by the CaarFunctor
+    static size_t caar_bytes_per_slot();
     ExecViewManaged<Scalar*    [NP][NP][NUM_LEV]> pressure;
     ExecViewManaged<Scalar* [2][NP][NP][NUM_LEV]> pressure_grad;
     ExecViewManaged<Scalar*    [NP][NP][NUM_LEV]> temperature_virt;
@@ -67,6 +79,9 @@ public:
     ExecViewManaged<Scalar*    [NP][NP][NUM_LEV]> ephi;
     ExecViewManaged<Scalar* [2][NP][NP][NUM_LEV]> energy_grad;
     ExecViewManaged<Scalar*    [NP][NP][NUM_LEV]> vorticity;
+    // Vertical advection of T and v, only computed when rsplit == 0
+    ExecViewManaged<Scalar*    [NP][NP][NUM_LEV]> t_vadv;
+    ExecViewManaged<Scalar* [2][NP][NP][NUM_LEV]> v_vadv;
 
     // Buffers for EulerStepFunctor
     ExecViewManaged<Scalar*          [2][NP][NP][NUM_LEV]>  vstar;
@@ -86,8 +101,31 @@ public:
 
   void random_init(int num_elems, std::mt19937_64 &engine);
 
+  // The geometry of a CubedSphere of ne x ne x 6 elements on the unit
+  // sphere, with spheremp on the sphere of radius rearth as in HOMME, and the
+  // fields initialized as in random_init
+  void cubed_sphere_init(const int ne, std::mt19937_64 &engine);
+
   int num_elems() const { return m_num_elems; }
 
+  // The memory traffic of a CAAR step per element, if each field is read or
+  // written once, or read and written once if updated in place. The buffers
+  // are not counted: they should stay in the caches. eta_dot_dpdn is only
+  // counted with has_vertical_flux (rsplit == 0)
+  static size_t caar_bytes_per_elem(const bool has_tracers,
+                                    const bool has_vertical_flux);
+
+  // Renumbers the elements: element ie becomes element new_to_old[ie] of the
+  // current numbering. The views are permuted in place, so the copies held
+  // by the functors see the new order. The buffers are left alone
+  void permute(const std::vector<int> &new_to_old);
+
+  // Cheap to poll after every step: only copies a single int to the host
+  int num_bad_dp3d_elems() const;
+  void reset_dp3d_check();
+  // Lists the elements with non-positive dp3d at np1 in the last step
+  void print_bad_dp3d(std::ostream &out) const;
+
   // Fill the exec space views with data coming from F90 pointers
   void init_2d(CF90Ptr &D, CF90Ptr &Dinv, CF90Ptr &fcor, CF90Ptr &spheremp,
                CF90Ptr &metdet, CF90Ptr &phis);
@@ -0,0 +1,158 @@
+#include "HistoryOutput.hpp"
+
+#include "profiling.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+namespace Homme {
+
+using clock_type = std::chrono::high_resolution_clock;
+
+HistoryOutput::HistoryOutput(const std::string &filename, const int num_elems,
+                             const int lev_stride, const int gp_stride)
+    : m_num_elems(num_elems), m_lev_stride(std::max(lev_stride, 1)),
+      m_gp_stride(std::max(gp_stride, 1)),
+      m_num_levels((NUM_PHYSICAL_LEV + m_lev_stride - 1) / m_lev_stride),
+      m_num_gp((NP + m_gp_stride - 1) / m_gp_stride), m_done(false),
+      m_next_buffer(0), m_num_records(0), m_seconds_in_write(0.0),
+      m_seconds_stalled(0.0) {
+  const int points = m_num_gp * m_num_gp * m_num_levels;
+  m_subset = ExecViewManaged<Real ***>("History output subset", m_num_elems,
+                                       NUM_FIELDS, points);
+  for (int ibuf = 0; ibuf < NUM_BUFFERS; ++ibuf) {
+    m_host_buffers[ibuf] = HostViewManaged<Real ***>(
+        "History output host buffer", m_num_elems, NUM_FIELDS, points);
+    m_pending[ibuf] = false;
+    m_steps[ibuf] = -1;
+  }
+
+  m_file.open(filename, std::ios::out | std::ios::binary);
+  if (!m_file.is_open()) {
+    std::cerr << "Error! Could not open file '" << filename
+              << "' for history output.\n";
+    std::abort();
+  }
+  const int header[5] = { m_num_elems, NUM_FIELDS, m_num_gp, m_num_gp,
+                          m_num_levels };
+  m_file.write(reinterpret_cast<const char *>(header), sizeof(header));
+
+  m_writer = std::thread(&HistoryOutput::writer_loop, this);
+}
+
+HistoryOutput::~HistoryOutput() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_done = true;
+  }
+  m_cv.notify_all();
+  m_writer.join();
+  m_file.close();
+}
+
+void HistoryOutput::write(const Elements &elements, const Control &data,
+                          const int step) {
+  start_timer("history output");
+  const auto start = clock_type::now();
+
+  // Wait for the writer to release the buffer we are about to fill. With two
+  // buffers this only happens if the I/O is slower than the output frequency
+  const int ibuf = m_next_buffer;
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [&]() { return !m_pending[ibuf]; });
+  }
+  const auto stall_end = clock_type::now();
+
+  // Local copies, so that the lambda does not capture this
+  const int np1 = data.np1;
+  const int lev_stride = m_lev_stride;
+  const int gp_stride = m_gp_stride;
+  const int num_levels = m_num_levels;
+  const int num_gp = m_num_gp;
+  const int points = num_gp * num_gp * num_levels;
+  ExecViewManaged<Real ***> subset = m_subset;
+  ExecViewManaged<Scalar * [NUM_TIME_LEVELS][NP][NP][NUM_LEV]> t =
+      elements.m_t;
+  ExecViewManaged<Scalar * [NUM_TIME_LEVELS][NP][NP][NUM_LEV]> u =
+      elements.m_u;
+  ExecViewManaged<Scalar * [NUM_TIME_LEVELS][NP][NP][NUM_LEV]> v =
+      elements.m_v;
+  ExecViewManaged<Scalar * [NUM_TIME_LEVELS][NP][NP][NUM_LEV]> dp3d =
+      elements.m_dp3d;
+  ExecViewManaged<Scalar * [NP][NP][NUM_LEV]> omega_p = elements.m_omega_p;
+  ExecViewManaged<Scalar * [NP][NP][NUM_LEV]> phi = elements.m_phi;
+
+  Kokkos::parallel_for(
+      Kokkos::RangePolicy<ExecSpace>(0, m_num_elems * points),
+      KOKKOS_LAMBDA(const int idx) {
+        const int ie = idx / points;
+        const int ipoint = idx % points;
+        const int igp = (ipoint / num_levels) / num_gp * gp_stride;
+        const int jgp = (ipoint / num_levels) % num_gp * gp_stride;
+        const int ilevel = (ipoint % num_levels) * lev_stride;
+        const int ilev = ilevel / VECTOR_SIZE;
+        const int ivec = ilevel % VECTOR_SIZE;
+
+        subset(ie, T, ipoint) = t(ie, np1, igp, jgp, ilev)[ivec];
+        subset(ie, U, ipoint) = u(ie, np1, igp, jgp, ilev)[ivec];
+        subset(ie, V, ipoint) = v(ie, np1, igp, jgp, ilev)[ivec];
+        subset(ie, DP3D, ipoint) = dp3d(ie, np1, igp, jgp, ilev)[ivec];
+        subset(ie, OMEGA_P, ipoint) = omega_p(ie, igp, jgp, ilev)[ivec];
+        subset(ie, PHI, ipoint) = phi(ie, igp, jgp, ilev)[ivec];
+      });
+  Kokkos::deep_copy(m_host_buffers[ibuf], m_subset);
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_steps[ibuf] = step;
+    m_pending[ibuf] = true;
+  }
+  m_cv.notify_all();
+
+  m_next_buffer = (m_next_buffer + 1) % NUM_BUFFERS;
+  ++m_num_records;
+
+  const auto end = clock_type::now();
+  m_seconds_in_write +=
+      std::chrono::duration_cast<std::chrono::duration<double> >(end - start)
+          .count();
+  m_seconds_stalled += std::chrono::duration_cast<
+      std::chrono::duration<double> >(stall_end - start).count();
+  stop_timer("history output");
+}
+
+void HistoryOutput::writer_loop() {
+  // Records are queued round robin, so they are also written round robin
+  int ibuf = 0;
+  while (true) {
+    int step;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_cv.wait(lock, [&]() { return m_pending[ibuf] || m_done; });
+      if (!m_pending[ibuf]) {
+        // m_done is set and nothing is left to write
+        return;
+      }
+      step = m_steps[ibuf];
+    }
+
+    // The buffer is not touched by write() while it is pending, so the
+    // actual I/O happens outside the lock
+    const HostViewManaged<Real ***> &buffer = m_host_buffers[ibuf];
+    m_file.write(reinterpret_cast<const char *>(&step), sizeof(step));
+    m_file.write(reinterpret_cast<const char *>(buffer.data()),
+                 buffer.size() * sizeof(Real));
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_pending[ibuf] = false;
+    }
+    m_cv.notify_all();
+    ibuf = (ibuf + 1) % NUM_BUFFERS;
+  }
+}
+
+} // namespace Homme
@@ -0,0 +1,89 @@
+#ifndef HOMMEXX_HISTORY_OUTPUT_HPP
+#define HOMMEXX_HISTORY_OUTPUT_HPP
+
+#include "Types.hpp"
+#include "Control.hpp"
+#include "Elements.hpp"
+
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace Homme {
+
+/* Periodic output of a subset of the element state.
+ *
+ * The requested fields are gathered (and optionally downsampled) on the
+ * execution space into a compact buffer, which is then copied to one of two
+ * host buffers. A dedicated I/O thread streams the host buffers to a binary
+ * file, so the dynamics only waits when both host buffers are still queued.
+ *
+ * File layout: a header of 5 ints (num_elems, NUM_FIELDS, num_gp, num_gp,
+ * num_levels), followed by one record per call to write(), each made of an
+ * int (the step) and num_elems*NUM_FIELDS*num_gp*num_gp*num_levels doubles,
+ * ordered as [ie][field][igp][jgp][ilevel].
+ */
+class HistoryOutput {
+public:
+  // The fields written, in the order they appear in each record.
+  // T, U, V and DP3D are taken at np1
+  enum Field { T = 0, U, V, DP3D, OMEGA_P, PHI, NUM_FIELDS };
+
+  // Only every lev_stride-th physical level, and every gp_stride-th gauss
+  // point in each direction is written
+  HistoryOutput(const std::string &filename, const int num_elems,
+                const int lev_stride = 1, const int gp_stride = 1);
+
+  // Flushes all pending records and joins the I/O thread
+  ~HistoryOutput();
+
+  HistoryOutput(const HistoryOutput &) = delete;
+  HistoryOutput &operator=(const HistoryOutput &) = delete;
+
+  // Gather the fields from the elements and queue them for output
+  void write(const Elements &elements, const Control &data, const int step);
+
+  // Time spent inside write() by the calling thread, and the part of it
+  // spent waiting for the I/O thread to release a host buffer
+  double seconds_in_write() const { return m_seconds_in_write; }
+  double seconds_stalled() const { return m_seconds_stalled; }
+
+  int num_records() const { return m_num_records; }
+  int num_levels() const { return m_num_levels; }
+  int num_gp() const { return m_num_gp; }
+
+private:
+  void writer_loop();
+
+  static constexpr int NUM_BUFFERS = 2;
+
+  const int m_num_elems;
+  const int m_lev_stride;
+  const int m_gp_stride;
+  const int m_num_levels;
+  const int m_num_gp;
+
+  ExecViewManaged<Real ***> m_subset;
+  HostViewManaged<Real ***> m_host_buffers[NUM_BUFFERS];
+
+  // Protected by m_mutex
+  bool m_pending[NUM_BUFFERS];
+  int m_steps[NUM_BUFFERS];
+  bool m_done;
+
+  int m_next_buffer;
+  int m_num_records;
+  double m_seconds_in_write;
+  double m_seconds_stalled;
+
+  std::ofstream m_file;
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::thread m_writer;
+};
+
+} // namespace Homme
+
+#endif // HOMMEXX_HISTORY_OUTPUT_HPP
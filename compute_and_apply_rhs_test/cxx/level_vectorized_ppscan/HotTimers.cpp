@@ -0,0 +1,110 @@
+#include "HotTimers.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+namespace Homme {
+
+HotTimers::Slot *HotTimers::s_slots = nullptr;
+int HotTimers::s_num_slots = 0;
+double HotTimers::s_ticks_per_second = 1e9;
+
+void HotTimers::init(const int max_threads) {
+  finalize();
+  s_slots = new Slot[max_threads];
+  std::memset(s_slots, 0, max_threads * sizeof(Slot));
+  s_num_slots = max_threads;
+
+  // The TSC rate against the steady clock
+  const auto clock_start = std::chrono::steady_clock::now();
+  const std::uint64_t ticks_start = ticks();
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  const std::uint64_t ticks_end = ticks();
+  const double seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - clock_start)
+                             .count();
+  s_ticks_per_second = (ticks_end - ticks_start) / seconds;
+}
+
+void HotTimers::finalize() {
+  delete[] s_slots;
+  s_slots = nullptr;
+  s_num_slots = 0;
+}
+
+const char *HotTimers::name(const Id id) {
+  switch (id) {
+  case CAAR_COMPUTE:
+    return "caar compute";
+  case CAAR_TEMPERATURE_DIV_VDP:
+    return "caar temperature and div_vdp";
+  case CAAR_SCAN:
+    return "caar scan";
+  case CAAR_PHASE_3:
+    return "caar phase 3";
+  default:
+    return "unknown";
+  }
+}
+
+void HotTimers::append_summary(const char *file_name) {
+  FILE *fp = std::fopen(file_name, "a");
+  if (fp == nullptr) {
+    fp = stderr;
+  }
+
+  int max_name_length = std::strlen("name");
+  for (int id = 0; id < NUM_TIMERS; ++id) {
+    max_name_length = std::max<int>(max_name_length,
+                                    std::strlen(name(static_cast<Id>(id))));
+  }
+
+  std::fprintf(fp, "Hot path timers, TSC at %.6e ticks per second\n",
+               s_ticks_per_second);
+  std::fprintf(fp, "%-*s", max_name_length, "name");
+  std::fprintf(fp, " processes  threads        count");
+  std::fprintf(fp, "      walltotal   wallmax (proc   thrd  )   wallmin "
+                   "(proc   thrd  )\n");
+  for (int id = 0; id < NUM_TIMERS; ++id) {
+    int num_threads = 0;
+    std::uint64_t count = 0;
+    double total = 0.0;
+    double max = 0.0, min = 0.0;
+    int max_thread = 0, min_thread = 0;
+    for (int thread = 0; thread < s_num_slots; ++thread) {
+      const Slot &slot = s_slots[thread];
+      if (slot.count[id] == 0) {
+        continue;
+      }
+      const double seconds = slot.ticks[id] / s_ticks_per_second;
+      if (num_threads == 0 || seconds > max) {
+        max = seconds;
+        max_thread = thread;
+      }
+      if (num_threads == 0 || seconds < min) {
+        min = seconds;
+        min_thread = thread;
+      }
+      ++num_threads;
+      count += slot.count[id];
+      total += seconds;
+    }
+    if (num_threads == 0) {
+      continue;
+    }
+    std::fprintf(fp, "%-*s", max_name_length, name(static_cast<Id>(id)));
+    std::fprintf(fp, "  %8d %8d %12.6e ", 1, num_threads,
+                 static_cast<float>(count));
+    std::fprintf(fp, "  %12.6e %9.3f (%6d %6d) %9.3f (%6d %6d)\n", total, max,
+                 0, max_thread, min, 0, min_thread);
+  }
+  std::fprintf(fp, "\n");
+
+  if (fp != stderr) {
+    std::fclose(fp);
+  }
+}
+
+} // namespace Homme
@@ -0,0 +1,95 @@
+#ifndef HOMMEXX_HOT_TIMERS_HPP
+#define HOMMEXX_HOT_TIMERS_HPP
+
+#include "Utility.hpp"
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace Homme {
+
+/* Timers cheap enough to stay on in the kernels, unlike the GPTL ones.
+ *
+ * The timers are identified at compile time by an Id, so there is no name
+ * lookup. Each thread counts into its own slot, padded so that no two
+ * threads share a cache line, so there are no locks or atomics. The time
+ * stamps are TSC ticks on x86, converted to seconds with a rate calibrated
+ * by init(). The slots are only summed by append_summary(), once the
+ * kernels are done.
+ *
+ * A timer may not be started again by a thread before it is stopped. Use
+ * the start_hot_timer and stop_hot_timer macros of profiling.hpp, which
+ * compile to nothing on CUDA.
+ */
+class HotTimers {
+public:
+  enum Id : int {
+    CAAR_COMPUTE = 0,
+    CAAR_TEMPERATURE_DIV_VDP,
+    CAAR_SCAN,
+    CAAR_PHASE_3,
+    NUM_TIMERS
+  };
+
+  // Slots for the threads 0 to max_threads - 1. The other threads are not
+  // timed
+  static void init(const int max_threads);
+  static void finalize();
+
+  static void start(const Id id) {
+    Slot *const slot = thread_slot();
+    if (slot != nullptr) {
+      slot->started[id] = ticks();
+    }
+  }
+
+  static void stop(const Id id) {
+    Slot *const slot = thread_slot();
+    if (slot != nullptr) {
+      slot->ticks[id] += ticks() - slot->started[id];
+      ++slot->count[id];
+    }
+  }
+
+  static const char *name(const Id id);
+
+  // Appends the timers to the file written by GPTLpr_summary_file, with the
+  // same columns
+  static void append_summary(const char *file_name);
+
+private:
+  struct Slot {
+    std::uint64_t started[NUM_TIMERS];
+    std::uint64_t ticks[NUM_TIMERS];
+    std::uint64_t count[NUM_TIMERS];
+    // Keeps the next slot off the cache lines of this one
+    char padding[64];
+  };
+
+  static std::uint64_t ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+  }
+
+  static Slot *thread_slot() {
+    const int id = kernel_thread_id();
+    return (id < s_num_slots ? &s_slots[id] : nullptr);
+  }
+
+  static Slot *s_slots;
+  static int s_num_slots;
+  static double s_ticks_per_second;
+};
+
+} // namespace Homme
+
+#endif // HOMMEXX_HOT_TIMERS_HPP
@@ -8,9 +8,20 @@ namespace Homme {
 struct KernelVariables {
   KOKKOS_INLINE_FUNCTION
   KernelVariables(const TeamMember &team_in)
-      : team(team_in), ie(team.league_rank()), ilev(-1) {
+      : team(team_in), ie(team.league_rank()), ibuf(ie), ilev(-1) {
   } //, igp(-1), jgp(-1) {}
 
+  // For a league which runs over a subset of the elements
+  KOKKOS_INLINE_FUNCTION
+  KernelVariables(const TeamMember &team_in, const int ie_in)
+      : team(team_in), ie(ie_in), ibuf(ie_in), ilev(-1) {}
+
+  // For buffers with fewer slots than elements
+  KOKKOS_INLINE_FUNCTION
+  KernelVariables(const TeamMember &team_in, const int ie_in,
+                  const int ibuf_in)
+      : team(team_in), ie(ie_in), ibuf(ibuf_in), ilev(-1) {}
+
   template <typename Primitive, typename Data>
   KOKKOS_INLINE_FUNCTION Primitive *allocate_team() const {
     ScratchView<Data> view(team.team_scratch(0));
@@ -35,7 +46,8 @@ struct KernelVariables {
     team.team_barrier();
   }
 
-  int ie, ilev;
+  // The element, and its slot in Elements::buffers
+  int ie, ibuf, ilev;
 }; // KernelVariables
 
 } // Homme
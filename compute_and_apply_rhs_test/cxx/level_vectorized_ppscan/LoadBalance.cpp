@@ -0,0 +1,91 @@
+#include "LoadBalance.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Homme {
+
+void LoadBalance::init(const int num_teams) {
+  m_team_times.busy_seconds =
+      ExecViewManaged<double *>("Busy seconds of each team", num_teams);
+  m_team_times.num_team_elems =
+      ExecViewManaged<int *>("Elements processed by each team", num_teams);
+  m_step_seconds.clear();
+  m_team_busy_seconds.assign(num_teams, 0.0);
+  m_team_num_elems.assign(num_teams, 0);
+  m_sum_imbalance = 0.0;
+}
+
+void LoadBalance::end_step(const double step_seconds) {
+  if (!active()) {
+    return;
+  }
+  ExecViewManaged<double *>::HostMirror h_busy_seconds =
+      Kokkos::create_mirror_view(m_team_times.busy_seconds);
+  ExecViewManaged<int *>::HostMirror h_num_elems =
+      Kokkos::create_mirror_view(m_team_times.num_team_elems);
+  Kokkos::deep_copy(h_busy_seconds, m_team_times.busy_seconds);
+  Kokkos::deep_copy(h_num_elems, m_team_times.num_team_elems);
+
+  const int num_teams = h_busy_seconds.extent_int(0);
+  double max_busy = 0.0;
+  double sum_busy = 0.0;
+  for (int iteam = 0; iteam < num_teams; ++iteam) {
+    max_busy = std::max(max_busy, h_busy_seconds(iteam));
+    sum_busy += h_busy_seconds(iteam);
+    m_team_busy_seconds[iteam] += h_busy_seconds(iteam);
+    m_team_num_elems[iteam] += h_num_elems(iteam);
+  }
+  if (sum_busy > 0.0) {
+    m_sum_imbalance += max_busy * num_teams / sum_busy;
+  }
+  m_step_seconds.push_back(step_seconds);
+
+  Kokkos::deep_copy(m_team_times.busy_seconds, 0.0);
+  Kokkos::deep_copy(m_team_times.num_team_elems, 0);
+}
+
+double LoadBalance::idle_fraction() const {
+  double total_seconds = 0.0;
+  for (const double seconds : m_step_seconds) {
+    total_seconds += seconds;
+  }
+  double busy_seconds = 0.0;
+  for (const double seconds : m_team_busy_seconds) {
+    busy_seconds += seconds;
+  }
+  total_seconds *= m_team_busy_seconds.size();
+  return (total_seconds > 0.0 ? 1.0 - busy_seconds / total_seconds : 0.0);
+}
+
+double LoadBalance::step_seconds_quantile(const double q) const {
+  if (m_step_seconds.empty()) {
+    return 0.0;
+  }
+  std::vector<double> sorted(m_step_seconds);
+  std::sort(sorted.begin(), sorted.end());
+  const int index = static_cast<int>(std::ceil(q * sorted.size())) - 1;
+  return sorted[std::max(0, std::min<int>(index, sorted.size() - 1))];
+}
+
+void LoadBalance::print(std::ostream &out) const {
+  if (!active() || m_step_seconds.empty()) {
+    return;
+  }
+  const auto busy = std::minmax_element(m_team_busy_seconds.begin(),
+                                        m_team_busy_seconds.end());
+  const auto elems = std::minmax_element(m_team_num_elems.begin(),
+                                         m_team_num_elems.end());
+  out << "Load balance over " << m_team_busy_seconds.size() << " teams, "
+      << num_steps() << " steps: " << 100.0 * idle_fraction()
+      << "% of the team time idle, busiest over mean team "
+      << m_sum_imbalance / num_steps() << " per step\n"
+      << "   busy seconds per team " << *busy.first << " to " << *busy.second
+      << ", elements per team " << *elems.first << " to " << *elems.second
+      << "\n"
+      << "   step seconds: median " << step_seconds_quantile(0.5) << ", p99 "
+      << step_seconds_quantile(0.99) << ", max "
+      << step_seconds_quantile(1.0) << "\n";
+}
+
+} // namespace Homme
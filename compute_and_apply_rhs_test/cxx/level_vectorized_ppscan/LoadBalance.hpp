@@ -0,0 +1,78 @@
+#ifndef HOMMEXX_LOAD_BALANCE_HPP
+#define HOMMEXX_LOAD_BALANCE_HPP
+
+#include "Types.hpp"
+#include "Utility.hpp"
+
+#include <ostream>
+#include <vector>
+
+namespace Homme {
+
+/* Busy and idle time of the teams of the CaarFunctor, when it runs on
+ * persistent teams (one team per concurrent chunk of elements, see
+ * CaarFunctor::run_step).
+ *
+ * Each team adds the time spent on its chunks to its own slot, so that no
+ * atomics are needed. After each step, end_step() takes the slots to the
+ * host together with the wall time of the step: whatever a team did not
+ * spend on its chunks, it spent waiting for the slowest team.
+ *
+ * See kernel_seconds: on CUDA the busy times are zero.
+ */
+class LoadBalance {
+public:
+  // The per team slots, cheap to copy into the functors
+  struct TeamTimes {
+    // Called by all the threads of the team, after a chunk of num_elems
+    // elements started at kernel_seconds() start. Does nothing without slots
+    KOKKOS_INLINE_FUNCTION
+    void add_chunk(const TeamMember &team, const double start,
+                   const int num_elems) const {
+      if (team.league_rank() < busy_seconds.extent_int(0)) {
+        const double seconds = kernel_seconds() - start;
+        Kokkos::single(Kokkos::PerTeam(team), [&]() {
+          busy_seconds(team.league_rank()) += seconds;
+          num_team_elems(team.league_rank()) += num_elems;
+        });
+      }
+    }
+
+    ExecViewManaged<double *> busy_seconds;
+    ExecViewManaged<int *> num_team_elems;
+  };
+
+  LoadBalance() = default;
+
+  void init(const int num_teams);
+
+  bool active() const { return m_team_times.busy_seconds.extent_int(0) > 0; }
+
+  const TeamTimes &team_times() const { return m_team_times; }
+
+  // Accounts the busy times of the teams since the last call, for a step of
+  // step_seconds
+  void end_step(const double step_seconds);
+
+  int num_steps() const { return m_step_seconds.size(); }
+  // The fraction of the team time spent waiting for other teams
+  double idle_fraction() const;
+  // The q quantile of the step times, with q in [0, 1]
+  double step_seconds_quantile(const double q) const;
+
+  void print(std::ostream &out) const;
+
+private:
+  TeamTimes m_team_times;
+
+  std::vector<double> m_step_seconds;
+  // Busy time and elements of each team over all the steps
+  std::vector<double> m_team_busy_seconds;
+  std::vector<long> m_team_num_elems;
+  // Sum over the steps of the busiest team over the mean team
+  double m_sum_imbalance = 0.0;
+};
+
+} // namespace Homme
+
+#endif // HOMMEXX_LOAD_BALANCE_HPP
@@ -0,0 +1,323 @@
+#include "PerfCounters.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Homme {
+
+PerfCounters::Slot *PerfCounters::s_slots = nullptr;
+int PerfCounters::s_num_slots = 0;
+
+namespace {
+
+#ifdef __linux__
+// Sets the type and config of the Event, or returns false if it has no code
+bool event_code(const int event, perf_event_attr &attr) {
+  switch (event) {
+  case PerfCounters::CYCLES:
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_CPU_CYCLES;
+    return true;
+  case PerfCounters::INSTRUCTIONS:
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+    return true;
+  case PerfCounters::L1D_MISSES:
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_L1D |
+                  (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    return true;
+  case PerfCounters::LLC_MISSES:
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    return true;
+  case PerfCounters::DTLB_MISSES:
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_DTLB |
+                  (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    return true;
+  case PerfCounters::FP_OPS: {
+    const char *raw = std::getenv("HOMMEXX_PERF_FP_EVENT");
+    if (raw == nullptr) {
+      return false;
+    }
+    attr.type = PERF_TYPE_RAW;
+    attr.config = std::strtoull(raw, nullptr, 16);
+    return true;
+  }
+  default:
+    return false;
+  }
+}
+#endif // __linux__
+
+constexpr int cache_line_bytes = 64;
+
+} // anonymous namespace
+
+bool PerfCounters::init(const int max_threads) {
+  finalize();
+
+  // Try on this thread first, so that a missing perf_event support is
+  // reported once
+  Slot test;
+  test.leader = -1;
+  if (!open_group(test)) {
+    std::cerr << "Hardware counters not available (" << std::strerror(errno)
+              << "), the counter regions are disabled\n";
+    return false;
+  }
+  close_group(test);
+
+  s_slots = new Slot[max_threads];
+  std::memset(s_slots, 0, max_threads * sizeof(Slot));
+  for (int thread = 0; thread < max_threads; ++thread) {
+    s_slots[thread].leader = -1;
+  }
+  s_num_slots = max_threads;
+  return true;
+}
+
+void PerfCounters::finalize() {
+  for (int thread = 0; thread < s_num_slots; ++thread) {
+    close_group(s_slots[thread]);
+  }
+  delete[] s_slots;
+  s_slots = nullptr;
+  s_num_slots = 0;
+}
+
+bool PerfCounters::open_group(Slot &slot) {
+  slot.leader = -2;
+  slot.num_counted = 0;
+  for (int event = 0; event < NUM_EVENTS; ++event) {
+    slot.fds[event] = -1;
+    slot.index[event] = -1;
+  }
+#ifdef __linux__
+  for (int event = 0; event < NUM_EVENTS; ++event) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    if (!event_code(event, attr)) {
+      continue;
+    }
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                       PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // This thread, on any cpu
+    const int fd = syscall(__NR_perf_event_open, &attr, 0, -1,
+                           (slot.leader >= 0 ? slot.leader : -1), 0);
+    if (fd < 0) {
+      // Not all the CPUs have all the events
+      continue;
+    }
+    if (slot.leader < 0) {
+      slot.leader = fd;
+    }
+    slot.fds[event] = fd;
+    slot.index[event] = slot.num_counted++;
+  }
+  return slot.leader >= 0;
+#else
+  errno = ENOSYS;
+  return false;
+#endif // __linux__
+}
+
+void PerfCounters::close_group(const Slot &slot) {
+#ifdef __linux__
+  if (slot.leader < 0) {
+    return;
+  }
+  for (int event = 0; event < NUM_EVENTS; ++event) {
+    if (slot.index[event] >= 0) {
+      close(slot.fds[event]);
+    }
+  }
+#endif // __linux__
+}
+
+bool PerfCounters::read_group(const Slot &slot, Values &values) {
+#ifdef __linux__
+  // nr, time enabled, time running, then the values
+  std::uint64_t buffer[3 + NUM_EVENTS];
+  const ssize_t size = (3 + slot.num_counted) * sizeof(std::uint64_t);
+  if (read(slot.leader, buffer, size) != size) {
+    return false;
+  }
+  // Scale the counts up if the kernel had to multiplex the counters
+  const double scale =
+      (buffer[2] > 0 && buffer[2] < buffer[1]
+           ? static_cast<double>(buffer[1]) / buffer[2]
+           : 1.0);
+  values.value[0] = buffer[1];
+  for (int event = 0; event < NUM_EVENTS; ++event) {
+    values.value[1 + event] =
+        (slot.index[event] >= 0 ? buffer[3 + slot.index[event]] * scale : 0);
+  }
+  return true;
+#else
+  return false;
+#endif // __linux__
+}
+
+void PerfCounters::read_thread(const Region region, const bool stop) {
+  const int id = kernel_thread_id();
+  if (id >= s_num_slots) {
+    return;
+  }
+  Slot &slot = s_slots[id];
+  if (slot.leader == -1) {
+    open_group(slot);
+  }
+  Values values;
+  if (slot.leader < 0 || !read_group(slot, values)) {
+    return;
+  }
+  if (!stop) {
+    slot.started[region] = values;
+  } else {
+    for (int k = 0; k < NUM_EVENTS + 1; ++k) {
+      slot.total[region].value[k] +=
+          values.value[k] - slot.started[region].value[k];
+    }
+    ++slot.calls[region];
+  }
+}
+
+const char *PerfCounters::name(const Region region) {
+  switch (region) {
+  case COMPUTE_TEMPERATURE:
+    return "compute_temperature";
+  case COMPUTE_DIV_VDP:
+    return "compute_div_vdp";
+  case COMPUTE_PRESSURE:
+    return "compute_pressure";
+  case PREQ_HYDROSTATIC:
+    return "preq_hydrostatic";
+  case PREQ_OMEGA_PS:
+    return "preq_omega_ps";
+  case PREQ_HYDROSTATIC_OMEGA_PS:
+    return "preq_hydrostatic_omega_ps";
+  case COMPUTE_ENERGY_GRAD:
+    return "compute_energy_grad";
+  case COMPUTE_VELOCITY_NP1:
+    return "compute_velocity_np1";
+  case COMPUTE_TEMPERATURE_NP1:
+    return "compute_temperature_np1";
+  case COMPUTE_DP3D_NP1:
+    return "compute_dp3d_np1";
+  case GRADIENT_SPHERE:
+    return "gradient_sphere";
+  case GRADIENT_SPHERE_UPDATE:
+    return "gradient_sphere_update";
+  case DIVERGENCE_SPHERE:
+    return "divergence_sphere";
+  case VORTICITY_SPHERE:
+    return "vorticity_sphere";
+  default:
+    return "unknown";
+  }
+}
+
+void PerfCounters::append_summary(const char *file_name) {
+  if (!enabled()) {
+    return;
+  }
+  FILE *fp = std::fopen(file_name, "a");
+  if (fp == nullptr) {
+    fp = stderr;
+  }
+
+  // An event is n/a if no thread could count it
+  bool counted[NUM_EVENTS] = {};
+  for (int thread = 0; thread < s_num_slots; ++thread) {
+    for (int event = 0; event < NUM_EVENTS; ++event) {
+      counted[event] = counted[event] || (s_slots[thread].leader >= 0 &&
+                                          s_slots[thread].index[event] >= 0);
+    }
+  }
+
+  int max_name_length = std::strlen("name");
+  for (int region = 0; region < NUM_REGIONS; ++region) {
+    max_name_length = std::max<int>(
+        max_name_length, std::strlen(name(static_cast<Region>(region))));
+  }
+
+  std::fprintf(fp, "Hardware counters, user space, summed over the threads. "
+                   "Regions include the regions they call. Misses per 1000 "
+                   "instructions, GB/s and GFLOP/s per thread\n");
+  std::fprintf(fp, "%-*s", max_name_length, "name");
+  std::fprintf(fp, "        calls      seconds      IPC  L1D miss  LLC miss "
+                   "dTLB miss  LLC GB/s  GFLOP/s\n");
+  for (int region = 0; region < NUM_REGIONS; ++region) {
+    Values total;
+    std::memset(&total, 0, sizeof(total));
+    std::uint64_t calls = 0;
+    for (int thread = 0; thread < s_num_slots; ++thread) {
+      const Slot &slot = s_slots[thread];
+      for (int k = 0; k < NUM_EVENTS + 1; ++k) {
+        total.value[k] += slot.total[region].value[k];
+      }
+      calls += slot.calls[region];
+    }
+    if (calls == 0) {
+      continue;
+    }
+    const double seconds = total.value[0] * 1e-9;
+    auto count = [&](const int event) { return total.value[1 + event]; };
+    auto per_kinstr = [&](const int event) {
+      return 1000.0 * count(event) / std::max<std::uint64_t>(1, count(INSTRUCTIONS));
+    };
+
+    std::fprintf(fp, "%-*s", max_name_length, name(static_cast<Region>(region)));
+    std::fprintf(fp, " %12llu %12.6e", static_cast<unsigned long long>(calls),
+                 seconds);
+    if (counted[CYCLES] && counted[INSTRUCTIONS]) {
+      std::fprintf(fp, " %8.3f", static_cast<double>(count(INSTRUCTIONS)) /
+                                     std::max<std::uint64_t>(1, count(CYCLES)));
+    } else {
+      std::fprintf(fp, " %8s", "n/a");
+    }
+    for (const int event : { L1D_MISSES, LLC_MISSES, DTLB_MISSES }) {
+      if (counted[event] && counted[INSTRUCTIONS]) {
+        std::fprintf(fp, " %9.3f", per_kinstr(event));
+      } else {
+        std::fprintf(fp, " %9s", "n/a");
+      }
+    }
+    if (counted[LLC_MISSES] && seconds > 0.0) {
+      std::fprintf(fp, " %9.3f",
+                   count(LLC_MISSES) * cache_line_bytes / seconds * 1e-9);
+    } else {
+      std::fprintf(fp, " %9s", "n/a");
+    }
+    if (counted[FP_OPS] && seconds > 0.0) {
+      std::fprintf(fp, " %8.3f", count(FP_OPS) / seconds * 1e-9);
+    } else {
+      std::fprintf(fp, " %8s", "n/a");
+    }
+    std::fprintf(fp, "\n");
+  }
+  std::fprintf(fp, "\n");
+
+  if (fp != stderr) {
+    std::fclose(fp);
+  }
+}
+
+} // namespace Homme
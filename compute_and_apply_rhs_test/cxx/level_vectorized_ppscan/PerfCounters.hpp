@@ -0,0 +1,113 @@
+#ifndef HOMMEXX_PERF_COUNTERS_HPP
+#define HOMMEXX_PERF_COUNTERS_HPP
+
+#include "Utility.hpp"
+
+#include <cstdint>
+#include <string>
+
+namespace Homme {
+
+/* Hardware counters of the CAAR phases and of the sphere operators, read
+ * with the Linux perf_event_open interface.
+ *
+ * Each thread opens its own group of counters on its first region, counting
+ * in user space only, and reads the whole group with one read() when a
+ * region starts and when it stops. Regions may be nested: the counts of a
+ * region include those of the regions it calls. A thread's counts go to its
+ * own slot, so there are no locks or atomics; the slots are only summed by
+ * append_summary().
+ *
+ * The counters are only opened if init() is called. If they cannot be
+ * opened (no perf_event support, perf_event_paranoid too high, not Linux),
+ * init() says so and the regions do nothing. Events which the CPU does not
+ * have are reported as n/a. The FP operations have no generic event: the
+ * raw event code in HOMMEXX_PERF_FP_EVENT (hex) is counted, if set.
+ */
+class PerfCounters {
+public:
+  enum Region : int {
+    COMPUTE_TEMPERATURE = 0,
+    COMPUTE_DIV_VDP,
+    COMPUTE_PRESSURE,
+    PREQ_HYDROSTATIC,
+    PREQ_OMEGA_PS,
+    PREQ_HYDROSTATIC_OMEGA_PS,
+    COMPUTE_ENERGY_GRAD,
+    COMPUTE_VELOCITY_NP1,
+    COMPUTE_TEMPERATURE_NP1,
+    COMPUTE_DP3D_NP1,
+    GRADIENT_SPHERE,
+    GRADIENT_SPHERE_UPDATE,
+    DIVERGENCE_SPHERE,
+    VORTICITY_SPHERE,
+    NUM_REGIONS
+  };
+
+  enum Event : int {
+    CYCLES = 0,
+    INSTRUCTIONS,
+    L1D_MISSES,
+    LLC_MISSES,
+    DTLB_MISSES,
+    FP_OPS,
+    NUM_EVENTS
+  };
+
+  // Slots for the threads 0 to max_threads - 1. Returns whether the
+  // counters are available
+  static bool init(const int max_threads);
+  static void finalize();
+
+  static bool enabled() { return s_slots != nullptr; }
+
+  static void start(const Region region) {
+    if (enabled()) {
+      read_thread(region, false);
+    }
+  }
+
+  static void stop(const Region region) {
+    if (enabled()) {
+      read_thread(region, true);
+    }
+  }
+
+  static const char *name(const Region region);
+
+  // Appends the calls, seconds, IPC, miss rates per 1000 instructions and
+  // the DRAM bandwidth implied by the LLC misses of each region to the file
+  static void append_summary(const char *file_name);
+
+private:
+  // The values read from a group: the time enabled, then the events
+  struct Values {
+    std::uint64_t value[NUM_EVENTS + 1];
+  };
+
+  struct Slot {
+    // The group of the thread, -1 until opened, -2 if it failed
+    int leader;
+    int fds[NUM_EVENTS];
+    // The position of each event in the group, or -1 if not counted
+    int index[NUM_EVENTS];
+    int num_counted;
+    Values started[NUM_REGIONS];
+    Values total[NUM_REGIONS];
+    std::uint64_t calls[NUM_REGIONS];
+    // Keeps the next slot off the cache lines of this one
+    char padding[64];
+  };
+
+  static void read_thread(const Region region, const bool stop);
+  static bool open_group(Slot &slot);
+  static void close_group(const Slot &slot);
+  static bool read_group(const Slot &slot, Values &values);
+
+  static Slot *s_slots;
+  static int s_num_slots;
+};
+
+} // namespace Homme
+
+#endif // HOMMEXX_PERF_COUNTERS_HPP
@@ -13,7 +13,9 @@ struct PhysicalConstants
   static constexpr Real Rgas          = 287.04;
   static constexpr Real cp            = 1005.0;
   static constexpr Real kappa         = Rgas / cp;
-  static constexpr Real rrearth       = 1.0 / 6.376e6;
+  static constexpr Real rearth        = 6.376e6;
+  static constexpr Real rrearth       = 1.0 / rearth;
+  static constexpr Real omega         = 7.292e-5;
 };
 
 } // namespace Homme
@@ -6,6 +6,7 @@
 #include "Dimensions.hpp"
 #include "KernelVariables.hpp"
 #include "PhysicalConstants.hpp"
+#include "profiling.hpp"
 
 #include <Kokkos_Core.hpp>
 
@@ -233,6 +234,7 @@ gradient_sphere(const KernelVariables &kv,
                       ExecViewUnmanaged<      Scalar*   [2][NP][NP][NUM_LEV]> v_buf,
                       ExecViewUnmanaged<      Scalar    [2][NP][NP][NUM_LEV]> grad_s)
 {
+  start_perf_region(GRADIENT_SPHERE);
   constexpr int contra_iters = NP * NP;
   Kokkos::parallel_for(Kokkos::TeamThreadRange(kv.team, contra_iters),
                        [&](const int loop_idx) {
@@ -244,8 +246,8 @@ gradient_sphere(const KernelVariables &kv,
         dsdx += dvv(jgp, kgp) * scalar(igp, kgp, ilev);
         dsdy += dvv(jgp, kgp) * scalar(kgp, igp, ilev);
       }
-      v_buf(kv.ie, 0, igp, jgp, ilev) = dsdx * PhysicalConstants::rrearth;
-      v_buf(kv.ie, 1, jgp, igp, ilev) = dsdy * PhysicalConstants::rrearth;
+      v_buf(kv.ibuf, 0, igp, jgp, ilev) = dsdx * PhysicalConstants::rrearth;
+      v_buf(kv.ibuf, 1, jgp, igp, ilev) = dsdy * PhysicalConstants::rrearth;
     });
   });
   kv.team_barrier();
@@ -258,14 +260,15 @@ gradient_sphere(const KernelVariables &kv,
     const int jgp = loop_idx % NP;
     Kokkos::parallel_for(Kokkos::ThreadVectorRange(kv.team, NUM_LEV), [&] (const int& ilev) {
       grad_s(0, igp, jgp, ilev) =
-          dinv(kv.ie, 0, 0, igp, jgp) * v_buf(kv.ie, 0, igp, jgp, ilev) +
-          dinv(kv.ie, 0, 1, igp, jgp) * v_buf(kv.ie, 1, igp, jgp, ilev);
+          dinv(kv.ie, 0, 0, igp, jgp) * v_buf(kv.ibuf, 0, igp, jgp, ilev) +
+          dinv(kv.ie, 0, 1, igp, jgp) * v_buf(kv.ibuf, 1, igp, jgp, ilev);
       grad_s(1, igp, jgp, ilev) =
-          dinv(kv.ie, 1, 0, igp, jgp) * v_buf(kv.ie, 0, igp, jgp, ilev) +
-          dinv(kv.ie, 1, 1, igp, jgp) * v_buf(kv.ie, 1, igp, jgp, ilev);
+          dinv(kv.ie, 1, 0, igp, jgp) * v_buf(kv.ibuf, 0, igp, jgp, ilev) +
+          dinv(kv.ie, 1, 1, igp, jgp) * v_buf(kv.ibuf, 1, igp, jgp, ilev);
     });
   });
   kv.team_barrier();
+  stop_perf_region(GRADIENT_SPHERE);
 }
 
 KOKKOS_INLINE_FUNCTION void gradient_sphere_update(
@@ -276,6 +279,7 @@ KOKKOS_INLINE_FUNCTION void gradient_sphere_update(
           ExecViewUnmanaged<      Scalar*   [2][NP][NP][NUM_LEV]> v_buf,
           ExecViewUnmanaged<      Scalar    [2][NP][NP][NUM_LEV]> grad_s)
 {
+  start_perf_region(GRADIENT_SPHERE_UPDATE);
   constexpr int contra_iters = NP * NP;
   Kokkos::parallel_for(Kokkos::TeamThreadRange(kv.team, contra_iters),
                        [&](const int loop_idx) {
@@ -287,8 +291,8 @@ KOKKOS_INLINE_FUNCTION void gradient_sphere_update(
         dsdx += dvv(jgp, kgp) * scalar(igp, kgp, ilev);
         dsdy += dvv(jgp, kgp) * scalar(kgp, igp, ilev);
       }
-      v_buf(kv.ie, 0, igp, jgp, ilev) = dsdx * PhysicalConstants::rrearth;
-      v_buf(kv.ie, 1, jgp, igp, ilev) = dsdy * PhysicalConstants::rrearth;
+      v_buf(kv.ibuf, 0, igp, jgp, ilev) = dsdx * PhysicalConstants::rrearth;
+      v_buf(kv.ibuf, 1, jgp, igp, ilev) = dsdy * PhysicalConstants::rrearth;
     });
   });
   kv.team_barrier();
@@ -301,14 +305,15 @@ KOKKOS_INLINE_FUNCTION void gradient_sphere_update(
     const int jgp = loop_idx % NP;
     Kokkos::parallel_for(Kokkos::ThreadVectorRange(kv.team, NUM_LEV), [&] (const int& ilev) {
       grad_s(0, igp, jgp, ilev) +=
-          dinv(kv.ie, 0, 0, igp, jgp) * v_buf(kv.ie, 0, igp, jgp, ilev) +
-          dinv(kv.ie, 0, 1, igp, jgp) * v_buf(kv.ie, 1, igp, jgp, ilev);
+          dinv(kv.ie, 0, 0, igp, jgp) * v_buf(kv.ibuf, 0, igp, jgp, ilev) +
+          dinv(kv.ie, 0, 1, igp, jgp) * v_buf(kv.ibuf, 1, igp, jgp, ilev);
       grad_s(1, igp, jgp, ilev) +=
-          dinv(kv.ie, 1, 0, igp, jgp) * v_buf(kv.ie, 0, igp, jgp, ilev) +
-          dinv(kv.ie, 1, 1, igp, jgp) * v_buf(kv.ie, 1, igp, jgp, ilev);
+          dinv(kv.ie, 1, 0, igp, jgp) * v_buf(kv.ibuf, 0, igp, jgp, ilev) +
+          dinv(kv.ie, 1, 1, igp, jgp) * v_buf(kv.ibuf, 1, igp, jgp, ilev);
     });
   });
   kv.team_barrier();
+  stop_perf_region(GRADIENT_SPHERE_UPDATE);
 }
 
 KOKKOS_INLINE_FUNCTION void
@@ -320,17 +325,18 @@ divergence_sphere(const KernelVariables &kv,
                         ExecViewUnmanaged<      Scalar*  [2][NP][NP][NUM_LEV]> gv_buf,
                         ExecViewUnmanaged<      Scalar      [NP][NP][NUM_LEV]> div_v)
 {
+  start_perf_region(DIVERGENCE_SPHERE);
   constexpr int contra_iters = NP * NP;
   Kokkos::parallel_for(Kokkos::TeamThreadRange(kv.team, contra_iters),
                        [&](const int loop_idx) {
     const int igp = loop_idx / NP;
     const int jgp = loop_idx % NP;
     Kokkos::parallel_for(Kokkos::ThreadVectorRange(kv.team, NUM_LEV), [&] (const int& ilev) {
-      gv_buf(kv.ie, 0, igp, jgp, ilev) =
+      gv_buf(kv.ibuf, 0, igp, jgp, ilev) =
           (dinv(kv.ie, 0, 0, igp, jgp) * v(0, igp, jgp, ilev) +
            dinv(kv.ie, 1, 0, igp, jgp) * v(1, igp, jgp, ilev)) *
           metdet(kv.ie, igp, jgp);
-      gv_buf(kv.ie, 1, igp, jgp, ilev) =
+      gv_buf(kv.ibuf, 1, igp, jgp, ilev) =
           (dinv(kv.ie, 0, 1, igp, jgp) * v(0, igp, jgp, ilev) +
            dinv(kv.ie, 1, 1, igp, jgp) * v(1, igp, jgp, ilev)) *
           metdet(kv.ie, igp, jgp);
@@ -347,14 +353,15 @@ divergence_sphere(const KernelVariables &kv,
     Kokkos::parallel_for(Kokkos::ThreadVectorRange(kv.team, NUM_LEV), [&] (const int& ilev) {
       Scalar dudx, dvdy;
       for (int kgp = 0; kgp < NP; ++kgp) {
-        dudx += dvv(jgp, kgp) * gv_buf(kv.ie, 0, igp, kgp, ilev);
-        dvdy += dvv(igp, kgp) * gv_buf(kv.ie, 1, kgp, jgp, ilev);
+        dudx += dvv(jgp, kgp) * gv_buf(kv.ibuf, 0, igp, kgp, ilev);
+        dvdy += dvv(igp, kgp) * gv_buf(kv.ibuf, 1, kgp, jgp, ilev);
       }
       div_v(igp, jgp, ilev) =
           (dudx + dvdy) * (1.0 / metdet(kv.ie, igp, jgp) * PhysicalConstants::rrearth);
     });
   });
   kv.team_barrier();
+  stop_perf_region(DIVERGENCE_SPHERE);
 }
 
 // Note: this updates the field div_v as follows:
@@ -412,16 +419,17 @@ vorticity_sphere(const KernelVariables &kv,
                        ExecViewUnmanaged<      Scalar*   [2][NP][NP][NUM_LEV]> vcov_buf,
                        ExecViewUnmanaged<      Scalar       [NP][NP][NUM_LEV]> vort)
 {
+  start_perf_region(VORTICITY_SPHERE);
   constexpr int covar_iters = NP * NP;
   Kokkos::parallel_for(Kokkos::TeamThreadRange(kv.team, covar_iters),
                        [&](const int loop_idx) {
     const int igp = loop_idx / NP;
     const int jgp = loop_idx % NP;
     Kokkos::parallel_for(Kokkos::ThreadVectorRange(kv.team, NUM_LEV), [&] (const int& ilev) {
-      vcov_buf(kv.ie, 0, jgp, igp, ilev) =
+      vcov_buf(kv.ibuf, 0, jgp, igp, ilev) =
           d(kv.ie, 0, 0, jgp, igp) * u(jgp, igp, ilev) +
           d(kv.ie, 0, 1, jgp, igp) * v(jgp, igp, ilev);
-      vcov_buf(kv.ie, 1, jgp, igp, ilev) =
+      vcov_buf(kv.ibuf, 1, jgp, igp, ilev) =
           d(kv.ie, 1, 0, jgp, igp) * u(jgp, igp, ilev) +
           d(kv.ie, 1, 1, jgp, igp) * v(jgp, igp, ilev);
     });
@@ -436,14 +444,15 @@ vorticity_sphere(const KernelVariables &kv,
     Kokkos::parallel_for(Kokkos::ThreadVectorRange(kv.team, NUM_LEV), [&] (const int& ilev) {
       Scalar dudy, dvdx;
       for (int kgp = 0; kgp < NP; ++kgp) {
-        dvdx += dvv(jgp, kgp) * vcov_buf(kv.ie, 1, igp, kgp, ilev);
-        dudy += dvv(igp, kgp) * vcov_buf(kv.ie, 0, kgp, jgp, ilev);
+        dvdx += dvv(jgp, kgp) * vcov_buf(kv.ibuf, 1, igp, kgp, ilev);
+        dudy += dvv(igp, kgp) * vcov_buf(kv.ibuf, 0, kgp, jgp, ilev);
       }
       vort(igp, jgp, ilev) = (dvdx - dudy) * (1.0 / metdet(kv.ie, igp, jgp) *
                                               PhysicalConstants::rrearth);
     });
   });
   kv.team_barrier();
+  stop_perf_region(VORTICITY_SPHERE);
 }
 
 //Why does the prev version take u and v separately?
@@ -463,9 +472,9 @@ vorticity_sphere_vector(const KernelVariables &kv,
     const int igp = loop_idx / NP;
     const int jgp = loop_idx % NP;
     Kokkos::parallel_for(Kokkos::ThreadVectorRange(kv.team, NUM_LEV), [&] (const int& ilev) {
-      sphere_buf(kv.ie,0,igp,jgp,ilev) = d(kv.ie,0,0,igp,jgp) * v(0,igp,jgp,ilev)
+      sphere_buf(kv.ibuf,0,igp,jgp,ilev) = d(kv.ie,0,0,igp,jgp) * v(0,igp,jgp,ilev)
                                        + d(kv.ie,0,1,igp,jgp) * v(1,igp,jgp,ilev);
-      sphere_buf(kv.ie,1,igp,jgp,ilev) = d(kv.ie,1,0,igp,jgp) * v(0,igp,jgp,ilev)
+      sphere_buf(kv.ibuf,1,igp,jgp,ilev) = d(kv.ie,1,0,igp,jgp) * v(0,igp,jgp,ilev)
                                        + d(kv.ie,1,1,igp,jgp) * v(1,igp,jgp,ilev);
     });
   });
@@ -479,8 +488,8 @@ vorticity_sphere_vector(const KernelVariables &kv,
     Kokkos::parallel_for(Kokkos::ThreadVectorRange(kv.team, NUM_LEV), [&] (const int& ilev) {
       Scalar dudy, dvdx;
       for (int kgp = 0; kgp < NP; ++kgp) {
-        dvdx += dvv(jgp, kgp) * sphere_buf(kv.ie, 1, igp, kgp, ilev);
-        dudy += dvv(igp, kgp) * sphere_buf(kv.ie, 0, kgp, jgp, ilev);
+        dvdx += dvv(jgp, kgp) * sphere_buf(kv.ibuf, 1, igp, kgp, ilev);
+        dudy += dvv(igp, kgp) * sphere_buf(kv.ibuf, 0, kgp, jgp, ilev);
       }
       vort(igp, jgp, ilev) = (dvdx - dudy) * (1.0 / metdet(kv.ie, igp, jgp) *
                                               PhysicalConstants::rrearth);
@@ -505,9 +514,9 @@ divergence_sphere_wk(const KernelVariables &kv,
     const int igp = loop_idx / NP;
     const int jgp = loop_idx % NP;
     Kokkos::parallel_for(Kokkos::ThreadVectorRange(kv.team, NUM_LEV), [&] (const int& ilev) {
-      sphere_buf(kv.ie,0,igp,jgp,ilev) = dinv(kv.ie, 0, 0, igp, jgp) * v(0, igp, jgp, ilev)
+      sphere_buf(kv.ibuf,0,igp,jgp,ilev) = dinv(kv.ie, 0, 0, igp, jgp) * v(0, igp, jgp, ilev)
                                        + dinv(kv.ie, 1, 0, igp, jgp) * v(1, igp, jgp, ilev);
-      sphere_buf(kv.ie,1,igp,jgp,ilev) = dinv(kv.ie, 0, 1, igp, jgp) * v(0, igp, jgp, ilev)
+      sphere_buf(kv.ibuf,1,igp,jgp,ilev) = dinv(kv.ie, 0, 1, igp, jgp) * v(0, igp, jgp, ilev)
                                        + dinv(kv.ie, 1, 1, igp, jgp) * v(1, igp, jgp, ilev);
     });
   });
@@ -522,8 +531,8 @@ divergence_sphere_wk(const KernelVariables &kv,
       Scalar dd;
       // TODO: move multiplication by rrearth outside the loop
       for (int jgp = 0; jgp < NP; ++jgp) {
-        dd -= (spheremp(kv.ie, ngp, jgp) * sphere_buf(kv.ie, 0, ngp, jgp, ilev) * dvv(jgp, mgp) +
-               spheremp(kv.ie, jgp, mgp) * sphere_buf(kv.ie, 1, jgp, mgp, ilev) * dvv(jgp, ngp)) *
+        dd -= (spheremp(kv.ie, ngp, jgp) * sphere_buf(kv.ibuf, 0, ngp, jgp, ilev) * dvv(jgp, mgp) +
+               spheremp(kv.ie, jgp, mgp) * sphere_buf(kv.ibuf, 1, jgp, mgp, ilev) * dvv(jgp, ngp)) *
               PhysicalConstants::rrearth;
       }
       div_v(ngp, mgp, ilev) = dd;
@@ -573,9 +582,9 @@ laplace_tensor(const KernelVariables &kv,
     const int igp = loop_idx / NP;
     const int jgp = loop_idx % NP;
     Kokkos::parallel_for(Kokkos::ThreadVectorRange(kv.team, NUM_LEV), [&] (const int& ilev) {
-      sphere_buf(kv.ie,0,igp,jgp,ilev) = tensorVisc(kv.ie,0,0,igp,jgp) * grad_s(0,igp,jgp,ilev)
+      sphere_buf(kv.ibuf,0,igp,jgp,ilev) = tensorVisc(kv.ie,0,0,igp,jgp) * grad_s(0,igp,jgp,ilev)
                                        + tensorVisc(kv.ie,1,0,igp,jgp) * grad_s(1,igp,jgp,ilev);
-      sphere_buf(kv.ie,1,igp,jgp,ilev) = tensorVisc(kv.ie,0,1,igp,jgp) * grad_s(0,igp,jgp,ilev)
+      sphere_buf(kv.ibuf,1,igp,jgp,ilev) = tensorVisc(kv.ie,0,1,igp,jgp) * grad_s(0,igp,jgp,ilev)
                                        + tensorVisc(kv.ie,1,1,igp,jgp) * grad_s(1,igp,jgp,ilev);
     });
   });
@@ -586,8 +595,8 @@ laplace_tensor(const KernelVariables &kv,
     const int igp = loop_idx / NP;
     const int jgp = loop_idx % NP;
     Kokkos::parallel_for(Kokkos::ThreadVectorRange(kv.team, NUM_LEV), [&] (const int& ilev) {
-      grad_s(0,igp,jgp,ilev) = sphere_buf(kv.ie,0,igp,jgp,ilev);
-      grad_s(1,igp,jgp,ilev) = sphere_buf(kv.ie,1,igp,jgp,ilev);
+      grad_s(0,igp,jgp,ilev) = sphere_buf(kv.ibuf,0,igp,jgp,ilev);
+      grad_s(1,igp,jgp,ilev) = sphere_buf(kv.ibuf,1,igp,jgp,ilev);
     });
   });
   kv.team_barrier();
@@ -613,9 +622,9 @@ laplace_tensor_replace(const KernelVariables &kv,
     const int igp = loop_idx / NP;
     const int jgp = loop_idx % NP;
     Kokkos::parallel_for(Kokkos::ThreadVectorRange(kv.team, NUM_LEV), [&] (const int& ilev) {
-      sphere_buf(kv.ie,0,igp,jgp,ilev) = tensorVisc(kv.ie,0,0,igp,jgp) * grad_s(0,igp,jgp,ilev)
+      sphere_buf(kv.ibuf,0,igp,jgp,ilev) = tensorVisc(kv.ie,0,0,igp,jgp) * grad_s(0,igp,jgp,ilev)
                                        + tensorVisc(kv.ie,1,0,igp,jgp) * grad_s(1,igp,jgp,ilev);
-      sphere_buf(kv.ie,1,igp,jgp,ilev) = tensorVisc(kv.ie,0,1,igp,jgp) * grad_s(0,igp,jgp,ilev)
+      sphere_buf(kv.ibuf,1,igp,jgp,ilev) = tensorVisc(kv.ie,0,1,igp,jgp) * grad_s(0,igp,jgp,ilev)
                                        + tensorVisc(kv.ie,1,1,igp,jgp) * grad_s(1,igp,jgp,ilev);
     });
   });
@@ -626,8 +635,8 @@ laplace_tensor_replace(const KernelVariables &kv,
     const int igp = loop_idx / NP;
     const int jgp = loop_idx % NP;
     Kokkos::parallel_for(Kokkos::ThreadVectorRange(kv.team, NUM_LEV), [&] (const int& ilev) {
-      grad_s(0,igp,jgp,ilev) = sphere_buf(kv.ie,0,igp,jgp,ilev);
-      grad_s(1,igp,jgp,ilev) = sphere_buf(kv.ie,1,igp,jgp,ilev);
+      grad_s(0,igp,jgp,ilev) = sphere_buf(kv.ibuf,0,igp,jgp,ilev);
+      grad_s(1,igp,jgp,ilev) = sphere_buf(kv.ibuf,1,igp,jgp,ilev);
     });
   });
   kv.team_barrier();
@@ -651,8 +660,8 @@ curl_sphere_wk_testcov(const KernelVariables &kv,
     const int igp = loop_idx / NP; //slowest
     const int jgp = loop_idx % NP; //fastest
     Kokkos::parallel_for(Kokkos::ThreadVectorRange(kv.team, NUM_LEV), [&] (const int& ilev) {
-      sphere_buf(kv.ie, 0, igp, jgp, ilev) = 0.0;
-      sphere_buf(kv.ie, 1, igp, jgp, ilev) = 0.0;
+      sphere_buf(kv.ibuf, 0, igp, jgp, ilev) = 0.0;
+      sphere_buf(kv.ibuf, 1, igp, jgp, ilev) = 0.0;
     });
   });
   kv.team_barrier();
@@ -667,8 +676,8 @@ curl_sphere_wk_testcov(const KernelVariables &kv,
 //One can move multiplication by rrearth to the last loop, but it breaks BFB
 //property for curl.
     Kokkos::parallel_for(Kokkos::ThreadVectorRange(kv.team, NUM_LEV), [&] (const int& ilev) {
-      sphere_buf(kv.ie, 0, ngp, mgp, ilev) -= mp(kv.ie,jgp,mgp)*scalar(jgp,mgp,ilev)*dvv(jgp,ngp);
-      sphere_buf(kv.ie, 1, ngp, mgp, ilev) += mp(kv.ie,ngp,jgp)*scalar(ngp,jgp,ilev)*dvv(jgp,mgp);
+      sphere_buf(kv.ibuf, 0, ngp, mgp, ilev) -= mp(kv.ie,jgp,mgp)*scalar(jgp,mgp,ilev)*dvv(jgp,ngp);
+      sphere_buf(kv.ibuf, 1, ngp, mgp, ilev) += mp(kv.ie,ngp,jgp)*scalar(ngp,jgp,ilev)*dvv(jgp,mgp);
     });
   });
   kv.team_barrier();
@@ -678,11 +687,11 @@ curl_sphere_wk_testcov(const KernelVariables &kv,
     const int igp = loop_idx / NP; //slowest
     const int jgp = loop_idx % NP; //fastest
     Kokkos::parallel_for(Kokkos::ThreadVectorRange(kv.team, NUM_LEV), [&] (const int& ilev) {
-      curls(0,igp,jgp,ilev) = (D(kv.ie,0,0,igp,jgp)*sphere_buf(kv.ie, 0, igp, jgp, ilev)
-                             + D(kv.ie,1,0,igp,jgp)*sphere_buf(kv.ie, 1, igp, jgp, ilev))
+      curls(0,igp,jgp,ilev) = (D(kv.ie,0,0,igp,jgp)*sphere_buf(kv.ibuf, 0, igp, jgp, ilev)
+                             + D(kv.ie,1,0,igp,jgp)*sphere_buf(kv.ibuf, 1, igp, jgp, ilev))
                             * PhysicalConstants::rrearth;
-      curls(1,igp,jgp,ilev) = (D(kv.ie,0,1,igp,jgp)*sphere_buf(kv.ie, 0, igp, jgp, ilev)
-                             + D(kv.ie,1,1,igp,jgp)*sphere_buf(kv.ie, 1, igp, jgp, ilev))
+      curls(1,igp,jgp,ilev) = (D(kv.ie,0,1,igp,jgp)*sphere_buf(kv.ibuf, 0, igp, jgp, ilev)
+                             + D(kv.ie,1,1,igp,jgp)*sphere_buf(kv.ibuf, 1, igp, jgp, ilev))
                             * PhysicalConstants::rrearth;
     });
   });
@@ -707,8 +716,8 @@ grad_sphere_wk_testcov(const KernelVariables &kv,
     const int igp = loop_idx / NP; //slowest
     const int jgp = loop_idx % NP; //fastest
     Kokkos::parallel_for(Kokkos::ThreadVectorRange(kv.team, NUM_LEV), [&] (const int& ilev) {
-      sphere_buf(kv.ie, 0, igp, jgp, ilev) = 0.0;
-      sphere_buf(kv.ie, 1, igp, jgp, ilev) = 0.0;
+      sphere_buf(kv.ibuf, 0, igp, jgp, ilev) = 0.0;
+      sphere_buf(kv.ibuf, 1, igp, jgp, ilev) = 0.0;
     });
   });
   kv.team_barrier();
@@ -720,7 +729,7 @@ grad_sphere_wk_testcov(const KernelVariables &kv,
     const int mgp = (loop_idx / NP) % NP;
     const int jgp = loop_idx % NP; //fastest
     Kokkos::parallel_for(Kokkos::ThreadVectorRange(kv.team, NUM_LEV), [&] (const int& ilev) {
-      sphere_buf(kv.ie, 0, ngp, mgp, ilev) -=(
+      sphere_buf(kv.ibuf, 0, ngp, mgp, ilev) -=(
          mp(kv.ie,ngp,jgp)*
          metinv(kv.ie,0,0,ngp,mgp)*
          metdet(kv.ie,ngp,mgp)*
@@ -734,7 +743,7 @@ grad_sphere_wk_testcov(const KernelVariables &kv,
          dvv(jgp,ngp));
     //                            )*PhysicalConstants::rrearth;
 
-      sphere_buf(kv.ie, 1, ngp, mgp, ilev) -=(
+      sphere_buf(kv.ibuf, 1, ngp, mgp, ilev) -=(
          mp(kv.ie,ngp,jgp)*
          metinv(kv.ie,1,0,ngp,mgp)*
          metdet(kv.ie,ngp,mgp)*
@@ -758,11 +767,11 @@ grad_sphere_wk_testcov(const KernelVariables &kv,
     const int igp = loop_idx / NP; //slowest
     const int jgp = loop_idx % NP; //fastest
     Kokkos::parallel_for(Kokkos::ThreadVectorRange(kv.team, NUM_LEV), [&] (const int& ilev) {
-      grads(0,igp,jgp,ilev) = (D(kv.ie,0,0,igp,jgp)*sphere_buf(kv.ie, 0, igp, jgp, ilev)
-                             + D(kv.ie,1,0,igp,jgp)*sphere_buf(kv.ie, 1, igp, jgp, ilev))
+      grads(0,igp,jgp,ilev) = (D(kv.ie,0,0,igp,jgp)*sphere_buf(kv.ibuf, 0, igp, jgp, ilev)
+                             + D(kv.ie,1,0,igp,jgp)*sphere_buf(kv.ibuf, 1, igp, jgp, ilev))
                             * PhysicalConstants::rrearth;
-      grads(1,igp,jgp,ilev) = (D(kv.ie,0,1,igp,jgp)*sphere_buf(kv.ie, 0, igp, jgp, ilev)
-                             + D(kv.ie,1,1,igp,jgp)*sphere_buf(kv.ie, 1, igp, jgp, ilev))
+      grads(1,igp,jgp,ilev) = (D(kv.ie,0,1,igp,jgp)*sphere_buf(kv.ibuf, 0, igp, jgp, ilev)
+                             + D(kv.ie,1,1,igp,jgp)*sphere_buf(kv.ibuf, 1, igp, jgp, ilev))
                             * PhysicalConstants::rrearth;
     });
   });
@@ -0,0 +1,129 @@
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+
+namespace Homme {
+
+void Trace::init(const int num_threads, const int events_per_thread) {
+#if defined(HOMMEXX_CUDA_SPACE) ||                                             \
+    (defined(HOMMEXX_DEFAULT_SPACE) && defined(KOKKOS_ENABLE_CUDA))
+  // The host ring is written by the host, and there is no clock on the
+  // device anyway
+  std::cerr << "Tracing is not available on CUDA, ignored\n";
+#else
+  m_events = ExecViewManaged<Event **>("Trace events", num_threads + 1,
+                                       events_per_thread);
+  m_counts = ExecViewManaged<long * [8]>("Trace event counts", num_threads + 1);
+#endif
+}
+
+long Trace::num_events() const {
+  ExecViewManaged<long * [8]>::HostMirror h_counts =
+      Kokkos::create_mirror_view(m_counts);
+  Kokkos::deep_copy(h_counts, m_counts);
+  long num = 0;
+  for (int ring = 0; ring < h_counts.extent_int(0); ++ring) {
+    num += h_counts(ring, 0);
+  }
+  return num;
+}
+
+long Trace::num_dropped_events() const {
+  ExecViewManaged<long * [8]>::HostMirror h_counts =
+      Kokkos::create_mirror_view(m_counts);
+  Kokkos::deep_copy(h_counts, m_counts);
+  long num = 0;
+  for (int ring = 0; ring < h_counts.extent_int(0); ++ring) {
+    num += std::max<long>(0, h_counts(ring, 0) - m_events.extent_int(1));
+  }
+  return num;
+}
+
+void Trace::write(const std::string &file_name) const {
+  if (!enabled()) {
+    return;
+  }
+  ExecViewManaged<Event **>::HostMirror h_events =
+      Kokkos::create_mirror_view(m_events);
+  ExecViewManaged<long * [8]>::HostMirror h_counts =
+      Kokkos::create_mirror_view(m_counts);
+  Kokkos::deep_copy(h_events, m_events);
+  Kokkos::deep_copy(h_counts, m_counts);
+
+  const int num_rings = h_events.extent_int(0);
+  const long capacity = h_events.extent_int(1);
+
+  // The timestamps start at the first event kept
+  double origin = std::numeric_limits<double>::max();
+  for (int ring = 0; ring < num_rings; ++ring) {
+    const long num = std::min(h_counts(ring, 0), capacity);
+    for (long i = 0; i < num; ++i) {
+      origin = std::min(origin, h_events(ring, i).start);
+    }
+  }
+
+  std::ofstream out(file_name);
+  if (!out) {
+    std::cerr << "Failed to open " << file_name << " for writing\n";
+    std::abort();
+  }
+  out << std::fixed << std::setprecision(3) << "{\"traceEvents\":[\n";
+  for (int ring = 0; ring < num_rings; ++ring) {
+    out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << ring
+        << ",\"args\":{\"name\":\"";
+    if (ring == num_rings - 1) {
+      out << "host";
+    } else {
+      out << "thread " << ring;
+    }
+    out << "\"}},\n";
+  }
+  bool first = true;
+  for (int ring = 0; ring < num_rings; ++ring) {
+    // Oldest first, when the ring has wrapped around
+    const long count = h_counts(ring, 0);
+    for (long i = std::max(0L, count - capacity); i < count; ++i) {
+      const Event &event = h_events(ring, i % capacity);
+      if (!first) {
+        out << ",\n";
+      }
+      first = false;
+      out << "{\"name\":\"" << phase_name(static_cast<Phase>(event.phase))
+          << "\",\"cat\":\"caar\",\"ph\":\"X\",\"pid\":0,\"tid\":" << ring
+          << ",\"ts\":" << (event.start - origin) * 1e6
+          << ",\"dur\":" << (event.end - event.start) * 1e6;
+      if (event.ie >= 0) {
+        out << ",\"args\":{\"element\":" << event.ie << "}";
+      }
+      out << "}";
+    }
+  }
+  out << "\n]}\n";
+}
+
+const char *Trace::phase_name(const Phase phase) {
+  switch (phase) {
+  case TEMPERATURE_DIV_VDP:
+    return "temperature and div_vdp";
+  case SCAN:
+    return "scan";
+  case PHASE_3:
+    return "phase 3";
+  case DSS_START:
+    return "DSS start";
+  case DSS_UNPACK_INTERIOR:
+    return "DSS unpack interior";
+  case DSS_FINISH:
+    return "DSS finish";
+  case HISTORY:
+    return "history";
+  default:
+    return "unknown";
+  }
+}
+
+} // namespace Homme
@@ -0,0 +1,113 @@
+#ifndef HOMMEXX_TRACE_HPP
+#define HOMMEXX_TRACE_HPP
+
+#include "Types.hpp"
+#include "Utility.hpp"
+
+#include <string>
+
+namespace Homme {
+
+/* Timeline of the CAAR phases: which thread ran which phase of which
+ * element, and when.
+ *
+ * Each thread records its events into its own ring buffer, without locks or
+ * atomics. When a ring is full, the oldest events are overwritten. The host
+ * has a ring of its own for the work done between the kernels, e.g. the
+ * DSS. write() dumps all the rings in the Chrome trace format, which can be
+ * opened in chrome://tracing or Perfetto.
+ *
+ * The threads are told apart with kernel_thread_id(), their rank in the
+ * thread pool of the execution space. On CUDA nothing is recorded.
+ */
+class Trace {
+public:
+  enum Phase : int {
+    TEMPERATURE_DIV_VDP = 0,
+    SCAN,
+    PHASE_3,
+    DSS_START,
+    DSS_UNPACK_INTERIOR,
+    DSS_FINISH,
+    HISTORY,
+    NUM_PHASES
+  };
+
+  struct Event {
+    double start;
+    double end;
+    int phase;
+    // The element, or -1 for the events of the host
+    int ie;
+  };
+
+  Trace() = default;
+
+  // Rings of events_per_thread events for each of the num_threads threads,
+  // and one for the host. Tracing is off until init is called
+  void init(const int num_threads, const int events_per_thread);
+
+  KOKKOS_INLINE_FUNCTION
+  bool enabled() const { return m_events.extent_int(1) > 0; }
+
+  // The time to pass to record, or 0 if tracing is off
+  KOKKOS_INLINE_FUNCTION
+  double start() const { return (enabled() ? kernel_seconds() : 0.0); }
+
+  // Records the phase of element ie started at start, once per team
+  KOKKOS_INLINE_FUNCTION
+  void record(const TeamMember &team, const Phase phase, const int ie,
+              const double start) const {
+    if (enabled()) {
+      const double end = kernel_seconds();
+      Kokkos::single(Kokkos::PerTeam(team),
+                     [&]() { push(thread_id(), phase, ie, start, end); });
+    }
+  }
+
+  // Records work done by the host between the kernels
+  void record_host(const Phase phase, const double start) const {
+    if (enabled()) {
+      push(m_events.extent_int(0) - 1, phase, -1, start, kernel_seconds());
+    }
+  }
+
+  // The number of events recorded, and of those lost to full rings
+  long num_events() const;
+  long num_dropped_events() const;
+
+  // Writes the events in the Chrome trace JSON format, with one row per
+  // thread
+  void write(const std::string &file_name) const;
+
+  static const char *phase_name(const Phase phase);
+
+private:
+  KOKKOS_INLINE_FUNCTION
+  int thread_id() const {
+    const int id = kernel_thread_id();
+    return (id < m_events.extent_int(0) - 1 ? id : 0);
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  void push(const int ring, const int phase, const int ie, const double start,
+            const double end) const {
+    const long count = m_counts(ring, 0);
+    Event &event = m_events(ring, count % m_events.extent_int(1));
+    event.start = start;
+    event.end = end;
+    event.phase = phase;
+    event.ie = ie;
+    m_counts(ring, 0) = count + 1;
+  }
+
+  // One ring per thread, and the host ring last
+  ExecViewManaged<Event **> m_events;
+  // The number of events pushed to each ring, padded to a cache line to
+  // keep the threads from sharing it
+  ExecViewManaged<long * [8]> m_counts;
+};
+
+} // namespace Homme
+
+#endif // HOMMEXX_TRACE_HPP
@@ -8,6 +8,8 @@
 
 #include <vector/KokkosKernels_Vector.hpp>
 
+#include <type_traits>
+
 #ifdef HAVE_CONFIG_H
 #include "config.h.c"
 #endif
@@ -26,15 +28,20 @@ using F90Ptr = Real *const; // Using this in a function signature emphasizes
 using CF90Ptr = const Real *const; // Using this in a function signature
                                    // emphasizes that the ordering is Fortran
 
+// How the threads are spread over the work of a CAAR step:
+//  - ELEMENTS: one thread per team, the threads take different elements
+//  - LEVELS: all the threads in one team, which splits the (GLL point,
+//    level chunk) pairs of one element at a time
+//  - HYBRID: as many teams as elements (or threads), the threads left over
+//    split the (GLL point, level chunk) pairs of the element of their team
+//  - AUTO: ELEMENTS if there are at least as many elements as threads,
+//    HYBRID otherwise
+enum class ThreadingStrategy { ELEMENTS, LEVELS, HYBRID, AUTO };
+
 template <typename ExecSpace> struct ThreadsDistribution {
 
   static int teams_per_league (const int num_elems) {
-    if (s_num_avail_threads==0) {
-      s_num_avail_threads = ExecSpace::thread_pool_size();
-    }
-    if (s_team_size==0) {
-      set_team_size(num_elems);
-    }
+    init(num_elems);
     return s_num_avail_threads /
             (s_team_size * vectors_per_thread());
   }
@@ -42,20 +49,51 @@ template <typename ExecSpace> struct ThreadsDistribution {
   static constexpr int vectors_per_thread() { return 1; }
 
   static int threads_per_team(const int num_elems) {
+    init(num_elems);
+    return s_team_size;
+  }
+
+  // The number of chunks the levels of an element are split in, so that
+  // the threads of a team have (GLL point, level chunk) pairs to share
+  static int level_chunks(const int num_elems) {
+    init(num_elems);
+    if (s_strategy == ThreadingStrategy::ELEMENTS) {
+      return 1;
+    }
+    const int chunks = (s_team_size + NP * NP - 1) / (NP * NP);
+    return (chunks < NUM_LEV ? chunks : NUM_LEV);
+  }
+
+  // Must be called before the first query. The default is AUTO, unless
+  // KOKKOS_THREAD_ON_ELEMENTS or KOKKOS_THREAD_ON_LEVELS is defined
+  static void set_strategy(const ThreadingStrategy strategy) {
+    s_strategy = strategy;
+    s_team_size = 0;
+  }
+
+  // The strategy in use, with AUTO resolved
+  static ThreadingStrategy strategy(const int num_elems) {
+    init(num_elems);
+    return s_strategy;
+  }
+
+private:
+
+  static void init(const int num_elems) {
     if (s_num_avail_threads==0) {
       s_num_avail_threads = ExecSpace::thread_pool_size();
     }
     if (s_team_size==0) {
+      if (s_strategy == ThreadingStrategy::AUTO) {
+        s_strategy = (num_elems >= s_num_avail_threads
+                          ? ThreadingStrategy::ELEMENTS
+                          : ThreadingStrategy::HYBRID);
+      }
       set_team_size(num_elems);
     }
-    return s_team_size;
   }
 
-private:
-
-#ifdef KOKKOS_THREAD_ON_ELEMENTS
   static void set_team_size(const int num_elems) {
-
     const char* var;
     var = getenv("HOMMEXX_TEAM_SIZE");
     if (var!=0)
@@ -64,32 +102,35 @@ private:
       // that it is at least 1, and no larger than the thread pool size
       s_team_size = std::max(std::atoi(var),1);
       s_team_size = std::min(s_team_size, s_num_avail_threads);
-    } else {
-      // The user did not request a team size. We parallelize as much as
-      // possible over elements
+    } else if (s_strategy == ThreadingStrategy::HYBRID) {
+      // We parallelize as much as possible over elements
       if (s_num_avail_threads >= num_elems) {
         s_team_size = s_num_avail_threads / num_elems;
       } else {
         s_team_size = 1;
       }
+    } else if (s_strategy == ThreadingStrategy::LEVELS) {
+      s_team_size = s_num_avail_threads;
+    } else {
+      s_team_size = 1;
     }
   }
-#else
-#ifdef KOKKOS_THREAD_ON_LEVELS
-  static void set_team_size(const int /*num_elems*/) {
-    s_team_size = s_num_avail_threads;
-  }
-#else
-  static void set_team_size(const int /*num_elems*/) {
-    s_team_size = 1;
-  }
-#endif // KOKKOS_THREAD_ON_LEVELS
-#endif // KOKKOS_THREAD_ON_ELEMENTS
 
+  static ThreadingStrategy s_strategy;
   static int s_team_size;
   static int s_num_avail_threads;
 };
 
+template<typename ExecSpace>
+ThreadingStrategy ThreadsDistribution<ExecSpace>::s_strategy =
+#if defined(KOKKOS_THREAD_ON_ELEMENTS)
+    ThreadingStrategy::HYBRID;
+#elif defined(KOKKOS_THREAD_ON_LEVELS)
+    ThreadingStrategy::LEVELS;
+#else
+    ThreadingStrategy::AUTO;
+#endif
+
 template<typename ExecSpace>
 int ThreadsDistribution<ExecSpace>::s_team_size = 0;
 
@@ -109,6 +150,13 @@ template <> struct ThreadsDistribution<Kokkos::Cuda> {
     return Max_Threads_Per_Team;
   }
 
+  // The threads of a team split the GLL points, the vector lanes the levels
+  static int level_chunks(const int /*num_elems*/) { return 1; }
+  static void set_strategy(const ThreadingStrategy /*strategy*/) {}
+  static ThreadingStrategy strategy(const int /*num_elems*/) {
+    return ThreadingStrategy::HYBRID;
+  }
+
 private:
   static constexpr int Max_Threads_Per_Team = 8;
 };
@@ -151,6 +199,11 @@ using ExecMemSpace = ExecSpace::memory_space;
 using ScratchMemSpace = ExecSpace::scratch_memory_space;
 using HostMemSpace = Kokkos::HostSpace;
 
+// Whether the kernels run on the host threads. Only there are all the teams
+// of a league of at most one team per thread resident at the same time
+static constexpr bool EXEC_SPACE_IS_HOST =
+    std::is_same<ExecMemSpace, HostMemSpace>::value;
+
 // A team member type
 using TeamMember = Kokkos::TeamPolicy<ExecSpace>::member_type;
 
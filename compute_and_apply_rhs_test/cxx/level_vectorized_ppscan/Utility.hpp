@@ -3,6 +3,12 @@
 
 #include "Types.hpp"
 
+#include <chrono>
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
 #ifndef NDEBUG
 #define DEBUG_PRINT(...)                                                       \
   { printf(__VA_ARGS__); }
@@ -13,6 +19,48 @@
 
 namespace Homme {
 
+// Seconds on a steady clock, readable within kernels. Only meaningful on the
+// host: zero on CUDA
+KOKKOS_INLINE_FUNCTION
+double kernel_seconds() {
+#ifdef __CUDA_ARCH__
+  return 0.0;
+#else
+  return std::chrono::duration<double>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+#endif
+}
+
+// The rank of the calling thread in the thread pool of ExecSpace. Serial
+// has a single thread, and on CUDA the per-thread features are off
+template <typename ExecSpace> struct ThreadRank {
+  KOKKOS_INLINE_FUNCTION static int get() { return 0; }
+};
+
+#ifdef KOKKOS_HAVE_OPENMP
+template <> struct ThreadRank<Kokkos::OpenMP> {
+  static int get() { return omp_get_thread_num(); }
+};
+#endif // KOKKOS_HAVE_OPENMP
+
+#ifdef KOKKOS_HAVE_PTHREAD
+template <> struct ThreadRank<Kokkos::Threads> {
+  static int get() { return Kokkos::Threads::thread_pool_rank(); }
+};
+#endif // KOKKOS_HAVE_PTHREAD
+
+// The thread of the execution space running the caller, in
+// [0, ExecSpace::concurrency())
+KOKKOS_INLINE_FUNCTION
+int kernel_thread_id() {
+#ifdef __CUDA_ARCH__
+  return 0;
+#else
+  return ThreadRank<ExecSpace>::get();
+#endif
+}
+
 // ================ Subviews of 2d views ======================= //
 // Note: we still template on ScalarType (should always be Homme::Real here)
 //       to allow const/non-const version
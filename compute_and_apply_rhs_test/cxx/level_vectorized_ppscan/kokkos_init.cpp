@@ -1,14 +1,33 @@
 
 #include "Types.hpp"
+#include "AttainableBandwidth.hpp"
 #include "Control.hpp"
 #include "Elements.hpp"
 #include "Derivative.hpp"
+#include "Diagnostics.hpp"
 #include "CaarFunctor.hpp"
+#include "Connectivity.hpp"
+#include "CubedSphere.hpp"
+#include "BoundaryExchange.hpp"
+#include "HistoryOutput.hpp"
+#include "HotTimers.hpp"
+#include "PerfCounters.hpp"
+#include "LoadBalance.hpp"
+#include "Trace.hpp"
 
 #include "profiling.hpp"
 
+#include <algorithm>
 #include <iostream>
 #include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
 
 using namespace Homme;
 
@@ -57,14 +76,295 @@ void flush_caches(HostViewManaged<Real *> &trash) {
 
 void finalize_kokkos() { Kokkos::finalize(); }
 
+// Returns the value of the command line option '--name=value', or
+// default_value if the option is not present
+int get_option(int argc, char **argv, const std::string &name,
+               const int default_value) {
+  const std::string prefix = "--" + name + "=";
+  for (int iarg = 1; iarg < argc; ++iarg) {
+    if (std::strncmp(argv[iarg], prefix.c_str(), prefix.size()) == 0) {
+      return atoi(argv[iarg] + prefix.size());
+    }
+  }
+  return default_value;
+}
+
+// Returns the value of the command line option '--name=value' as a string,
+// or default_value if the option is not present
+std::string get_string_option(int argc, char **argv, const std::string &name,
+                              const std::string &default_value) {
+  const std::string prefix = "--" + name + "=";
+  for (int iarg = 1; iarg < argc; ++iarg) {
+    if (std::strncmp(argv[iarg], prefix.c_str(), prefix.size()) == 0) {
+      return argv[iarg] + prefix.size();
+    }
+  }
+  return default_value;
+}
+
+// Parses the value of --threading
+ThreadingStrategy threading_strategy(const std::string &name) {
+  if (name == "elements") {
+    return ThreadingStrategy::ELEMENTS;
+  } else if (name == "levels") {
+    return ThreadingStrategy::LEVELS;
+  } else if (name == "hybrid") {
+    return ThreadingStrategy::HYBRID;
+  } else if (name == "auto") {
+    return ThreadingStrategy::AUTO;
+  }
+  std::cerr << "Unknown threading strategy " << name
+            << ", expected elements, levels, hybrid or auto\n";
+  std::abort();
+}
+
+const char *threading_strategy_name(const ThreadingStrategy strategy) {
+  switch (strategy) {
+  case ThreadingStrategy::ELEMENTS:
+    return "elements";
+  case ThreadingStrategy::LEVELS:
+    return "levels";
+  case ThreadingStrategy::HYBRID:
+    return "hybrid";
+  default:
+    return "auto";
+  }
+}
+
+// Returns the index-th argument not starting with '--', or nullptr
+const char *get_positional(int argc, char **argv, const int index) {
+  for (int iarg = 1, ipos = 0; iarg < argc; ++iarg) {
+    if (std::strncmp(argv[iarg], "--", 2) != 0 && ipos++ == index) {
+      return argv[iarg];
+    }
+  }
+  return nullptr;
+}
+
+// Launches the CaarFunctor specialization matching rsplit and qn0
+void dispatch_caar(const Kokkos::TeamPolicy<ExecSpace> &policy,
+                   const CaarFunctor &func) {
+  func.reset_schedule();
+  const bool rsplit_zero = (func.m_data.rsplit == 0);
+  const bool has_tracers = (func.m_data.qn0 != -1);
+  if (rsplit_zero && has_tracers) {
+    Kokkos::parallel_for(policy, CaarFunctorImpl<true, true>(func));
+  } else if (rsplit_zero) {
+    Kokkos::parallel_for(policy, CaarFunctorImpl<true, false>(func));
+  } else if (has_tracers) {
+    Kokkos::parallel_for(policy, CaarFunctorImpl<false, true>(func));
+  } else {
+    Kokkos::parallel_for(policy, CaarFunctorImpl<false, false>(func));
+  }
+}
+
+// The number of teams which can run at the same time
+int num_concurrent_teams(const int threads_per_team) {
+  return std::max(1, ExecSpace::concurrency() / threads_per_team);
+}
+
+// The number of consecutive elements handed to a team at once, so that each
+// concurrent team gets one contiguous range of the league
+int contiguous_chunk_size(const int num_elems, const int threads_per_team) {
+  const int num_teams = num_concurrent_teams(threads_per_team);
+  return (num_elems + num_teams - 1) / num_teams;
+}
+
+// The policy of a CAAR dispatch over num_elems elements. When the functor
+// runs on element chunks, there is one team per concurrent chunk, each with
+// its own slots in the buffers
+Kokkos::TeamPolicy<ExecSpace> caar_policy(const CaarFunctor &func,
+                                          const int num_elems,
+                                          const int threads_per_team,
+                                          const int vectors_per_thread,
+                                          const int chunk_size) {
+  int league_size = num_elems;
+  int policy_chunk_size = chunk_size;
+  if (func.m_chunk_elems > 0) {
+    league_size = std::min(num_concurrent_teams(threads_per_team),
+                           (num_elems + func.m_chunk_elems - 1) /
+                               func.m_chunk_elems);
+    policy_chunk_size = 1;
+  }
+  Kokkos::TeamPolicy<ExecSpace> policy(league_size, threads_per_team,
+                                       vectors_per_thread);
+  policy.set_chunk_size(policy_chunk_size);
+  return policy;
+}
+
+// Launches the CaarFunctor on a subset of the elements
+void dispatch_caar(const ExecViewManaged<int *> &elem_ids,
+                   const int threads_per_team, const int vectors_per_thread,
+                   const int chunk_size, CaarFunctor func) {
+  if (elem_ids.extent_int(0) == 0) {
+    // An empty list would select all the elements
+    return;
+  }
+  func.set_elements(elem_ids);
+  dispatch_caar(caar_policy(func, elem_ids.extent_int(0), threads_per_team,
+                            vectors_per_thread, chunk_size),
+                func);
+}
+
+// Seconds to run num_exec steps of CAAR, each followed by the DSS
+double time_caar_dss(const Kokkos::TeamPolicy<ExecSpace> &policy,
+                     const CaarFunctor &func, const Connectivity &connectivity,
+                     const Elements &elem, const int num_exec) {
+  BoundaryExchange dss(connectivity, elem);
+  ExecSpace::fence();
+  const auto start = clock_type::now();
+  for (int exec = 0; exec < num_exec; ++exec) {
+    dispatch_caar(policy, func);
+    ExecSpace::fence();
+    dss.exchange(func.m_data.np1);
+  }
+  return std::chrono::duration_cast<ns>(clock_type::now() - start).count() *
+         1e-9;
+}
+
+// Seconds to run num_exec steps of CAAR alone
+double time_caar(const Kokkos::TeamPolicy<ExecSpace> &policy,
+                 const CaarFunctor &func, const int num_exec) {
+  ExecSpace::fence();
+  const auto start = clock_type::now();
+  for (int exec = 0; exec < num_exec; ++exec) {
+    dispatch_caar(policy, func);
+  }
+  ExecSpace::fence();
+  return std::chrono::duration_cast<ns>(clock_type::now() - start).count() *
+         1e-9;
+}
+
+// Runs num_exec steps of CAAR alone with the static or the dynamic schedule,
+// and accounts them in load
+void time_caar_schedule(const Kokkos::TeamPolicy<ExecSpace> &policy,
+                        CaarFunctor func, const bool dynamic_schedule,
+                        LoadBalance &load, const int num_exec) {
+  func.set_dynamic_schedule(dynamic_schedule);
+  func.set_team_times(load.team_times());
+  for (int exec = 0; exec < num_exec; ++exec) {
+    ExecSpace::fence();
+    const auto start = clock_type::now();
+    dispatch_caar(policy, func);
+    ExecSpace::fence();
+    load.end_step(
+        std::chrono::duration_cast<ns>(clock_type::now() - start).count() *
+        1e-9);
+  }
+}
+
+// Does nothing, to time the launch of a kernel alone
+struct EmptyTeamKernel {
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const TeamMember &) const {}
+};
+
+double quantile(const std::vector<double> &sorted, const double q) {
+  const int index = static_cast<int>(std::ceil(q * sorted.size())) - 1;
+  return sorted[std::max(0, std::min<int>(index, sorted.size() - 1))];
+}
+
+// Prints the median, 99th percentile and maximum of the samples, in
+// microseconds
+void print_latency(const char *name, std::vector<double> seconds) {
+  std::sort(seconds.begin(), seconds.end());
+  std::cout << "   " << name << ": median " << quantile(seconds, 0.5) * 1e6
+            << ", p99 " << quantile(seconds, 0.99) * 1e6 << ", max "
+            << quantile(seconds, 1.0) * 1e6 << "\n";
+}
+
+// Times num_samples steps of CAAR on num_elems elements, then on half as
+// many, down to one element per thread. The cost of launching an empty
+// kernel and of a fence with nothing to wait for are timed apart from the
+// steps, which include both. On chunks with the static schedule, and on a
+// host execution space, the steps of a persistent launch are timed too
+void latency_benchmark(CaarFunctor func, const int num_elems,
+                       const int threads_per_team,
+                       const int vectors_per_thread, const int num_samples) {
+  const int min_elems = std::min(num_elems, ExecSpace::concurrency());
+  std::vector<int> elem_counts;
+  for (int count = num_elems; count > min_elems; count /= 2) {
+    elem_counts.push_back(count);
+  }
+  elem_counts.push_back(min_elems);
+
+  for (const int count : elem_counts) {
+    ExecViewManaged<int *> elem_ids("Elements of the latency benchmark",
+                                    count);
+    ExecViewManaged<int *>::HostMirror h_elem_ids =
+        Kokkos::create_mirror_view(elem_ids);
+    for (int ie = 0; ie < count; ++ie) {
+      h_elem_ids(ie) = ie;
+    }
+    Kokkos::deep_copy(elem_ids, h_elem_ids);
+    func.set_elements(elem_ids);
+
+    const Kokkos::TeamPolicy<ExecSpace> policy =
+        caar_policy(func, count, threads_per_team, vectors_per_thread, 1);
+    const Kokkos::TeamPolicy<ExecSpace> empty_policy(
+        policy.league_size(), threads_per_team, vectors_per_thread);
+
+    std::vector<double> launch_seconds, fence_seconds, step_seconds;
+    auto seconds_since = [](const clock_type::time_point &start) {
+      return std::chrono::duration_cast<ns>(clock_type::now() - start)
+                 .count() *
+             1e-9;
+    };
+    for (int sample = 0; sample < num_samples; ++sample) {
+      ExecSpace::fence();
+      auto start = clock_type::now();
+      Kokkos::parallel_for(empty_policy, EmptyTeamKernel());
+      launch_seconds.push_back(seconds_since(start));
+      ExecSpace::fence();
+
+      start = clock_type::now();
+      ExecSpace::fence();
+      fence_seconds.push_back(seconds_since(start));
+
+      start = clock_type::now();
+      dispatch_caar(policy, func);
+      ExecSpace::fence();
+      step_seconds.push_back(seconds_since(start));
+    }
+
+    std::cout << "Latency on " << count << " elements, "
+              << static_cast<double>(count) / ExecSpace::concurrency()
+              << " per thread, " << policy.league_size()
+              << " teams, microseconds:\n";
+    print_latency("empty launch", launch_seconds);
+    print_latency("fence", fence_seconds);
+    print_latency("step", step_seconds);
+
+    if (EXEC_SPACE_IS_HOST && func.m_chunk_elems > 0 &&
+        !func.m_dynamic_schedule && num_samples > 1) {
+      CaarFunctor persistent = func;
+      persistent.set_persistent_steps(num_samples);
+      dispatch_caar(policy, persistent);
+      ExecSpace::fence();
+      ExecViewManaged<double *>::HostMirror end_times =
+          Kokkos::create_mirror_view(persistent.m_step_end_times);
+      Kokkos::deep_copy(end_times, persistent.m_step_end_times);
+      // The first step includes the launch
+      std::vector<double> persistent_seconds;
+      for (int step = 1; step < num_samples; ++step) {
+        persistent_seconds.push_back(end_times(step) - end_times(step - 1));
+      }
+      print_latency("persistent step", persistent_seconds);
+    }
+  }
+}
+
 int main(int argc, char **argv) {
   constexpr int tstep = 600;
 
   init_kokkos();
   GPTLinitialize();
-
-  constexpr int threads_per_team = 4;
-  constexpr int vectors_per_thread = 1;
+  HotTimers::init(ExecSpace::concurrency());
+  // Option: --perf=1 reads the hardware counters of the CAAR phases and of
+  // the sphere operators, see PerfCounters
+  if (get_option(argc, argv, "perf", 0)) {
+    PerfCounters::init(ExecSpace::concurrency());
+  }
 
   std::random_device rd;
   std::mt19937_64 rng(rd());
@@ -73,7 +373,9 @@ int main(int argc, char **argv) {
   data.nm1 = 0;
   data.n0 = 1;
   data.np1 = 2;
-  data.qn0 = -1;
+  // Options: --rsplit=N (default 1), --qn0=N (default -1, i.e. no tracers)
+  data.qn0 = get_option(argc, argv, "qn0", -1);
+  data.rsplit = get_option(argc, argv, "rsplit", 1);
   data.dt = tstep;
   data.ps0 = 1.0;
   data.eta_ave_w = 1.0;
@@ -83,13 +385,49 @@ int main(int argc, char **argv) {
   genRandArray(data.hybrid_a, rng,
                std::uniform_real_distribution<Real>(1.0, 2.0));
 
+  // hybi goes from 0 at the model top to 1 at the surface
+  data.hybrid_b = ExecViewManaged<Scalar[NUM_LEV_P]>(
+      "Hybrid coordinates at the interfaces; multiply the surface pressure");
+  ExecViewManaged<Scalar[NUM_LEV_P]>::HostMirror host_hybrid_b =
+      Kokkos::create_mirror_view(data.hybrid_b);
+  for (int ilevel = 0; ilevel < NUM_INTERFACE_LEV; ++ilevel) {
+    host_hybrid_b(ilevel / VECTOR_SIZE)[ilevel % VECTOR_SIZE] =
+        static_cast<Real>(ilevel) / NUM_PHYSICAL_LEV;
+  }
+  Kokkos::deep_copy(data.hybrid_b, host_hybrid_b);
+
   int num_elems = 32;
-  if (argc > 1) {
-    num_elems = atoi(argv[1]);
+  if (get_positional(argc, argv, 0) != nullptr) {
+    num_elems = atoi(get_positional(argc, argv, 0));
   }
 
+  // Options: --ne=N runs on a cubed sphere of N x N x 6 elements, with the
+  // DSS of the fields after each step, --plane=1 replaces the sphere by a
+  // periodic plane of N x N elements with random geometry, --ranks=N splits
+  // the mesh in N emulated ranks, and --overlap=0 disables the overlap of
+  // the exchange with the next step
+  const int ne = get_option(argc, argv, "ne", 0);
+  const bool plane = get_option(argc, argv, "plane", 0);
+  const int num_ranks = get_option(argc, argv, "ranks", 1);
+  const bool overlap = get_option(argc, argv, "overlap", 1);
+  Connectivity connectivity;
   Elements elem;
-  elem.random_init(num_elems, rng);
+  if (ne > 0 && !plane) {
+    connectivity.init_cubed_sphere(ne, num_ranks);
+    num_elems = connectivity.num_elems();
+    elem.cubed_sphere_init(ne, rng);
+  } else {
+    if (ne > 0) {
+      connectivity.init_periodic_plane(ne, num_ranks);
+      num_elems = connectivity.num_elems();
+    }
+    elem.random_init(num_elems, rng);
+  }
+  if (data.rsplit > 0) {
+    // eta_dot_dpdn is identically zero for vertically lagrangian dynamics,
+    // so the rsplit > 0 specializations of the functor do not touch it
+    Kokkos::deep_copy(elem.m_eta_dot_dpdn, Scalar(0.0));
+  }
 
   Derivative deriv;
   deriv.random_init(rng);
@@ -98,12 +436,225 @@ int main(int argc, char **argv) {
   constexpr int rk_stages = 5;
   int num_exec = (seconds_per_day / tstep) * rk_stages;
 
-  if (argc > 2) {
-    num_exec = atoi(argv[2]);
+  if (get_positional(argc, argv, 1) != nullptr) {
+    num_exec = atoi(get_positional(argc, argv, 1));
+  }
+
+  // Option: --threading=elements|levels|hybrid|auto spreads the threads over
+  // the elements, over the levels of one element, or both. See
+  // ThreadingStrategy
+  const std::string threading = get_string_option(argc, argv, "threading", "");
+  if (!threading.empty()) {
+    ThreadsDistribution<ExecSpace>::set_strategy(threading_strategy(threading));
+  }
+  const int threads_per_team =
+      ThreadsDistribution<ExecSpace>::threads_per_team(num_elems);
+  const int vectors_per_thread =
+      ThreadsDistribution<ExecSpace>::vectors_per_thread();
+  const int level_chunks =
+      ThreadsDistribution<ExecSpace>::level_chunks(num_elems);
+  std::cout << "Threading over "
+            << threading_strategy_name(
+                   ThreadsDistribution<ExecSpace>::strategy(num_elems))
+            << ": " << threads_per_team << " threads per team, "
+            << vectors_per_thread << " vector lanes per thread, levels in "
+            << level_chunks << " chunks\n";
+
+  // Write the history every --history-freq steps; 0 disables it
+  const int history_freq = get_option(argc, argv, "history-freq", 0);
+  const int history_lev_stride =
+      get_option(argc, argv, "history-lev-stride", 1);
+  // Compute the norm and conservation diagnostics within the kernel
+  data.compute_diagonstics = get_option(argc, argv, "diagnostics", 0);
+  Diagnostics diagnostics;
+  diagnostics.init(num_elems);
+
+  std::unique_ptr<HistoryOutput> history;
+  if (history_freq > 0) {
+    history.reset(new HistoryOutput("history.dat", num_elems,
+                                    history_lev_stride));
+  }
+
+  // Option: --chunk=N runs the CAAR phases on chunks of N elements, with
+  // buffers for the chunks of the concurrent teams only. --chunk=-1 sizes
+  // the chunks so that their buffers fit in the L2 cache
+  int chunk_elems = get_option(argc, argv, "chunk", 0);
+  // Options: --schedule=dynamic lets the teams take the chunks as they
+  // become free, instead of a fixed range each. --schedule-benchmark=1 first
+  // times the steps with both schedules. Both run on chunks, of 1 element
+  // unless --chunk says otherwise
+  const std::string schedule =
+      get_string_option(argc, argv, "schedule", "static");
+  if (schedule != "static" && schedule != "dynamic") {
+    std::cerr << "Unknown schedule " << schedule
+              << ", expected static or dynamic\n";
+    std::abort();
+  }
+  const bool dynamic_schedule = (schedule == "dynamic");
+  const bool schedule_benchmark =
+      get_option(argc, argv, "schedule-benchmark", 0);
+  // Options: --persistent=1 runs all the steps in a single launch, with the
+  // threads kept resident and a barrier between the steps, on the host
+  // execution spaces only. --latency=N first
+  // times N steps on fewer and fewer elements, see latency_benchmark. Both
+  // run on chunks too
+  const bool persistent = get_option(argc, argv, "persistent", 0);
+  const int latency_samples = get_option(argc, argv, "latency", 0);
+  if (persistent && !EXEC_SPACE_IS_HOST) {
+    std::cerr << "--persistent requires a host execution space\n";
+    std::abort();
+  }
+  if (persistent && dynamic_schedule) {
+    std::cerr << "--persistent requires the static schedule\n";
+    std::abort();
+  }
+  if (persistent && (ne > 0 || history)) {
+    std::cerr << "--persistent cannot run the DSS or the history output "
+                 "between the steps\n";
+    std::abort();
+  }
+  if (chunk_elems == 0 && (dynamic_schedule || schedule_benchmark ||
+                           persistent || latency_samples > 0)) {
+    chunk_elems = 1;
+  }
+  if (chunk_elems < 0) {
+    const long l2_bytes = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    chunk_elems = std::max<long>(
+        1, (l2_bytes > 0 ? l2_bytes : 1024 * 1024) /
+               Elements::BufferViews::caar_bytes_per_slot());
+  }
+
+  // The busy time of the teams when running on chunks
+  LoadBalance load;
+  if (chunk_elems > 0) {
+    chunk_elems = std::min(chunk_elems, num_elems);
+    // One group of slots per team of caar_policy
+    const int num_teams =
+        std::min(num_concurrent_teams(threads_per_team),
+                 (num_elems + chunk_elems - 1) / chunk_elems);
+    const int num_slots = num_teams * chunk_elems;
+    elem.buffers.init(num_slots);
+    load.init(num_teams);
+    std::cout << "CAAR on chunks of " << chunk_elems << " elements, "
+              << chunk_elems * Elements::BufferViews::caar_bytes_per_slot() /
+                     1024
+              << " KB of buffers per chunk, " << num_slots
+              << " buffer slots\n";
   }
 
   // Create the functor
-  CaarFunctor func(data, elem, deriv);
+  CaarFunctor func(data, elem, deriv, diagnostics);
+  func.set_element_chunks(chunk_elems);
+  func.set_level_chunks(level_chunks);
+  func.set_dynamic_schedule(dynamic_schedule);
+  func.set_team_times(load.team_times());
+
+  // Options: --scan=fused computes the pressure, PHI and omega_p in one sweep
+  // of each column, as routine_st_fused.F90 does, instead of one for each.
+  // --scan-benchmark=1 first times the steps with both scans
+  const std::string scan = get_string_option(argc, argv, "scan", "split");
+  if (scan != "split" && scan != "fused") {
+    std::cerr << "Unknown scan " << scan << ", expected split or fused\n";
+    std::abort();
+  }
+  func.set_fused_scan(scan == "fused");
+  const bool scan_benchmark = get_option(argc, argv, "scan-benchmark", 0);
+
+  // Option: --skew=N makes the elements of the first eighth of the league N
+  // times as costly in the scan phase, as a cluster of elements with more
+  // physics would be
+  const int skew = get_option(argc, argv, "skew", 1);
+  if (skew != 1) {
+    ExecViewManaged<int *> elem_costs("Cost of each element", num_elems);
+    ExecViewManaged<int *>::HostMirror h_elem_costs =
+        Kokkos::create_mirror_view(elem_costs);
+    for (int ie = 0; ie < num_elems; ++ie) {
+      h_elem_costs(ie) = (ie < (num_elems + 7) / 8 ? skew : 1);
+    }
+    Kokkos::deep_copy(elem_costs, h_elem_costs);
+    func.set_element_costs(elem_costs);
+  }
+
+  // Options: --order=N renumbers the elements of the cubed sphere along a
+  // space filling curve (1: Hilbert, 2: Morton), and hands contiguous
+  // ranges of the curve to the ranks and to the teams. --order-benchmark=1
+  // first times the steps with the elements in the natural order
+  const CubedSphere::Ordering ordering =
+      static_cast<CubedSphere::Ordering>(get_option(argc, argv, "order", 0));
+  int chunk_size = 1;
+  if (ordering != CubedSphere::NATURAL) {
+    if (ne == 0 || plane) {
+      std::cerr << "--order requires a cubed sphere mesh (--ne=N)\n";
+      std::abort();
+    }
+    const std::vector<int> new_to_old =
+        CubedSphere(ne).element_order(ordering);
+    const int benchmark_steps =
+        (get_option(argc, argv, "order-benchmark", 0) ? num_exec : 0);
+    double natural_seconds = 0.0;
+    if (benchmark_steps > 0) {
+      const Kokkos::TeamPolicy<ExecSpace> policy = caar_policy(
+          func, num_elems, threads_per_team, vectors_per_thread, chunk_size);
+      natural_seconds =
+          time_caar_dss(policy, func, connectivity, elem, benchmark_steps);
+    }
+
+    elem.permute(new_to_old);
+    connectivity.permute(new_to_old);
+    chunk_size = contiguous_chunk_size(num_elems, threads_per_team);
+
+    if (benchmark_steps > 0) {
+      const Kokkos::TeamPolicy<ExecSpace> policy = caar_policy(
+          func, num_elems, threads_per_team, vectors_per_thread, chunk_size);
+      const double curve_seconds =
+          time_caar_dss(policy, func, connectivity, elem, benchmark_steps);
+      std::cout << "Ordering benchmark, " << benchmark_steps
+                << " steps of CAAR and DSS: natural order " << natural_seconds
+                << " seconds, "
+                << (ordering == CubedSphere::HILBERT ? "Hilbert" : "Morton")
+                << " order " << curve_seconds << " seconds (speedup "
+                << natural_seconds / curve_seconds << ")\n";
+    }
+  }
+
+  if (schedule_benchmark) {
+    const Kokkos::TeamPolicy<ExecSpace> policy = caar_policy(
+        func, num_elems, threads_per_team, vectors_per_thread, chunk_size);
+    const int num_teams = policy.league_size();
+    for (const bool dynamic : { false, true }) {
+      LoadBalance benchmark_load;
+      benchmark_load.init(num_teams);
+      time_caar_schedule(policy, func, dynamic, benchmark_load, num_exec);
+      std::cout << "Schedule benchmark, " << (dynamic ? "dynamic" : "static")
+                << " schedule with a skew of " << skew << ":\n";
+      benchmark_load.print(std::cout);
+    }
+  }
+
+  if (scan_benchmark) {
+    const Kokkos::TeamPolicy<ExecSpace> policy = caar_policy(
+        func, num_elems, threads_per_team, vectors_per_thread, chunk_size);
+    CaarFunctor benchmark_func(func);
+    benchmark_func.set_fused_scan(false);
+    const double split_seconds = time_caar(policy, benchmark_func, num_exec);
+    benchmark_func.set_fused_scan(true);
+    const double fused_seconds = time_caar(policy, benchmark_func, num_exec);
+    std::cout << "Scan benchmark, " << num_exec
+              << " steps of CAAR: split scan " << split_seconds
+              << " seconds, fused scan " << fused_seconds
+              << " seconds (speedup " << split_seconds / fused_seconds
+              << ")\n";
+  }
+
+  if (latency_samples > 0) {
+    latency_benchmark(func, num_elems, threads_per_team, vectors_per_thread,
+                      latency_samples);
+  }
+
+  std::unique_ptr<BoundaryExchange> dss;
+  if (ne > 0) {
+    dss.reset(new BoundaryExchange(connectivity, elem));
+  }
 
   constexpr int kb_size = 1024;
   constexpr int doubles_per_kb = kb_size / sizeof(double);
@@ -111,22 +662,101 @@ int main(int argc, char **argv) {
 
   HostViewManaged<Real *> trash("trash cache filler", 20 * doubles_per_mb);
 
+  // Option: --trace=N records the timeline of the phases in rings of N
+  // events per thread, written to trace.json in the Chrome trace format
+  const int trace_events = get_option(argc, argv, "trace", 0);
+  Trace trace;
+  if (trace_events > 0) {
+    trace.init(ExecSpace::concurrency(), trace_events);
+    func.set_trace(trace);
+  }
+
   {
     // Setup the policy
-    Kokkos::TeamPolicy<ExecSpace> policy(num_elems, threads_per_team,
-                                         vectors_per_thread);
-    policy.set_chunk_size(1);
+    const Kokkos::TeamPolicy<ExecSpace> policy = caar_policy(
+        func, num_elems, threads_per_team, vectors_per_thread, chunk_size);
+
+    // All the steps go in one launch if they are persistent
+    const int num_launches = (persistent ? 1 : num_exec);
+    const int steps_per_launch = num_exec / num_launches;
+    if (persistent) {
+      func.set_persistent_steps(num_exec);
+    }
+
+    std::vector<clock_type::time_point> start_times(num_launches);
+    std::vector<clock_type::time_point> end_times(num_launches);
+
+    // Step at which non-positive dp3d was first found, if any
+    int first_bad_dp3d_step = -1;
+    elem.reset_dp3d_check();
+
+    // Whether the DSS of the previous step is still to be completed
+    bool dss_pending = false;
 
-    std::vector<clock_type::time_point> start_times(num_exec);
-    std::vector<clock_type::time_point> end_times(num_exec);
+    // The time of the steps without the flush of the caches and the DSS
+    double caar_seconds = 0.0;
 
-    for (int exec = 0; exec < num_exec; ++exec) {
+    for (int exec = 0; exec < num_launches; ++exec) {
       auto start = clock_type::now();
       ExecSpace::fence();
       start_timer("dispatch and compute");
-      Kokkos::parallel_for(policy, func);
+      // The part of the step in unpack_interior and finish, when they
+      // overlap it
+      clock_type::duration dss_time(0);
+      if (dss_pending) {
+        // The interior elements go on while the messages of the previous
+        // exchange are in flight
+        auto dss_start = clock_type::now();
+        double host_start = trace.start();
+        dss->unpack_interior();
+        trace.record_host(Trace::DSS_UNPACK_INTERIOR, host_start);
+        dss_time += clock_type::now() - dss_start;
+        dispatch_caar(dss->interior_elements(), threads_per_team,
+                      vectors_per_thread, chunk_size, func);
+        ExecSpace::fence();
+        dss_start = clock_type::now();
+        host_start = trace.start();
+        dss->finish();
+        trace.record_host(Trace::DSS_FINISH, host_start);
+        dss_time += clock_type::now() - dss_start;
+        dispatch_caar(dss->boundary_elements(), threads_per_team,
+                      vectors_per_thread, chunk_size, func);
+      } else {
+        dispatch_caar(policy, func);
+      }
       ExecSpace::fence();
       stop_timer("dispatch and compute");
+      const double step_seconds =
+          std::chrono::duration_cast<ns>(clock_type::now() - start).count() *
+          1e-9;
+      load.end_step(step_seconds);
+      caar_seconds +=
+          step_seconds -
+          std::chrono::duration_cast<ns>(dss_time).count() * 1e-9;
+      if (dss) {
+        double host_start = trace.start();
+        dss->start(data.np1);
+        trace.record_host(Trace::DSS_START, host_start);
+        dss_pending = overlap && exec + 1 < num_exec &&
+                      !(history && (exec + 1) % history_freq == 0);
+        if (!dss_pending) {
+          // The history and the last step need the assembled fields
+          host_start = trace.start();
+          dss->unpack_interior();
+          trace.record_host(Trace::DSS_UNPACK_INTERIOR, host_start);
+          host_start = trace.start();
+          dss->finish();
+          trace.record_host(Trace::DSS_FINISH, host_start);
+        }
+      }
+      if (first_bad_dp3d_step < 0 && elem.num_bad_dp3d_elems() > 0) {
+        first_bad_dp3d_step = (exec + 1) * steps_per_launch;
+      }
+      if (history && (exec + 1) % history_freq == 0) {
+        const double host_start = trace.start();
+        history->write(elem, data, exec + 1);
+        trace.record_host(Trace::HISTORY, host_start);
+      }
       flush_caches(trash);
       auto end = clock_type::now();
       start_times[exec] = start;
@@ -136,15 +766,87 @@ int main(int argc, char **argv) {
     clobber();
 
     clock_type::duration total_time = end_times[0] - start_times[0];
-    for (int exec = 1; exec < num_exec; ++exec) {
+    for (int exec = 1; exec < num_launches; ++exec) {
       total_time += end_times[exec] - start_times[exec];
     }
 
     auto count = std::chrono::duration_cast<ns>(total_time).count();
     std::cout << "Seconds " << count * 1e-9 << " to evaluate " << num_elems
               << " elements " << num_exec << " times\n";
+
+    // Option: --bandwidth-file=F reads the peak bandwidth of the memory
+    // measured by saxbpy_test_cxx --stream, in bandwidth.dat by default
+    AttainableBandwidth bandwidth;
+    if (bandwidth.read(
+            get_string_option(argc, argv, "bandwidth-file", "bandwidth.dat"))) {
+      const long bytes_per_step =
+          static_cast<long>(num_elems) *
+          Elements::caar_bytes_per_elem(data.qn0 != -1, data.rsplit == 0);
+      const double gb_per_second =
+          1e-9 * bytes_per_step * num_exec / caar_seconds;
+      std::string level;
+      const double peak = bandwidth.gb_per_second(bytes_per_step, level);
+      std::cout << "CAAR moves at least " << bytes_per_step / (1024 * 1024)
+                << " MB per step, " << gb_per_second << " GB/s";
+      if (peak > 0.0) {
+        std::cout << ": " << 100.0 * gb_per_second / peak
+                  << "% of the attainable " << level << " bandwidth of "
+                  << peak << " GB/s";
+      }
+      std::cout << "\n";
+    }
+
+    if (history) {
+      std::cout << "History output: " << history->num_records()
+                << " records of " << history->num_levels() << " levels, "
+                << history->seconds_in_write() << " seconds in write ("
+                << 100.0 * history->seconds_in_write() / (count * 1e-9)
+                << "% of the step time), " << history->seconds_stalled()
+                << " seconds waiting on I/O\n";
+    }
+
+    if (dss) {
+      std::cout << "DSS on " << connectivity.num_ranks() << " ranks: "
+                << dss->boundary_elements().extent_int(0)
+                << " boundary elements, " << dss->num_messages()
+                << " messages of " << dss->message_bytes()
+                << " bytes in total per exchange, " << dss->num_exchanges()
+                << " exchanges\n"
+                << "   seconds packing " << dss->seconds_packing()
+                << ", unpacking " << dss->seconds_unpacking()
+                << ", in transfers " << dss->seconds_in_transfers()
+                << ", waiting on transfers " << dss->seconds_waiting() << "\n";
+    }
+
+    load.print(std::cout);
+
+    if (trace.enabled()) {
+      trace.write("trace.json");
+      std::cout << "Trace: " << trace.num_events() << " events, "
+                << trace.num_dropped_events()
+                << " dropped by full rings, written to trace.json\n";
+    }
+
+    if (data.compute_diagonstics) {
+      diagnostics.print(std::cout);
+    }
+
+    if (first_bad_dp3d_step >= 0) {
+      std::cout << "Non-positive dp3d found in " << elem.num_bad_dp3d_elems()
+                << " element steps, first at step " << first_bad_dp3d_step
+                << ". In the last step:\n";
+      elem.print_bad_dp3d(std::cout);
+    }
   }
 
+  // Flush the pending records before the views are deallocated
+  history.reset();
+  dss.reset();
+
   finalize_kokkos();
   GPTLpr_summary_file(0, "Timing.dat");
+  HotTimers::append_summary("Timing.dat");
+  HotTimers::finalize();
+  PerfCounters::append_summary("Timing.dat");
+  PerfCounters::finalize();
 }
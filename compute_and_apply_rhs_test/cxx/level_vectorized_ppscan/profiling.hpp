@@ -11,11 +11,32 @@
   {}
 #define stop_timer(name)                                                       \
   {}
+#define start_hot_timer(id)                                                    \
+  {}
+#define stop_hot_timer(id)                                                     \
+  {}
+#define start_perf_region(region)                                              \
+  {}
+#define stop_perf_region(region)                                               \
+  {}
 #else
+#include "HotTimers.hpp"
+#include "PerfCounters.hpp"
+
 #define start_timer(name)                                                      \
   { GPTLstart(name); }
 #define stop_timer(name)                                                       \
   { GPTLstop(name); }
+// Timers of the hot path, see HotTimers
+#define start_hot_timer(id)                                                    \
+  { Homme::HotTimers::start(Homme::HotTimers::id); }
+#define stop_hot_timer(id)                                                     \
+  { Homme::HotTimers::stop(Homme::HotTimers::id); }
+// Hardware counter regions, see PerfCounters
+#define start_perf_region(region)                                              \
+  { Homme::PerfCounters::start(Homme::PerfCounters::region); }
+#define stop_perf_region(region)                                               \
+  { Homme::PerfCounters::stop(Homme::PerfCounters::region); }
 #endif
 
 #ifdef VTUNE_PROFILE
@@ -62,6 +62,20 @@ public:
   }
 
   inline value_type &operator[](int i) const { return _data.d[i]; }
+
+  // Moves lane i + num_shift to lane i; the last num_shift lanes are zeroed
+  inline void shift_left(int num_shift) {
+    for (int i = 0; i < vector_length; i++) {
+      _data.d[i] = (i + num_shift < vector_length ? _data.d[i + num_shift] : 0);
+    }
+  }
+
+  // Moves lane i - num_shift to lane i; the first num_shift lanes are zeroed
+  inline void shift_right(int num_shift) {
+    for (int i = vector_length - 1; i >= 0; i--) {
+      _data.d[i] = (i >= num_shift ? _data.d[i - num_shift] : 0);
+    }
+  }
 };
 
 template <typename SpT>
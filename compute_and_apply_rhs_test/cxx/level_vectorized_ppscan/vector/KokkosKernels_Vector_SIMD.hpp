@@ -88,10 +88,19 @@ public:
   KOKKOS_INLINE_FUNCTION
   value_type &operator[](const int i) const { return _data[i]; }
 
+  // Moves lane i + num_shift to lane i; the last num_shift lanes are zeroed
   KOKKOS_INLINE_FUNCTION
   void shift_left(int num_shift) {
-    for(int i = 0; i < vector_length - 1; i++) {
-      _data[i] = _data[i + 1];
+    for(int i = 0; i < vector_length; i++) {
+      _data[i] = (i + num_shift < vector_length ? _data[i + num_shift] : 0);
+    }
+  }
+
+  // Moves lane i - num_shift to lane i; the first num_shift lanes are zeroed
+  KOKKOS_INLINE_FUNCTION
+  void shift_right(int num_shift) {
+    for(int i = vector_length - 1; i >= 0; i--) {
+      _data[i] = (i >= num_shift ? _data[i - num_shift] : 0);
     }
   }
 };
@@ -184,12 +193,13 @@ operator-(const typename VectorTag<SIMD<T, SpT>, l>::value_type a,
 template <typename T, typename SpT, int l>
 KOKKOS_INLINE_FUNCTION static Vector<VectorTag<SIMD<T, SpT>, l> >
 operator-(Vector<VectorTag<SIMD<T, SpT>, l> > const &a) {
+  Vector<VectorTag<SIMD<T, SpT>, l> > r_val;
   Kokkos::parallel_for(
       Kokkos::Impl::ThreadVectorRangeBoundariesStruct<
           int, typename VectorTag<SIMD<T, SpT>, l>::member_type>(
           VectorTag<SIMD<T, SpT>, l>::length),
-      [&](const int &i) { a[i] = -a[i]; });
-  return a;
+      [&](const int &i) { r_val[i] = -a[i]; });
+  return r_val;
 }
 
 template <typename T, typename SpT, int l>
@@ -14,53 +14,6 @@ namespace Homme
 
 void compute_and_apply_rhs (TestData& data)
 {
-  // Create local arrays
-  real* Ephi             = new real[np*np]        {};
-  real* T_v              = new real[nlev*np*np]   {};
-  real* divdp            = new real[nlev*np*np]   {};
-  real* grad_p           = new real[nlev*np*np*2] {};
-  real* eta_dot_dpdn_tmp = new real[nlevp*np*np]  {};
-  real* kappa_star       = new real[nlev*np*np]   {};
-  real* omega_p_tmp      = new real[nlev*np*np]   {};
-  real* p                = new real[nlev*np*np]   {};
-  real* ttens            = new real[nlev*np*np]   {};
-  real* T_vadv           = new real[nlev*np*np]   {};
-  real* v_vadv           = new real[nlev*np*np*2] {};
-  real* vdp              = new real[nlev*np*np*2] {};
-  real* vgrad_T          = new real[np*np]        {};
-  real* vgrad_p          = new real[nlev*np*np]   {};
-  real* vort             = new real[nlev*np*np]   {};
-  real* vtemp            = new real[np*np*2]      {};
-  real* vtens1           = new real[nlev*np*np]   {};
-  real* vtens2           = new real[nlev*np*np]   {};
-
-  // Other accessory variables
-  real Qt     = 0;
-  real glnps1 = 0;
-  real glnps2 = 0;
-  real gpterm = 0;
-  real v1     = 0;
-  real v2     = 0;
-
-  real* Qdp_ie            = nullptr;
-  real* T_n0              = nullptr;
-  real* T_nm1             = nullptr;
-  real* T_np1             = nullptr;
-  real* derived_vn0       = nullptr;
-  real* dp3d_n0           = nullptr;
-  real* dp3d_nm1          = nullptr;
-  real* dp3d_np1          = nullptr;
-  real* fcor              = nullptr;
-  real* omega_p           = nullptr;
-  real* pecnd             = nullptr;
-  real* phi               = nullptr;
-  real* phis              = nullptr;
-  real* spheremp          = nullptr;
-  real* v_n0              = nullptr;
-  real* v_nm1             = nullptr;
-  real* v_np1             = nullptr;
-  real* eta_dot_dpdn      = nullptr;
-
   // Input parameters
   const int nets = data.control.nets;
   const int nete = data.control.nete;
@@ -70,211 +23,246 @@ void compute_and_apply_rhs (TestData& data)
   const int qn0  = data.control.qn0;
   const real dt2 = data.control.dt2;
 
-  // Loop over elements
-  for (int ie=nets; ie<nete; ++ie)
+  #pragma omp parallel
   {
-    dp3d_n0 = SLICE_5D_IJ(data.arrays.elem_state_dp3d,ie,n0,timelevels,nlev,np,np);
-
-    for (int igp=0; igp<np; ++igp)
+    // Local arrays, in the slab of the thread. They are not zeroed, and
+    // the ones whose lifetimes do not overlap share storage
+    const WorkspaceArena& arena = data.workspace;
+    const int thread = thread_id();
+    real* const Ephi             = arena.get(TMP_EPHI,thread);
+    real* const T_v              = arena.get(TMP_T_V,thread);
+    real* const divdp            = arena.get(TMP_DIVDP,thread);
+    real* const grad_p           = arena.get(TMP_GRAD_P,thread);
+    real* const eta_dot_dpdn_tmp = arena.get(TMP_ETA_DOT_DPDN,thread);
+    real* const kappa_star       = arena.get(TMP_KAPPA_STAR,thread);
+    real* const omega_p_tmp      = arena.get(TMP_OMEGA_P,thread);
+    real* const p                = arena.get(TMP_P,thread);
+    real* const ttens            = arena.get(TMP_TTENS,thread);
+    real* const T_vadv           = arena.get(TMP_T_VADV,thread);
+    real* const v_vadv           = arena.get(TMP_V_VADV,thread);
+    real* const vdp              = arena.get(TMP_VDP,thread);
+    real* const vgrad_T          = arena.get(TMP_VGRAD_T,thread);
+    real* const vgrad_p          = arena.get(TMP_VGRAD_P,thread);
+    real* const vort             = arena.get(TMP_VORT,thread);
+    real* const vtemp            = arena.get(TMP_VTEMP,thread);
+    real* const vtens1           = arena.get(TMP_VTENS1,thread);
+    real* const vtens2           = arena.get(TMP_VTENS2,thread);
+
+    // Other accessory variables
+    real Qt     = 0;
+    real glnps1 = 0;
+    real glnps2 = 0;
+    real gpterm = 0;
+    real v1     = 0;
+    real v2     = 0;
+
+    real* Qdp_ie            = nullptr;
+    real* T_n0              = nullptr;
+    real* T_nm1             = nullptr;
+    real* T_np1             = nullptr;
+    real* derived_vn0       = nullptr;
+    real* dp3d_n0           = nullptr;
+    real* dp3d_nm1          = nullptr;
+    real* dp3d_np1          = nullptr;
+    real* fcor              = nullptr;
+    real* omega_p           = nullptr;
+    real* pecnd             = nullptr;
+    real* phi               = nullptr;
+    real* phis              = nullptr;
+    real* spheremp          = nullptr;
+    real* v_n0              = nullptr;
+    real* v_nm1             = nullptr;
+    real* v_np1             = nullptr;
+    real* eta_dot_dpdn      = nullptr;
+
+    // Loop over elements, split over the threads as in Arrays::init_data
+    #pragma omp for schedule(static)
+    for (int ie=nets; ie<nete; ++ie)
     {
-      for (int jgp=0; jgp<np; ++jgp)
-      {
-        AT_3D(p,0,igp,jgp,np,np) = data.hvcoord.hyai[0]*data.hvcoord.ps0 + 0.5*AT_3D(dp3d_n0,0,igp,jgp,np,np);
-      }
-    }
+      dp3d_n0 = SLICE_5D_IJ(data.arrays.elem_state_dp3d,ie,n0,timelevels,nlev,np,np);
 
-    for (int ilev=1; ilev<nlev; ++ilev)
-    {
       for (int igp=0; igp<np; ++igp)
       {
         for (int jgp=0; jgp<np; ++jgp)
         {
-          AT_3D(p,ilev,igp,jgp,np,np) = AT_3D(p,(ilev-1),igp,jgp,np,np)
-                            + 0.5*AT_3D(dp3d_n0,(ilev-1),igp,jgp,np,np)
-                            + 0.5*AT_3D(dp3d_n0,ilev,igp,jgp,np,np);
+          AT_3D(p,0,igp,jgp,np,np) = data.hvcoord.hyai[0]*data.hvcoord.ps0 + 0.5*AT_3D(dp3d_n0,0,igp,jgp,np,np);
         }
       }
-    }
-
-    derived_vn0 = SLICE_5D(data.arrays.elem_derived_vn0,ie,nlev,np,np,2);
-    v_n0 = SLICE_6D_IJ(data.arrays.elem_state_v,ie,n0,timelevels,nlev,np,np,2);
-    for (int ilev=0; ilev<nlev; ++ilev)
-    {
-      gradient_sphere (SLICE_3D(p,ilev,np,np), data, ie, SLICE_4D(grad_p,ilev,np,np,2));
 
-      for (int igp=0; igp<np; ++igp)
+      for (int ilev=1; ilev<nlev; ++ilev)
       {
-        for (int jgp=0; jgp<np; ++jgp)
+        for (int igp=0; igp<np; ++igp)
         {
-          v1 = AT_4D(v_n0,ilev,igp,jgp,0,np,np,2);
-          v2 = AT_4D(v_n0,ilev,igp,jgp,1,np,np,2);
-          AT_3D(vgrad_p,ilev,igp,jgp,np,np) = v1 * AT_4D(grad_p,ilev,igp,jgp,0,np,np,2)
-                                            + v2 * AT_4D(grad_p,ilev,igp,jgp,1,np,np,2);
-
-          AT_4D(vdp,ilev,igp,jgp,0,np,np,2) = v1 * AT_3D(dp3d_n0,ilev,igp,jgp,np,np);
-          AT_4D(vdp,ilev,igp,jgp,1,np,np,2) = v2 * AT_3D(dp3d_n0,ilev,igp,jgp,np,np);
-
-          AT_4D(derived_vn0,ilev,igp,jgp,0,np,np,2) += data.constants.eta_ave_w * AT_4D(vdp,ilev,igp,jgp,0,np,np,2);
-          AT_4D(derived_vn0,ilev,igp,jgp,1,np,np,2) += data.constants.eta_ave_w * AT_4D(vdp,ilev,igp,jgp,1,np,np,2);
+          for (int jgp=0; jgp<np; ++jgp)
+          {
+            AT_3D(p,ilev,igp,jgp,np,np) = AT_3D(p,(ilev-1),igp,jgp,np,np)
+                              + 0.5*AT_3D(dp3d_n0,(ilev-1),igp,jgp,np,np)
+                              + 0.5*AT_3D(dp3d_n0,ilev,igp,jgp,np,np);
+          }
         }
       }
 
-      divergence_sphere(SLICE_4D(vdp,ilev,np,np,2), data, ie, SLICE_3D (divdp,ilev,np,np));
-      vorticity_sphere(SLICE_4D(v_n0,ilev,np,np,2), data, ie, SLICE_3D (vort,ilev,np,np));
-    }
-
-    T_n0 = SLICE_5D_IJ(data.arrays.elem_state_T,ie,n0,timelevels,nlev,np,np);
-    if (qn0==-1)
-    {
+      derived_vn0 = SLICE_5D(data.arrays.elem_derived_vn0,ie,nlev,np,np,2);
+      v_n0 = SLICE_6D_IJ(data.arrays.elem_state_v,ie,n0,timelevels,nlev,np,np,2);
       for (int ilev=0; ilev<nlev; ++ilev)
       {
+        gradient_sphere (SLICE_3D(p,ilev,np,np), data, ie, SLICE_4D(grad_p,ilev,np,np,2));
+
         for (int igp=0; igp<np; ++igp)
         {
           for (int jgp=0; jgp<np; ++jgp)
           {
-            AT_3D(T_v,ilev,igp,jgp,np,np) = AT_3D(T_n0,ilev,igp,jgp,np,np);
-            AT_3D(kappa_star,ilev,igp,jgp,np,np) = data.constants.kappa;
+            v1 = AT_4D(v_n0,ilev,igp,jgp,0,np,np,2);
+            v2 = AT_4D(v_n0,ilev,igp,jgp,1,np,np,2);
+            AT_3D(vgrad_p,ilev,igp,jgp,np,np) = v1 * AT_4D(grad_p,ilev,igp,jgp,0,np,np,2)
+                                              + v2 * AT_4D(grad_p,ilev,igp,jgp,1,np,np,2);
+
+            AT_4D(vdp,ilev,igp,jgp,0,np,np,2) = v1 * AT_3D(dp3d_n0,ilev,igp,jgp,np,np);
+            AT_4D(vdp,ilev,igp,jgp,1,np,np,2) = v2 * AT_3D(dp3d_n0,ilev,igp,jgp,np,np);
+
+            AT_4D(derived_vn0,ilev,igp,jgp,0,np,np,2) += data.constants.eta_ave_w * AT_4D(vdp,ilev,igp,jgp,0,np,np,2);
+            AT_4D(derived_vn0,ilev,igp,jgp,1,np,np,2) += data.constants.eta_ave_w * AT_4D(vdp,ilev,igp,jgp,1,np,np,2);
           }
         }
+
+        divergence_sphere(SLICE_4D(vdp,ilev,np,np,2), data, ie, SLICE_3D (divdp,ilev,np,np));
+        vorticity_sphere(SLICE_4D(v_n0,ilev,np,np,2), data, ie, SLICE_3D (vort,ilev,np,np));
       }
-    }
-    else
-    {
-      Qdp_ie = SLICE_6D_IJK (data.arrays.elem_state_Qdp,ie,0,qn0,qsize_d,2,nlev,np,np);
-      for (int ilev=0; ilev<nlev; ++ilev)
+
+      T_n0 = SLICE_5D_IJ(data.arrays.elem_state_T,ie,n0,timelevels,nlev,np,np);
+      if (qn0==-1)
       {
-        for (int igp=0; igp<np; ++igp)
+        for (int ilev=0; ilev<nlev; ++ilev)
         {
-          for (int jgp=0; jgp<np; ++jgp)
+          for (int igp=0; igp<np; ++igp)
           {
-            Qt = AT_3D(Qdp_ie,ilev,igp,jgp,np,np) / AT_3D(dp3d_n0,ilev,igp,jgp,np,np);
-            AT_3D(T_v,ilev,igp,jgp,np,np) = AT_3D(T_n0,ilev,igp,jgp,np,np)*(1.0+ (data.constants.Rwater_vapor/data.constants.Rgas - 1.0)*Qt);
-            AT_3D(kappa_star,ilev,igp,jgp,np,np) = data.constants.kappa;
+            for (int jgp=0; jgp<np; ++jgp)
+            {
+              AT_3D(T_v,ilev,igp,jgp,np,np) = AT_3D(T_n0,ilev,igp,jgp,np,np);
+              AT_3D(kappa_star,ilev,igp,jgp,np,np) = data.constants.kappa;
+            }
+          }
+        }
+      }
+      else
+      {
+        Qdp_ie = SLICE_6D_IJK (data.arrays.elem_state_Qdp,ie,0,qn0,qsize_d,2,nlev,np,np);
+        for (int ilev=0; ilev<nlev; ++ilev)
+        {
+          for (int igp=0; igp<np; ++igp)
+          {
+            for (int jgp=0; jgp<np; ++jgp)
+            {
+              Qt = AT_3D(Qdp_ie,ilev,igp,jgp,np,np) / AT_3D(dp3d_n0,ilev,igp,jgp,np,np);
+              AT_3D(T_v,ilev,igp,jgp,np,np) = AT_3D(T_n0,ilev,igp,jgp,np,np)*(1.0+ (data.constants.Rwater_vapor/data.constants.Rgas - 1.0)*Qt);
+              AT_3D(kappa_star,ilev,igp,jgp,np,np) = data.constants.kappa;
+            }
           }
         }
       }
-    }
 
-    phis = SLICE_3D(data.arrays.elem_state_phis,ie,np,np);
-    phi  = SLICE_4D(data.arrays.elem_derived_phi,ie,nlev,np,np);
+      phis = SLICE_3D(data.arrays.elem_state_phis,ie,np,np);
+      phi  = SLICE_4D(data.arrays.elem_derived_phi,ie,nlev,np,np);
 
-    preq_hydrostatic (phis,T_v,p,dp3d_n0,data.constants.Rgas,phi);
-    preq_omega_ps (p,vgrad_p,divdp,omega_p_tmp);
+      preq_hydrostatic (phis,T_v,p,dp3d_n0,data.constants.Rgas,phi);
+      preq_omega_ps (p,vgrad_p,divdp,omega_p_tmp);
 
-    omega_p      = SLICE_4D(data.arrays.elem_derived_omega_p,ie,nlev,np,np);
-    eta_dot_dpdn = SLICE_4D(data.arrays.elem_derived_eta_dot_dpdn,ie,nlevp,np,np);
-    for (int ilev=0; ilev<nlev; ++ilev)
-    {
-      for (int igp=0; igp<np; ++igp)
+      omega_p      = SLICE_4D(data.arrays.elem_derived_omega_p,ie,nlev,np,np);
+      eta_dot_dpdn = SLICE_4D(data.arrays.elem_derived_eta_dot_dpdn,ie,nlevp,np,np);
+      for (int ilev=0; ilev<nlev; ++ilev)
       {
-        for (int jgp=0; jgp<np; ++jgp)
+        for (int igp=0; igp<np; ++igp)
         {
-          AT_3D(eta_dot_dpdn,ilev,igp,jgp,np,np) += data.constants.eta_ave_w * AT_3D(eta_dot_dpdn_tmp,ilev,igp,jgp,np,np);
-          AT_3D(omega_p,ilev,igp,jgp,np,np) += data.constants.eta_ave_w * AT_3D(omega_p_tmp,ilev,igp,jgp,np,np);
+          for (int jgp=0; jgp<np; ++jgp)
+          {
+            AT_3D(eta_dot_dpdn,ilev,igp,jgp,np,np) += data.constants.eta_ave_w * AT_3D(eta_dot_dpdn_tmp,ilev,igp,jgp,np,np);
+            AT_3D(omega_p,ilev,igp,jgp,np,np) += data.constants.eta_ave_w * AT_3D(omega_p_tmp,ilev,igp,jgp,np,np);
+          }
         }
       }
-    }
-    for (int igp=0; igp<np; ++igp)
-    {
-      for (int jgp=0; jgp<np; ++jgp)
+      for (int igp=0; igp<np; ++igp)
       {
-        AT_3D(eta_dot_dpdn,nlev,igp,jgp,np,np) += data.constants.eta_ave_w * AT_3D(eta_dot_dpdn_tmp,nlev,igp,jgp,np,np);
+        for (int jgp=0; jgp<np; ++jgp)
+        {
+          AT_3D(eta_dot_dpdn,nlev,igp,jgp,np,np) += data.constants.eta_ave_w * AT_3D(eta_dot_dpdn_tmp,nlev,igp,jgp,np,np);
+        }
       }
-    }
 
-    pecnd = SLICE_4D(data.arrays.elem_derived_pecnd,ie,nlev,np,np);
-    fcor  = SLICE_3D(data.arrays.elem_fcor,ie,np,np);
-    for (int ilev=0; ilev<nlev; ++ilev)
-    {
-      for (int igp=0; igp<np; ++igp)
+      pecnd = SLICE_4D(data.arrays.elem_derived_pecnd,ie,nlev,np,np);
+      fcor  = SLICE_3D(data.arrays.elem_fcor,ie,np,np);
+      for (int ilev=0; ilev<nlev; ++ilev)
       {
-        for (int jgp=0; jgp<np; ++jgp)
+        for (int igp=0; igp<np; ++igp)
         {
-          v1 = AT_4D(v_n0,ilev,igp,jgp,0,np,np,2);
-          v2 = AT_4D(v_n0,ilev,igp,jgp,1,np,np,2);
+          for (int jgp=0; jgp<np; ++jgp)
+          {
+            v1 = AT_4D(v_n0,ilev,igp,jgp,0,np,np,2);
+            v2 = AT_4D(v_n0,ilev,igp,jgp,1,np,np,2);
 
-          AT_2D(Ephi,igp,jgp,np) = 0.5 * (v1*v1 + v2*v2) + AT_3D(phi,ilev,igp,jgp,np,np) + AT_3D (pecnd,ilev,igp,jgp,np,np);
+            AT_2D(Ephi,igp,jgp,np) = 0.5 * (v1*v1 + v2*v2) + AT_3D(phi,ilev,igp,jgp,np,np) + AT_3D (pecnd,ilev,igp,jgp,np,np);
+          }
         }
-      }
 
-      gradient_sphere (SLICE_3D(T_n0,ilev,np,np),data,ie,vtemp);
+        gradient_sphere (SLICE_3D(T_n0,ilev,np,np),data,ie,vtemp);
 
-      for (int igp=0; igp<np; ++igp)
-      {
-        for (int jgp=0; jgp<np; ++jgp)
+        for (int igp=0; igp<np; ++igp)
         {
-          v1 = AT_4D(v_n0,ilev,igp,jgp,0,np,np,2);
-          v2 = AT_4D(v_n0,ilev,igp,jgp,1,np,np,2);
+          for (int jgp=0; jgp<np; ++jgp)
+          {
+            v1 = AT_4D(v_n0,ilev,igp,jgp,0,np,np,2);
+            v2 = AT_4D(v_n0,ilev,igp,jgp,1,np,np,2);
 
-          AT_2D(vgrad_T,igp,jgp,np) = v1*AT_3D(vtemp,igp,jgp,0,np,2) + v2*AT_3D(vtemp,igp,jgp,1,np,2);
+            AT_2D(vgrad_T,igp,jgp,np) = v1*AT_3D(vtemp,igp,jgp,0,np,2) + v2*AT_3D(vtemp,igp,jgp,1,np,2);
+          }
         }
-      }
 
-      gradient_sphere (Ephi, data, ie, vtemp);
+        gradient_sphere (Ephi, data, ie, vtemp);
 
-      for (int igp=0; igp<np; ++igp)
-      {
-        for (int jgp=0; jgp<np; ++jgp)
+        for (int igp=0; igp<np; ++igp)
         {
-          gpterm = AT_3D(T_v,ilev,igp,jgp,np,np) / AT_3D(p,ilev,igp,jgp,np,np);
+          for (int jgp=0; jgp<np; ++jgp)
+          {
+            gpterm = AT_3D(T_v,ilev,igp,jgp,np,np) / AT_3D(p,ilev,igp,jgp,np,np);
 
-          glnps1 = data.constants.Rgas*gpterm*AT_4D(grad_p,ilev,igp,jgp,0,np,np,2);
-          glnps2 = data.constants.Rgas*gpterm*AT_4D(grad_p,ilev,igp,jgp,1,np,np,2);
+            glnps1 = data.constants.Rgas*gpterm*AT_4D(grad_p,ilev,igp,jgp,0,np,np,2);
+            glnps2 = data.constants.Rgas*gpterm*AT_4D(grad_p,ilev,igp,jgp,1,np,np,2);
 
-          v1 = AT_4D(v_n0,ilev,igp,jgp,0,np,np,2);
-          v2 = AT_4D(v_n0,ilev,igp,jgp,1,np,np,2);
+            v1 = AT_4D(v_n0,ilev,igp,jgp,0,np,np,2);
+            v2 = AT_4D(v_n0,ilev,igp,jgp,1,np,np,2);
 
-          AT_3D(vtens1,ilev,igp,jgp,np,np) = - AT_4D(v_vadv,ilev,igp,jgp,0,np,np,2) + v2 * (AT_2D(fcor,igp,jgp,np) + AT_3D(vort,ilev,igp,jgp,np,np)) - AT_3D(vtemp,igp,jgp,0,np,2) - glnps1;
-          AT_3D(vtens2,ilev,igp,jgp,np,np) = - AT_4D(v_vadv,ilev,igp,jgp,1,np,np,2) - v1 * (AT_2D(fcor,igp,jgp,np) + AT_3D(vort,ilev,igp,jgp,np,np)) - AT_3D(vtemp,igp,jgp,1,np,2) - glnps2;
+            AT_3D(vtens1,ilev,igp,jgp,np,np) = - AT_4D(v_vadv,ilev,igp,jgp,0,np,np,2) + v2 * (AT_2D(fcor,igp,jgp,np) + AT_3D(vort,ilev,igp,jgp,np,np)) - AT_3D(vtemp,igp,jgp,0,np,2) - glnps1;
+            AT_3D(vtens2,ilev,igp,jgp,np,np) = - AT_4D(v_vadv,ilev,igp,jgp,1,np,np,2) - v1 * (AT_2D(fcor,igp,jgp,np) + AT_3D(vort,ilev,igp,jgp,np,np)) - AT_3D(vtemp,igp,jgp,1,np,2) - glnps2;
 
-          AT_3D(ttens,ilev,igp,jgp,np,np) = AT_3D(T_vadv,ilev,igp,jgp,np,np) - AT_2D(vgrad_T,igp,jgp,np)
-                                          + AT_3D(kappa_star,ilev,igp,jgp,np,np) * AT_3D(T_v,ilev,igp,jgp,np,np) * AT_3D(omega_p_tmp,ilev,igp,jgp,np,np);
+            AT_3D(ttens,ilev,igp,jgp,np,np) = AT_3D(T_vadv,ilev,igp,jgp,np,np) - AT_2D(vgrad_T,igp,jgp,np)
+                                            + AT_3D(kappa_star,ilev,igp,jgp,np,np) * AT_3D(T_v,ilev,igp,jgp,np,np) * AT_3D(omega_p_tmp,ilev,igp,jgp,np,np);
+          }
         }
       }
-    }
 
-    spheremp = SLICE_3D(data.arrays.elem_spheremp,ie,np,np);
-    v_np1    = SLICE_6D_IJ(data.arrays.elem_state_v,ie,np1,timelevels,nlev,np,np,2);
-    T_np1    = SLICE_5D_IJ(data.arrays.elem_state_T,ie,np1,timelevels,nlev,np,np);
-    dp3d_np1 = SLICE_5D_IJ(data.arrays.elem_state_dp3d,ie,np1,timelevels,nlev,np,np);
+      spheremp = SLICE_3D(data.arrays.elem_spheremp,ie,np,np);
+      v_np1    = SLICE_6D_IJ(data.arrays.elem_state_v,ie,np1,timelevels,nlev,np,np,2);
+      T_np1    = SLICE_5D_IJ(data.arrays.elem_state_T,ie,np1,timelevels,nlev,np,np);
+      dp3d_np1 = SLICE_5D_IJ(data.arrays.elem_state_dp3d,ie,np1,timelevels,nlev,np,np);
 
-    v_nm1    = SLICE_6D_IJ(data.arrays.elem_state_v,ie,nm1,timelevels,nlev,np,np,2);
-    T_nm1    = SLICE_5D_IJ(data.arrays.elem_state_T,ie,nm1,timelevels,nlev,np,np);
-    dp3d_nm1 = SLICE_5D_IJ(data.arrays.elem_state_dp3d,ie,nm1,timelevels,nlev,np,np);
+      v_nm1    = SLICE_6D_IJ(data.arrays.elem_state_v,ie,nm1,timelevels,nlev,np,np,2);
+      T_nm1    = SLICE_5D_IJ(data.arrays.elem_state_T,ie,nm1,timelevels,nlev,np,np);
+      dp3d_nm1 = SLICE_5D_IJ(data.arrays.elem_state_dp3d,ie,nm1,timelevels,nlev,np,np);
 
-    for (int ilev=0; ilev<nlev; ++ilev)
-    {
-      for (int igp=0; igp<np; ++igp)
+      for (int ilev=0; ilev<nlev; ++ilev)
       {
-        for (int jgp=0; jgp<np; ++jgp)
+        for (int igp=0; igp<np; ++igp)
         {
-          AT_4D(v_np1,ilev,igp,jgp,0,np,np,2) = AT_2D(spheremp,igp,jgp,np) * (AT_4D(v_nm1,ilev,igp,jgp,0,np,np,2) + dt2*AT_3D(vtens1,ilev,igp,jgp,np,np));
-          AT_4D(v_np1,ilev,igp,jgp,1,np,np,2) = AT_2D(spheremp,igp,jgp,np) * (AT_4D(v_nm1,ilev,igp,jgp,1,np,np,2) + dt2*AT_3D(vtens2,ilev,igp,jgp,np,np));
-          AT_3D(T_np1,ilev,igp,jgp,np,np)     = AT_2D(spheremp,igp,jgp,np) * (AT_3D(T_nm1,ilev,igp,jgp,np,np) + dt2*AT_3D(ttens,ilev,igp,jgp,np,np));
-          AT_3D(dp3d_np1,ilev,igp,jgp,np,np)  = AT_2D(spheremp,igp,jgp,np) * (AT_3D(dp3d_nm1,ilev,igp,jgp,np,np) - dt2*AT_3D(divdp,ilev,igp,jgp,np,np));
+          for (int jgp=0; jgp<np; ++jgp)
+          {
+            AT_4D(v_np1,ilev,igp,jgp,0,np,np,2) = AT_2D(spheremp,igp,jgp,np) * (AT_4D(v_nm1,ilev,igp,jgp,0,np,np,2) + dt2*AT_3D(vtens1,ilev,igp,jgp,np,np));
+            AT_4D(v_np1,ilev,igp,jgp,1,np,np,2) = AT_2D(spheremp,igp,jgp,np) * (AT_4D(v_nm1,ilev,igp,jgp,1,np,np,2) + dt2*AT_3D(vtens2,ilev,igp,jgp,np,np));
+            AT_3D(T_np1,ilev,igp,jgp,np,np)     = AT_2D(spheremp,igp,jgp,np) * (AT_3D(T_nm1,ilev,igp,jgp,np,np) + dt2*AT_3D(ttens,ilev,igp,jgp,np,np));
+            AT_3D(dp3d_np1,ilev,igp,jgp,np,np)  = AT_2D(spheremp,igp,jgp,np) * (AT_3D(dp3d_nm1,ilev,igp,jgp,np,np) - dt2*AT_3D(divdp,ilev,igp,jgp,np,np));
+          }
         }
       }
     }
   }
-
-  delete[] Ephi             ;
-  delete[] T_v              ;
-  delete[] divdp            ;
-  delete[] grad_p           ;
-  delete[] eta_dot_dpdn_tmp ;
-  delete[] kappa_star       ;
-  delete[] omega_p_tmp      ;
-  delete[] p                ;
-  delete[] ttens            ;
-  delete[] T_vadv           ;
-  delete[] v_vadv           ;
-  delete[] vdp              ;
-  delete[] vgrad_T          ;
-  delete[] vgrad_p          ;
-  delete[] vort             ;
-  delete[] vtemp            ;
-  delete[] vtens1           ;
-  delete[] vtens2           ;
 }
 
 void preq_hydrostatic (const real* const phis, const real* const T_v,
@@ -2,8 +2,13 @@
 #include "data_structures.hpp"
 
 #include "test_macros.hpp"
+#include <algorithm>
 #include <random>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace Homme
 {
 
@@ -11,24 +16,24 @@ extern int num_elems;
 
 void Arrays::init_data ()
 {
-  elem_D                    = new real[num_elems*np*np*2*2] {};
-  elem_Dinv                 = new real[num_elems*np*np*2*2] {};
-  elem_fcor                 = new real[num_elems*np*np]     {};
-  elem_spheremp             = new real[num_elems*np*np]     {};
-  elem_metdet               = new real[num_elems*np*np]     {};
-  elem_rmetdet              = new real[num_elems*np*np]     {};
-
-  elem_state_dp3d           = new real[num_elems*timelevels*nlev*np*np]   {};
-  elem_state_v              = new real[num_elems*timelevels*nlev*np*np*2] {};
-  elem_state_T              = new real[num_elems*timelevels*nlev*np*np]   {};
-  elem_state_phis           = new real[num_elems*np*np]                   {};
-  elem_state_Qdp            = new real[num_elems*qsize_d*2*nlev*np*np]    {};
-
-  elem_derived_eta_dot_dpdn = new real[num_elems*nlevp*np*np]  {};
-  elem_derived_omega_p      = new real[num_elems*nlev*np*np]   {};
-  elem_derived_phi          = new real[num_elems*nlev*np*np]   {};
-  elem_derived_pecnd        = new real[num_elems*nlev*np*np]   {};
-  elem_derived_vn0          = new real[num_elems*nlev*np*np*2] {};
+  elem_D                    = new real[num_elems*np*np*2*2];
+  elem_Dinv                 = new real[num_elems*np*np*2*2];
+  elem_fcor                 = new real[num_elems*np*np];
+  elem_spheremp             = new real[num_elems*np*np];
+  elem_metdet               = new real[num_elems*np*np];
+  elem_rmetdet              = new real[num_elems*np*np];
+
+  elem_state_dp3d           = new real[num_elems*timelevels*nlev*np*np];
+  elem_state_v              = new real[num_elems*timelevels*nlev*np*np*2];
+  elem_state_T              = new real[num_elems*timelevels*nlev*np*np];
+  elem_state_phis           = new real[num_elems*np*np];
+  elem_state_Qdp            = new real[num_elems*qsize_d*2*nlev*np*np];
+
+  elem_derived_eta_dot_dpdn = new real[num_elems*nlevp*np*np];
+  elem_derived_omega_p      = new real[num_elems*nlev*np*np];
+  elem_derived_phi          = new real[num_elems*nlev*np*np];
+  elem_derived_pecnd        = new real[num_elems*nlev*np*np];
+  elem_derived_vn0          = new real[num_elems*nlev*np*np*2];
 
   // Initialize arrays using sin^2(n*x) map.
   // This is easily portable across different platforms and/or
@@ -38,9 +43,16 @@ void Arrays::init_data ()
   constexpr double x = 0.123456789;
 
   int n = 1;
-  // Now fiil all the arrays
+  // Now fiil all the arrays. The elements are split over the threads as in
+  // compute_and_apply_rhs, so that the pages of each element are first
+  // touched by the thread which computes it
+  #pragma omp parallel for schedule(static)
   for (int ie=0; ie<num_elems; ++ie)
   {
+    // Only the first tracer of Qdp is set, and eta_dot_dpdn is not set at all
+    std::fill_n (SLICE_6D(elem_state_Qdp,ie,qsize_d,2,nlev,np,np), qsize_d*2*nlev*np*np, 0.0);
+    std::fill_n (SLICE_4D(elem_derived_eta_dot_dpdn,ie,nlevp,np,np), nlevp*np*np, 0.0);
+
     for (int ip=0; ip<np; ++ip)
     {
       for (int jp=0; jp<np; ++jp)
@@ -169,6 +181,8 @@ void TestData::init_data ()
   control.init_data();
   hvcoord.init_data();
   deriv.init_data();
+
+  workspace.init_data(max_threads());
 }
 
 void TestData::update_time_levels ()
@@ -182,6 +196,26 @@ void TestData::update_time_levels ()
 void TestData::cleanup_data ()
 {
   arrays.cleanup_data();
+
+  workspace.cleanup_data();
+}
+
+int thread_id ()
+{
+#ifdef _OPENMP
+  return omp_get_thread_num();
+#else
+  return 0;
+#endif
+}
+
+int max_threads ()
+{
+#ifdef _OPENMP
+  return omp_get_max_threads();
+#else
+  return 1;
+#endif
 }
 
 } // Namespace Homme
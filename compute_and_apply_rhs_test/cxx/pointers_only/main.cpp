@@ -100,6 +100,8 @@ int main (int argc, char** argv)
 
   std::cout << " --- Initializing data...\n";
   data.init_data();
+  std::cout << "   ---> Workspace: " << data.workspace.bytes_per_slab()/1024 << " KB per thread ("
+            << WorkspaceArena::unshared_bytes()/1024 << " KB without sharing storage)\n";
 
   // Print norm of initial states, to check we are using same data in all tests
   print_results_2norm (data);
@@ -107,7 +109,7 @@ int main (int argc, char** argv)
   // Burn in to avoid cache effects
   //compute_and_apply_rhs(data);
 
-  std::cout << " --- Performing computations... (" << num_exec << " executions of the main loop on " << num_elems << " elements)\n";
+  std::cout << " --- Performing computations... (" << num_exec << " executions of the main loop on " << num_elems << " elements, " << max_threads() << " threads)\n";
   //std::vector<Timer::Timer> timers(num_exec);
   Timer::Timer global_timer;
   for (int i=0; i<num_exec; ++i)
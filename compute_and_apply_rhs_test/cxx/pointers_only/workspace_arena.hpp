@@ -0,0 +1,74 @@
+#ifndef WORKSPACE_ARENA_HPP
+#define WORKSPACE_ARENA_HPP
+
+#include "kinds.hpp"
+
+#include <cassert>
+#include <cstddef>
+
+namespace Homme
+{
+
+// The temporaries of compute_and_apply_rhs for one element
+enum Temporary
+{
+  TMP_P,
+  TMP_GRAD_P,
+  TMP_VDP,
+  TMP_VGRAD_P,
+  TMP_DIVDP,
+  TMP_VORT,
+  TMP_T_V,
+  TMP_KAPPA_STAR,
+  TMP_OMEGA_P,
+  TMP_EPHI,
+  TMP_VTEMP,
+  TMP_VGRAD_T,
+  TMP_VTENS1,
+  TMP_VTENS2,
+  TMP_TTENS,
+  TMP_ETA_DOT_DPDN,
+  TMP_T_VADV,
+  TMP_V_VADV,
+  NUM_TEMPORARIES
+};
+
+// The temporaries of each thread live in one slab. Temporaries whose
+// lifetimes in the element loop do not overlap share storage, as given by
+// the liveness table in workspace_arena.cpp. The slabs are allocated once
+// and are not zeroed, except for the temporaries which are only read
+struct WorkspaceArena
+{
+  int     num_threads    = 0;
+  size_t  reals_per_slab = 0;
+  size_t  offsets[NUM_TEMPORARIES] = {};
+  real**  slabs          = nullptr;
+
+  void init_data (int num_threads);
+  void cleanup_data ();
+
+  // The storage of the temporary in the slab of the thread
+  real* get (Temporary tmp, int thread) const
+  {
+    return slabs[thread] + offsets[tmp];
+  }
+
+  // The same, viewed as an array such as real[nlev][np][np]
+  template<typename Array>
+  Array& get (Temporary tmp, int thread) const
+  {
+    assert (sizeof(Array) == size(tmp)*sizeof(real));
+    return *reinterpret_cast<Array*>(get(tmp,thread));
+  }
+
+  // The number of reals of the temporary
+  static size_t size (Temporary tmp);
+
+  // The size of a slab, and what it would be without sharing storage
+  size_t bytes_per_slab () const;
+  static size_t unshared_bytes ();
+};
+
+} // Namespace Homme
+
+#endif // WORKSPACE_ARENA_HPP
@@ -1,5 +1,11 @@
 #include "common.hpp"
 
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 void saxpby( const double a
            , const double b
            , double * x
@@ -14,3 +20,80 @@ void saxpby( const double a
   }}}
 }
 
+namespace {
+
+int max_threads() {
+#ifdef _OPENMP
+  return omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+
+long num_tiles( const int n, const int tile ) {
+  return (n + tile - 1) / tile;
+}
+
+// Loops over the dimensions outer, middle and inner (0 for i, 1 for j, 2
+// for k), known at compile time so that the stride of the innermost loop
+// is too
+template<int outer, int middle, int inner>
+void saxpby_order( const int tile[3]
+                 , const double a
+                 , const double b
+                 , double * __restrict__ x
+                 , const double * __restrict__ y
+                 )
+{
+  const int n[3] = { I1, I2, I3 };
+  const long stride[3] = { static_cast<long>(I2)*I3, I3, 1 };
+
+  // With fewer tiles than threads, as without tiling, the tiles are split
+  // along the outer dimension until there is one per thread
+  int outer_tile = tile[outer];
+  const long inner_tiles = num_tiles(n[middle], tile[middle]) * num_tiles(n[inner], tile[inner]);
+  const int threads = max_threads();
+  if (num_tiles(n[outer], outer_tile) * inner_tiles < threads) {
+    const long outer_tiles = (threads + inner_tiles - 1) / inner_tiles;
+    outer_tile = std::max(1L, (n[outer] + outer_tiles - 1) / outer_tiles);
+  }
+
+  #pragma omp parallel for collapse(3)
+  for (int t0=0; t0<n[outer];  t0+=outer_tile) {
+  for (int t1=0; t1<n[middle]; t1+=tile[middle]) {
+  for (int t2=0; t2<n[inner];  t2+=tile[inner]) {
+    const int e0 = std::min(t0 + outer_tile,   n[outer]);
+    const int e1 = std::min(t1 + tile[middle], n[middle]);
+    const int e2 = std::min(t2 + tile[inner],  n[inner]);
+    for (int i0=t0; i0<e0; ++i0) {
+    for (int i1=t1; i1<e1; ++i1) {
+      const long offset = i0*stride[outer] + i1*stride[middle];
+      double * __restrict__ x_line = x + offset;
+      const double * __restrict__ y_line = y + offset;
+      #pragma omp simd
+      for (int i2=t2; i2<e2; ++i2) {
+        x_line[i2*stride[inner]] = a * x_line[i2*stride[inner]] + b * y_line[i2*stride[inner]];
+      }
+    }}
+  }}}
+}
+
+} // anonymous namespace
+
+bool saxpby_ordered( const std::string & order
+                   , const int tile[3]
+                   , const double a
+                   , const double b
+                   , double * x
+                   , const double * y
+                   )
+{
+  if      (order == "ijk") saxpby_order<0,1,2>(tile, a, b, x, y);
+  else if (order == "ikj") saxpby_order<0,2,1>(tile, a, b, x, y);
+  else if (order == "jik") saxpby_order<1,0,2>(tile, a, b, x, y);
+  else if (order == "jki") saxpby_order<1,2,0>(tile, a, b, x, y);
+  else if (order == "kij") saxpby_order<2,0,1>(tile, a, b, x, y);
+  else if (order == "kji") saxpby_order<2,1,0>(tile, a, b, x, y);
+  else return false;
+  return true;
+}
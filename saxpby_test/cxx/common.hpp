@@ -5,9 +5,10 @@
 #include <chrono>
 #include <string>
 
+// The extents, set at run time
 extern int I1;
-constexpr int I2=128;
-constexpr int I3=256;
+extern int I2;
+extern int I3;
 
 struct Timer {
 
@@ -39,8 +40,8 @@ struct Timer {
 };
 
 inline
-constexpr int IDX(int i, int j, int k) {
-  return k + I3*j + I2*I3*i;
+long IDX(int i, int j, int k) {
+  return k + I3*static_cast<long>(j) + I2*I3*static_cast<long>(i);
 }
 
 void saxpby( const double a
@@ -49,4 +50,18 @@ void saxpby( const double a
            , const double * __restrict__ y
            );
 
+// The same saxpby, with the loops in the given order, e.g. "kij" for k
+// outermost and j innermost, and with tiles of tile[0] x tile[1] x tile[2]
+// points along i, j and k. The tile loops are parallel, the innermost point
+// loop is simd. With fewer tiles than threads, the outer tiles are split so
+// that all the threads get some. Returns false if the order is not a
+// permutation of "ijk"
+bool saxpby_ordered( const std::string & order
+                   , const int tile[3]
+                   , const double a
+                   , const double b
+                   , double * __restrict__ x
+                   , const double * __restrict__ y
+                   );
+
 #endif // COMMON_HPP
@@ -1,18 +1,60 @@
 #include "common.hpp"
+#include "stream.hpp"
+#include "sweep.hpp"
 
 #include <iostream>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <string>
 
 #include <config.h>
 
 int I1 = I1_MACRO;
+int I2 = I2_MACRO;
+int I3 = I3_MACRO;
 
 int main( int argc, char * argv[] )
 {
-  if (argc > 1) {
-    I1 = std::atoi( argv[1] );
+  // saxbpy_test_cxx --stream [MB] measures the bandwidth of the memory
+  // with arrays of up to MB MB instead
+  if (argc > 1 && std::string(argv[1]) == "--stream") {
+    run_stream_suite( (argc > 2 ? std::atol( argv[2] ) : 0), "bandwidth.dat" );
+    return 0;
+  }
+
+  // saxbpy_test_cxx [I1 [I2 [I3]]] [--order=ijk] [--tile=T1,T2,T3] [--sweep]
+  // --order and --tile select saxpby_ordered, with tiles of 0 spanning the
+  // whole extent. --sweep times all the orders and tiles on the shapes of
+  // the element arrays, with I1 elements
+  std::string order;
+  int tile[3] = { 0, 0, 0 };
+  bool sweep = false;
+  int num_positional = 0;
+  for (int iarg = 1; iarg < argc; ++iarg) {
+    if (std::strncmp( argv[iarg], "--order=", 8 ) == 0) {
+      order = argv[iarg] + 8;
+    } else if (std::strncmp( argv[iarg], "--tile=", 7 ) == 0) {
+      if (std::sscanf( argv[iarg] + 7, "%d,%d,%d", &tile[0], &tile[1], &tile[2] ) != 3) {
+        std::cerr << "Expecting --tile=T1,T2,T3\n";
+        return 1;
+      }
+      if (order.empty()) {
+        order = "ijk";
+      }
+    } else if (std::strcmp( argv[iarg], "--sweep" ) == 0) {
+      sweep = true;
+    } else {
+      int * const extents[3] = { &I1, &I2, &I3 };
+      if (num_positional < 3) {
+        *extents[num_positional++] = std::atoi( argv[iarg] );
+      }
+    }
+  }
+
+  if (sweep) {
+    run_loop_sweep( I1, 10 );
+    return 0;
   }
 
   double * x;
@@ -34,11 +76,26 @@ int main( int argc, char * argv[] )
     }}}
   }
 
-  {
+  if (order.empty()) {
     Timer t("saxpby");
     for (int iteration = 0; iteration < 100; ++iteration) {
       saxpby(3.0,5.0,x,y);
     }
+  } else {
+    const int extents[3] = { I1, I2, I3 };
+    for (int dim = 0; dim < 3; ++dim) {
+      if (tile[dim] <= 0) {
+        tile[dim] = extents[dim];
+      }
+    }
+    Timer t("saxpby " + order + " tile " + std::to_string(tile[0]) + "," +
+            std::to_string(tile[1]) + "," + std::to_string(tile[2]));
+    for (int iteration = 0; iteration < 100; ++iteration) {
+      if (!saxpby_ordered(order, tile, 3.0, 5.0, x, y)) {
+        std::cerr << "Unknown loop order " << order << ", expecting a permutation of ijk\n";
+        return 1;
+      }
+    }
   }
 
 
@@ -47,6 +104,3 @@ int main( int argc, char * argv[] )
 
   return 0;
 }
-
-
-
@@ -0,0 +1,316 @@
+#include "stream.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+#include <unistd.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+constexpr double scalar = 3.0;
+constexpr int num_trials = 5;
+constexpr long bytes_per_trial = 256L * 1024 * 1024;
+
+const StreamKernel kernels[] = { StreamKernel::COPY, StreamKernel::SCALE,
+                                 StreamKernel::ADD, StreamKernel::TRIAD };
+const char * const kernel_names[] = { "copy", "scale", "add", "triad" };
+
+enum Level { L1 = 0, L2, L3, DRAM, NUM_LEVELS };
+const char * const level_names[] = { "L1", "L2", "L3", "DRAM" };
+
+int team_size() {
+#ifdef _OPENMP
+  return omp_get_num_threads();
+#else
+  return 1;
+#endif
+}
+
+int thread_id() {
+#ifdef _OPENMP
+  return omp_get_thread_num();
+#else
+  return 0;
+#endif
+}
+
+int max_threads() {
+#ifdef _OPENMP
+  return omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+
+// The part [begin, end) of the n elements handled by thread t out of num.
+// The bounds are even, so that the 16 bytes stores stay aligned
+void thread_range( const long n, const int t, const int num
+                 , long & begin, long & end )
+{
+  const long pairs_per_thread = ((n + 1) / 2 + num - 1) / num;
+  begin = std::min(n, 2 * pairs_per_thread * t);
+  end   = std::min(n, 2 * pairs_per_thread * (t + 1));
+}
+
+// The number of arrays read or written by the kernel
+int num_arrays( const StreamKernel kernel ) {
+  return (kernel == StreamKernel::COPY || kernel == StreamKernel::SCALE ? 2 : 3);
+}
+
+template<StreamKernel kernel>
+inline double value( const long i, const double * __restrict__ b, const double * __restrict__ c ) {
+  switch (kernel) {
+    case StreamKernel::COPY:  return b[i];
+    case StreamKernel::SCALE: return scalar * b[i];
+    case StreamKernel::ADD:   return b[i] + c[i];
+    default:                  return b[i] + scalar * c[i];
+  }
+}
+
+template<StreamKernel kernel>
+void run_range( const StreamStores stores, const long begin, const long end
+              , double * __restrict__ a
+              , const double * __restrict__ b
+              , const double * __restrict__ c )
+{
+#ifdef __SSE2__
+  if (stores == StreamStores::NON_TEMPORAL) {
+    const __m128d s = _mm_set1_pd(scalar);
+    for (long i = begin; i < end; i += 2) {
+      __m128d v;
+      switch (kernel) {
+        case StreamKernel::COPY:  v = _mm_load_pd(b + i); break;
+        case StreamKernel::SCALE: v = _mm_mul_pd(s, _mm_load_pd(b + i)); break;
+        case StreamKernel::ADD:   v = _mm_add_pd(_mm_load_pd(b + i), _mm_load_pd(c + i)); break;
+        default: v = _mm_add_pd(_mm_load_pd(b + i), _mm_mul_pd(s, _mm_load_pd(c + i)));
+      }
+      _mm_stream_pd(a + i, v);
+    }
+    // The streaming stores are weakly ordered
+    _mm_sfence();
+    return;
+  }
+#endif
+  #pragma omp simd
+  for (long i = begin; i < end; ++i) {
+    a[i] = value<kernel>(i, b, c);
+  }
+}
+
+// Touches the pages of each thread's part of the arrays, from the thread
+// which uses them or from the one half the team away
+void first_touch( const StreamPlacement placement, const long n
+                , double * a, double * b, double * c )
+{
+  #pragma omp parallel
+  {
+    const int num = team_size();
+    const int owner = (placement == StreamPlacement::REMOTE
+                       ? (thread_id() + num / 2) % num : thread_id());
+    long begin, end;
+    thread_range(n, owner, num, begin, end);
+    for (long i = begin; i < end; ++i) {
+      a[i] = 0.0;
+      b[i] = 1.0;
+      c[i] = 2.0;
+    }
+  }
+}
+
+struct Arrays {
+  Arrays( const long n, const StreamPlacement placement ) : n(n) {
+    posix_memalign( reinterpret_cast<void**>(&a), 128, sizeof(double)*n);
+    posix_memalign( reinterpret_cast<void**>(&b), 128, sizeof(double)*n);
+    posix_memalign( reinterpret_cast<void**>(&c), 128, sizeof(double)*n);
+    first_touch(placement, n, a, b, c);
+  }
+
+  Arrays( Arrays const& ) = delete;
+  Arrays & operator=( Arrays const& ) = delete;
+
+  ~Arrays() {
+    free(a);
+    free(b);
+    free(c);
+  }
+
+  long n;
+  double * a;
+  double * b;
+  double * c;
+};
+
+// The best GB/s of the kernel over the trials, counting the bytes as STREAM
+// does: the reads of the destination before a regular store are not counted
+double measure( const StreamKernel kernel, const StreamStores stores
+              , const Arrays & arrays )
+{
+  using clock_type = std::chrono::high_resolution_clock;
+  const long bytes = num_arrays(kernel) * sizeof(double) * arrays.n;
+  const int repetitions = std::max(1L, bytes_per_trial / bytes);
+  double best = std::numeric_limits<double>::max();
+  for (int trial = 0; trial < num_trials; ++trial) {
+    const auto start = clock_type::now();
+    stream_kernel(kernel, stores, arrays.n, repetitions, arrays.a, arrays.b, arrays.c);
+    const double seconds = 1.0e-9 * std::chrono::duration_cast<std::chrono::nanoseconds>( clock_type::now() - start ).count();
+    best = std::min(best, seconds / repetitions);
+  }
+  return 1.0e-9 * bytes / best;
+}
+
+long cache_bytes( const int name, const long default_bytes ) {
+  const long bytes = sysconf(name);
+  return (bytes > 0 ? bytes : default_bytes);
+}
+
+struct Peak {
+  double gb_per_second = 0.0;
+  // The largest working set measured in the level
+  long bytes = 0;
+  const char * kernel = nullptr;
+  StreamStores stores = StreamStores::REGULAR;
+};
+
+} // anonymous namespace
+
+void stream_kernel( const StreamKernel kernel
+                  , const StreamStores stores
+                  , const long n
+                  , const int repetitions
+                  , double * __restrict__ a
+                  , const double * __restrict__ b
+                  , const double * __restrict__ c
+                  )
+{
+  #pragma omp parallel
+  {
+    long begin, end;
+    thread_range(n, thread_id(), team_size(), begin, end);
+    for (int repetition = 0; repetition < repetitions; ++repetition) {
+      switch (kernel) {
+        case StreamKernel::COPY:  run_range<StreamKernel::COPY> (stores, begin, end, a, b, c); break;
+        case StreamKernel::SCALE: run_range<StreamKernel::SCALE>(stores, begin, end, a, b, c); break;
+        case StreamKernel::ADD:   run_range<StreamKernel::ADD>  (stores, begin, end, a, b, c); break;
+        case StreamKernel::TRIAD: run_range<StreamKernel::TRIAD>(stores, begin, end, a, b, c); break;
+      }
+    }
+  }
+}
+
+void run_stream_suite( const long max_array_mb
+                     , const std::string & file_name
+                     )
+{
+  const int num_threads = max_threads();
+  // L1 and L2 are private to each core, L3 is shared
+  const long l1_bytes = cache_bytes(_SC_LEVEL1_DCACHE_SIZE, 32L * 1024) * num_threads;
+  const long l2_bytes = cache_bytes(_SC_LEVEL2_CACHE_SIZE, 1024L * 1024) * num_threads;
+  const long l3_bytes = cache_bytes(_SC_LEVEL3_CACHE_SIZE, 32L * 1024 * 1024);
+  const long max_array_bytes =
+      (max_array_mb > 0 ? max_array_mb * 1024 * 1024
+                        : std::max(64L * 1024 * 1024, std::min(1024L * 1024 * 1024, 2 * l3_bytes)));
+
+  // The level the working set of a kernel fits in, leaving half the cache
+  // to the rest. Working sets between half a cache and the next level fall
+  // in none, so that the transitions do not lower the peaks
+  auto level = [&]( const long bytes ) {
+    if (bytes <= l1_bytes / 2) return static_cast<int>(L1);
+    if (bytes > l1_bytes && bytes <= l2_bytes / 2) return static_cast<int>(L2);
+    if (bytes > l2_bytes && bytes <= l3_bytes / 2) return static_cast<int>(L3);
+    if (bytes >= 4 * l3_bytes) return static_cast<int>(DRAM);
+    return -1;
+  };
+
+  std::printf("STREAM kernels on %d threads, L1 %ld KB, L2 %ld KB, L3 %ld KB in total\n",
+              num_threads, l1_bytes / 1024, l2_bytes / 1024, l3_bytes / 1024);
+#ifndef __SSE2__
+  std::printf("No SSE2, the non-temporal kernels use regular stores\n");
+#endif
+  std::printf("GB/s, best of %d\n", num_trials);
+  std::printf("%12s %6s %8s %8s %8s %8s   %8s %8s %8s %8s\n", "KB/array", "level",
+              "copy", "scale", "add", "triad", "nt copy", "nt scale", "nt add", "nt triad");
+
+  Peak peaks[NUM_LEVELS];
+  long n = 512;
+  for (; n * static_cast<long>(sizeof(double)) <= max_array_bytes; n *= 2) {
+    const Arrays arrays(n, StreamPlacement::LOCAL);
+    const long triad_bytes = 3 * sizeof(double) * n;
+    const int triad_level = level(triad_bytes);
+    std::printf("%12ld %6s", sizeof(double) * n / 1024,
+                (triad_level >= 0 ? level_names[triad_level] : "-"));
+    for (const StreamStores stores : { StreamStores::REGULAR, StreamStores::NON_TEMPORAL }) {
+      if (stores == StreamStores::NON_TEMPORAL) {
+        std::printf("  ");
+      }
+      for (int k = 0; k < 4; ++k) {
+        const double gb_per_second = measure(kernels[k], stores, arrays);
+        std::printf(" %8.2f", gb_per_second);
+        const long bytes = num_arrays(kernels[k]) * sizeof(double) * n;
+        const int kernel_level = level(bytes);
+        if (kernel_level >= 0) {
+          Peak & peak = peaks[kernel_level];
+          peak.bytes = std::max(peak.bytes, bytes);
+          if (gb_per_second > peak.gb_per_second) {
+            peak.gb_per_second = gb_per_second;
+            peak.kernel = kernel_names[k];
+            peak.stores = stores;
+          }
+        }
+      }
+    }
+    std::printf("\n");
+  }
+
+  // Placement, at the largest size
+  n /= 2;
+  if (num_threads > 1) {
+    std::printf("First touch at %ld KB per array (meaningful with OMP_PROC_BIND=spread over two sockets)\n",
+                sizeof(double) * n / 1024);
+    for (const StreamPlacement placement : { StreamPlacement::LOCAL, StreamPlacement::REMOTE }) {
+      const Arrays arrays(n, placement);
+      std::printf("%12s %6s", (placement == StreamPlacement::LOCAL ? "local" : "remote"), "");
+      for (const StreamStores stores : { StreamStores::REGULAR, StreamStores::NON_TEMPORAL }) {
+        if (stores == StreamStores::NON_TEMPORAL) {
+          std::printf("  ");
+        }
+        for (int k = 0; k < 4; ++k) {
+          std::printf(" %8.2f", measure(kernels[k], stores, arrays));
+        }
+      }
+      std::printf("\n");
+    }
+  }
+
+  FILE * fp = std::fopen(file_name.c_str(), "w");
+  if (fp == nullptr) {
+    std::perror(file_name.c_str());
+    return;
+  }
+  std::fprintf(fp, "# Peak bandwidth of each level of the memory, from saxbpy_test_cxx --stream on %d threads\n",
+               num_threads);
+  std::fprintf(fp, "# level, largest working set measured in the level (bytes, 0 if unbounded), GB/s, kernel\n");
+  std::printf("Peak bandwidth, written to %s:\n", file_name.c_str());
+  for (int l = 0; l < NUM_LEVELS; ++l) {
+    const Peak & peak = peaks[l];
+    if (peak.kernel == nullptr) {
+      continue;
+    }
+    const char * stores = (peak.stores == StreamStores::REGULAR ? "" : "nt_");
+    std::fprintf(fp, "%s %ld %.3f %s%s\n", level_names[l], (l == DRAM ? 0L : peak.bytes),
+                 peak.gb_per_second, stores, peak.kernel);
+    std::printf("%12s %8.2f GB/s (%s%s)\n", level_names[l], peak.gb_per_second, stores, peak.kernel);
+  }
+  std::fclose(fp);
+}
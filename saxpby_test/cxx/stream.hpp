@@ -0,0 +1,37 @@
+#ifndef STREAM_HPP
+#define STREAM_HPP
+
+#include <string>
+
+// The STREAM kernels, with a = [a] s * [b] [+ c] of n doubles each
+enum class StreamKernel { COPY, SCALE, ADD, TRIAD };
+
+// Non-temporal stores bypass the caches, which saves reading the lines of
+// the destination before writing them
+enum class StreamStores { REGULAR, NON_TEMPORAL };
+
+// Where the pages of the arrays are first touched: by the thread which uses
+// them (LOCAL), or by the thread half the team away (REMOTE), which is on
+// the other socket if the threads are spread over two, e.g. with
+// OMP_PROC_BIND=spread
+enum class StreamPlacement { LOCAL, REMOTE };
+
+// Runs the kernel repetitions times, each thread on its own part of the
+// arrays. The arrays must be aligned to 16 bytes
+void stream_kernel( const StreamKernel kernel
+                  , const StreamStores stores
+                  , const long n
+                  , const int repetitions
+                  , double * __restrict__ a
+                  , const double * __restrict__ b
+                  , const double * __restrict__ c
+                  );
+
+// Measures the bandwidth of the kernels from L1 sized arrays to arrays of
+// max_array_mb MB (twice the L3 cache, up to 1 GB, if 0), and writes the
+// peak of each level of the memory to file_name, for the CAAR benchmarks
+void run_stream_suite( const long max_array_mb
+                     , const std::string & file_name
+                     );
+
+#endif // STREAM_HPP
@@ -0,0 +1,118 @@
+#include "sweep.hpp"
+#include "common.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int NP = 4;
+constexpr int NUM_LEV = 72;
+
+const char * const orders[] = { "ijk", "ikj", "jik", "jki", "kij", "kji" };
+
+struct Shape {
+  const char * name;
+  int extents[3];
+};
+
+struct Result {
+  std::string order;
+  int tile[3];
+  double gb_per_second;
+};
+
+// The full extent, and the smaller of 4, 16 and 64
+std::vector<int> tile_sizes( const int extent ) {
+  std::vector<int> sizes(1, extent);
+  for (const int size : { 4, 16, 64 }) {
+    if (size < extent) {
+      sizes.push_back(size);
+    }
+  }
+  return sizes;
+}
+
+double time_saxpby( const std::string & order, const int tile[3], const int iterations
+                  , double * x, const double * y )
+{
+  // One untimed pass to fault the pages in and warm the caches
+  saxpby_ordered(order, tile, 3.0, 5.0, x, y);
+  using clock_type = std::chrono::high_resolution_clock;
+  const auto start = clock_type::now();
+  for (int iteration = 0; iteration < iterations; ++iteration) {
+    saxpby_ordered(order, tile, 3.0, 5.0, x, y);
+  }
+  return 1.0e-9 * std::chrono::duration_cast<std::chrono::nanoseconds>( clock_type::now() - start ).count();
+}
+
+void print_result( const char * label, const Result & result ) {
+  std::printf("  %-10s %s tile %4d x %4d x %4d: %8.3f GB/s\n", label, result.order.c_str(),
+              result.tile[0], result.tile[1], result.tile[2], result.gb_per_second);
+}
+
+} // anonymous namespace
+
+void run_loop_sweep( const int num_elems
+                   , const int iterations
+                   )
+{
+  const Shape shapes[] = {
+    { "element, point, level", { num_elems, NP*NP, NUM_LEV } },
+    { "element, level, point", { num_elems, NUM_LEV, NP*NP } },
+    { "level, point, element", { NUM_LEV, NP*NP, num_elems } },
+  };
+
+  for (const Shape & shape : shapes) {
+    I1 = shape.extents[0];
+    I2 = shape.extents[1];
+    I3 = shape.extents[2];
+    const long size = static_cast<long>(I1)*I2*I3;
+    double * x;
+    double * y;
+    posix_memalign( reinterpret_cast<void**>(&x), 128, sizeof(double)*size);
+    posix_memalign( reinterpret_cast<void**>(&y), 128, sizeof(double)*size);
+    // Small values, so that the iterations do not overflow
+    #pragma omp parallel for
+    for (long n=0; n<size; ++n) {
+      x[n] = 1.0e-3 * (n % 1000);
+      y[n] = 1.0e-3;
+    }
+
+    // x and y read, x written
+    const double gb = 1.0e-9 * iterations * 3 * sizeof(double) * size;
+    std::vector<Result> results;
+    for (const char * order : orders) {
+      for (const int tile_i : tile_sizes(I1)) {
+      for (const int tile_j : tile_sizes(I2)) {
+      for (const int tile_k : tile_sizes(I3)) {
+        Result result = { order, { tile_i, tile_j, tile_k }, 0.0 };
+        result.gb_per_second = gb / time_saxpby(order, result.tile, iterations, x, y);
+        results.push_back(result);
+      }}}
+    }
+
+    std::printf("%s (%d x %d x %d, k contiguous), %zu variants:\n", shape.name, I1, I2, I3,
+                results.size());
+    // The untiled ijk loop is the first
+    print_result("reference", results.front());
+    for (const char * order : orders) {
+      const Result * best = nullptr;
+      for (const Result & result : results) {
+        if (result.order == order && (best == nullptr || result.gb_per_second > best->gb_per_second)) {
+          best = &result;
+        }
+      }
+      print_result(order, *best);
+    }
+    print_result("best", *std::max_element(results.begin(), results.end(),
+        [](const Result & r1, const Result & r2) { return r1.gb_per_second < r2.gb_per_second; }));
+
+    free(x);
+    free(y);
+  }
+}
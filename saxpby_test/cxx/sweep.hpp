@@ -0,0 +1,12 @@
+#ifndef SWEEP_HPP
+#define SWEEP_HPP
+
+// Times saxpby_ordered with every loop order and a range of tiles, on the
+// shapes of the element arrays of num_elems elements of NP x NP points and
+// NUM_LEV levels, and prints the best order and tile of each shape.
+// Changes I1, I2 and I3
+void run_loop_sweep( const int num_elems
+                   , const int iterations
+                   );
+
+#endif // SWEEP_HPP
@@ -0,0 +1,117 @@
+#include "common.hpp"
+#include "saxpby_kokkos.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <config.h>
+
+int I1 = I1_MACRO;
+int I2 = I2_MACRO;
+int I3 = I3_MACRO;
+
+namespace {
+
+void init( const View3D & x, const View3D & y )
+{
+  const int n2 = x.extent(1);
+  const int n3 = x.extent(2);
+  Kokkos::parallel_for( Kokkos::RangePolicy<ExecSpace>(0, x.extent(0)),
+                        KOKKOS_LAMBDA(const int i) {
+    for (int j=0; j<n2; ++j) {
+    for (int k=0; k<n3; ++k) {
+      x(i,j,k) = i*j*k;
+      y(i,j,k) = static_cast<double>(i)*i*j*j*k*k;
+    }}
+  });
+}
+
+// The sum of x, to check that the variants agree
+double checksum( const View3D & x )
+{
+  const int n2 = x.extent(1);
+  const int n3 = x.extent(2);
+  double sum = 0.0;
+  Kokkos::parallel_reduce( Kokkos::RangePolicy<ExecSpace>(0, x.extent(0)),
+                           KOKKOS_LAMBDA(const int i, double & partial) {
+    for (int j=0; j<n2; ++j) {
+    for (int k=0; k<n3; ++k) {
+      partial += x(i,j,k);
+    }}
+  }, sum);
+  return sum;
+}
+
+struct Variant {
+  std::string name;
+  std::function<void()> saxpby;
+  double seconds;
+  double checksum;
+};
+
+} // anonymous namespace
+
+int main( int argc, char * argv[] )
+{
+  Kokkos::initialize( argc, argv );
+  // saxbpy_test_kokkos [I1 [I2 [I3]]]
+  int * const extents[3] = { &I1, &I2, &I3 };
+  for (int iarg = 1, ipos = 0; iarg < argc && ipos < 3; ++iarg) {
+    if (std::strncmp( argv[iarg], "--", 2 ) != 0) {
+      *extents[ipos++] = std::atoi( argv[iarg] );
+    }
+  }
+
+  {
+    View3D x("x", I1, I2, I3);
+    View3D y("y", I1, I2, I3);
+
+    std::cout << I1 << "    " << I2 << "    " << I3 << std::endl;
+
+    std::vector<Variant> variants;
+    // The OpenMP loop of the cxx version, on the same data
+    if (std::is_same<ExecSpace::memory_space, Kokkos::HostSpace>::value) {
+      variants.push_back( { "openmp", [&](){ saxpby(3.0, 5.0, x.data(), y.data()); }, 0.0, 0.0 } );
+    }
+    variants.push_back( { "range",   [&](){ saxpby_range  (3.0, 5.0, x, y); }, 0.0, 0.0 } );
+    variants.push_back( { "mdrange", [&](){ saxpby_mdrange(3.0, 5.0, x, y); }, 0.0, 0.0 } );
+    variants.push_back( { "team",    [&](){ saxpby_team   (3.0, 5.0, x, y); }, 0.0, 0.0 } );
+    if (I3 % VECTOR_SIZE == 0) {
+      variants.push_back( { "pack",    [&](){ saxpby_pack   (3.0, 5.0, x, y); }, 0.0, 0.0 } );
+    } else {
+      std::cout << "No pack variant: I3 is not a multiple of " << VECTOR_SIZE << std::endl;
+    }
+
+    for (Variant & variant : variants) {
+      init(x, y);
+      Kokkos::fence();
+      {
+        Timer t(variant.name);
+        for (int iteration = 0; iteration < 100; ++iteration) {
+          variant.saxpby();
+        }
+        Kokkos::fence();
+        variant.seconds = t.seconds();
+      }
+      variant.checksum = checksum(x);
+    }
+
+    // x and y read, x written
+    const double gb = 1.0e-9 * 100 * 3 * sizeof(double) * I1 * I2 * I3;
+    std::printf("%-8s %12s %10s %10s %14s\n", "variant", "seconds", "GB/s", "overhead", "checksum");
+    for (const Variant & variant : variants) {
+      std::printf("%-8s %12.6f %10.3f %9.1f%% %14.6e\n", variant.name.c_str(), variant.seconds,
+                  gb / variant.seconds, 100.0 * (variant.seconds / variants[0].seconds - 1.0),
+                  variant.checksum);
+    }
+  }
+
+  Kokkos::finalize();
+  return 0;
+}
@@ -0,0 +1,72 @@
+#include "saxpby_kokkos.hpp"
+
+namespace {
+
+using TeamMember = Kokkos::TeamPolicy<ExecSpace>::member_type;
+
+using PackView3D = Kokkos::View<Scalar***, Kokkos::LayoutRight, ExecSpace,
+                                Kokkos::MemoryTraits<Kokkos::Unmanaged> >;
+
+} // anonymous namespace
+
+void saxpby_range( const double a, const double b, const View3D & x, const View3D & y )
+{
+  // The extents of the views, as the device cannot read I1, I2 and I3
+  const int n2 = x.extent(1);
+  const int n3 = x.extent(2);
+  Kokkos::parallel_for( Kokkos::RangePolicy<ExecSpace>(0, x.extent(0)),
+                        KOKKOS_LAMBDA(const int i) {
+    for (int j=0; j<n2; ++j) {
+    for (int k=0; k<n3; ++k) {
+      x(i,j,k) = a * x(i,j,k) + b * y(i,j,k);
+    }}
+  });
+}
+
+void saxpby_mdrange( const double a, const double b, const View3D & x, const View3D & y )
+{
+  using Policy = Kokkos::Experimental::MDRangePolicy<
+      ExecSpace, Kokkos::Experimental::Rank<3> >;
+  const int n1 = x.extent(0);
+  const int n2 = x.extent(1);
+  const int n3 = x.extent(2);
+  Kokkos::parallel_for( Policy({0, 0, 0}, {n1, n2, n3}),
+                        KOKKOS_LAMBDA(const int i, const int j, const int k) {
+    x(i,j,k) = a * x(i,j,k) + b * y(i,j,k);
+  });
+}
+
+void saxpby_team( const double a, const double b, const View3D & x, const View3D & y )
+{
+  const int n2 = x.extent(1);
+  const int n3 = x.extent(2);
+  Kokkos::parallel_for( Kokkos::TeamPolicy<ExecSpace>(x.extent(0), Kokkos::AUTO),
+                        KOKKOS_LAMBDA(const TeamMember & team) {
+    const int i = team.league_rank();
+    Kokkos::parallel_for( Kokkos::TeamThreadRange(team, n2), [&](const int j) {
+      Kokkos::parallel_for( Kokkos::ThreadVectorRange(team, n3), [&](const int k) {
+        x(i,j,k) = a * x(i,j,k) + b * y(i,j,k);
+      });
+    });
+  });
+}
+
+void saxpby_pack( const double a, const double b, const View3D & x, const View3D & y )
+{
+  // The views are allocated aligned to the packs
+  const PackView3D x_packs(reinterpret_cast<Scalar*>(x.data()), x.extent(0), x.extent(1),
+                           x.extent(2) / VECTOR_SIZE);
+  const PackView3D y_packs(reinterpret_cast<Scalar*>(y.data()), y.extent(0), y.extent(1),
+                           y.extent(2) / VECTOR_SIZE);
+  const int n2 = x_packs.extent(1);
+  const int n3 = x_packs.extent(2);
+  Kokkos::parallel_for( Kokkos::TeamPolicy<ExecSpace>(x_packs.extent(0), Kokkos::AUTO),
+                        KOKKOS_LAMBDA(const TeamMember & team) {
+    const int i = team.league_rank();
+    Kokkos::parallel_for( Kokkos::TeamThreadRange(team, n2), [&](const int j) {
+      for (int k=0; k<n3; ++k) {
+        x_packs(i,j,k) = a * x_packs(i,j,k) + b * y_packs(i,j,k);
+      }
+    });
+  });
+}
@@ -0,0 +1,44 @@
+#ifndef SAXPBY_KOKKOS_HPP
+#define SAXPBY_KOKKOS_HPP
+
+#include "common.hpp"
+
+#include <Kokkos_Core.hpp>
+#include <vector/KokkosKernels_Vector.hpp>
+
+using ExecSpace = Kokkos::DefaultExecutionSpace;
+
+// The same IDX(i,j,k) layout as the raw arrays of the cxx version
+using View3D = Kokkos::View<double***, Kokkos::LayoutRight, ExecSpace>;
+
+// The packs of the CAAR benchmarks, see level_vectorized_ppscan/Types.hpp
+#if   (AVX_VERSION == 1 || AVX_VERSION == 2)
+constexpr int VECTOR_SIZE = 4;
+#elif (AVX_VERSION == 512)
+constexpr int VECTOR_SIZE = 8;
+#else
+constexpr int VECTOR_SIZE = 1;
+#endif
+
+#if (AVX_VERSION > 0)
+using VectorTagType = KokkosKernels::Batched::Experimental::AVX<double, ExecSpace>;
+#else
+using VectorTagType = KokkosKernels::Batched::Experimental::SIMD<double, ExecSpace>;
+#endif
+using Scalar = KokkosKernels::Batched::Experimental::Vector<
+    KokkosKernels::Batched::Experimental::VectorTag<VectorTagType, VECTOR_SIZE> >;
+
+// x = a x + b y, with the different Kokkos abstractions:
+// a RangePolicy over i, with the j and k loops inside
+void saxpby_range( const double a, const double b, const View3D & x, const View3D & y );
+// an MDRangePolicy over (i,j,k)
+void saxpby_mdrange( const double a, const double b, const View3D & x, const View3D & y );
+// a TeamPolicy over i, with a TeamThreadRange over j and a ThreadVectorRange
+// over k
+void saxpby_team( const double a, const double b, const View3D & x, const View3D & y );
+// a TeamPolicy over i, with a TeamThreadRange over j and packs of
+// VECTOR_SIZE along k, as the CAAR functors do. The extent along k must be
+// a multiple of VECTOR_SIZE
+void saxpby_pack( const double a, const double b, const View3D & x, const View3D & y );
+
+#endif // SAXPBY_KOKKOS_HPP